@@ -0,0 +1,205 @@
+//-------------------------------------------------
+// Host side benchmark for the model matrix composition in platform/utils/vector_math.h.
+// Compares mat4_compose_soa, used by mp_command_list_compose_models, with the
+// scalar translate/scale/rotation mat4_mul chain the translator used before it:
+//
+//     build.bat bench                        (Windows, outputs to build\)
+//     c++ -std=c++17 -O2 bench/math_bench.cpp -o math_bench
+//
+// Usage:
+//     math_bench [objects]
+//
+// Each path composes the same random transforms, the best of several runs is
+// reported in ns per object. Every matrix is checked against the scalar chain and
+// the run fails when an element differs by more than MATH_BENCH_MAX_ERROR
+// relative to the matrix's largest element.
+//-------------------------------------------------
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include <chrono>
+
+#include "../platform/utils/maple_types.h"
+#define MAPLE_VECTOR_MATH_IMPLEMENTATION
+#include "../platform/utils/vector_math.h"
+
+#define MATH_BENCH_RUNS      20
+#define MATH_BENCH_MAX_ERROR 1e-5f
+
+// Wide enough that every matrix lands in its own slot, like a padded uniform buffer
+#define MATH_BENCH_WIDE_STRIDE 256
+
+// xorshift, so every run sees the same transforms
+file_internal u64 bench_random(u64 *State)
+{
+    u64 X = *State;
+    X ^= X << 13;
+    X ^= X >> 7;
+    X ^= X << 17;
+    *State = X;
+    return X;
+}
+
+file_internal r32 bench_random_r32(u64 *State, r32 Min, r32 Max)
+{
+    return Min + (Max - Min) * (r32)(bench_random(State) >> 40) / (r32)(1 << 24);
+}
+
+file_internal r64 bench_now()
+{
+    return std::chrono::duration<r64>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//~ Paths
+
+// What mp_translate_object_data did for every object data command
+file_internal void compose_scalar_chain(transform_soa *In, u32 Count, mat4 *Out)
+{
+    for (u32 i = 0; i < Count; ++i)
+    {
+        quaternion Rotation;
+        Rotation.x = In->RotationX[i];
+        Rotation.y = In->RotationY[i];
+        Rotation.z = In->RotationZ[i];
+        Rotation.w = In->RotationW[i];
+        
+        mat4 Translation = translate({ In->PositionX[i], In->PositionY[i], In->PositionZ[i] });
+        mat4 Scale       = scale(In->ScaleX[i], In->ScaleY[i], In->ScaleZ[i]);
+        mat4 RotationMat = quaternion_get_rotation_matrix(Rotation);
+        
+        mat4 Model = mat4_diag(1.0f);
+        Model = mat4_mul(Model, Scale);
+        Model = mat4_mul(Model, RotationMat);
+        Model = mat4_mul(Model, Translation);
+        
+        Out[i] = Model;
+    }
+}
+
+// Relative to the largest element of the expected matrix. Translations reach a few
+// hundred, so an absolute bound would only measure their magnitude, and their
+// sums cancel too much for a per element one.
+file_internal r32 max_error(mat4 *Expected, void *Actual, u32 Count, u32 Stride)
+{
+    r32 Result = 0.0f;
+    for (u32 i = 0; i < Count; ++i)
+    {
+        r32 *A = (r32*)(Expected + i);
+        r32 *B = (r32*)((char*)Actual + (u64)Stride * i);
+        
+        r32 Magnitude = 1.0f;
+        for (u32 k = 0; k < 16; ++k)
+        {
+            Magnitude = fmaxf(Magnitude, fabsf(A[k]));
+        }
+        
+        for (u32 k = 0; k < 16; ++k)
+        {
+            r32 Diff = fabsf(A[k] - B[k]) / Magnitude;
+            if (Diff > Result) Result = Diff;
+        }
+    }
+    
+    return Result;
+}
+
+int main(int argc, char **argv)
+{
+    u32 Count = (argc > 1) ? (u32)atoi(argv[1]) : 100003;
+    if (!Count)
+    {
+        printf("usage: math_bench [objects]\n");
+        return 1;
+    }
+    
+    // Positions and scales in the range of a scene, rotations normalized like the
+    // ones the game sends
+    u64 Rng = 0x9E3779B97F4A7C15ULL;
+    r32 *Components = (r32*)malloc(sizeof(r32) * Count * 10);
+    
+    transform_soa Transforms;
+    Transforms.PositionX = Components;
+    Transforms.PositionY = Components + Count;
+    Transforms.PositionZ = Components + Count * 2;
+    Transforms.ScaleX    = Components + Count * 3;
+    Transforms.ScaleY    = Components + Count * 4;
+    Transforms.ScaleZ    = Components + Count * 5;
+    Transforms.RotationX = Components + Count * 6;
+    Transforms.RotationY = Components + Count * 7;
+    Transforms.RotationZ = Components + Count * 8;
+    Transforms.RotationW = Components + Count * 9;
+    
+    for (u32 i = 0; i < Count; ++i)
+    {
+        Transforms.PositionX[i] = bench_random_r32(&Rng, -100.0f, 100.0f);
+        Transforms.PositionY[i] = bench_random_r32(&Rng, -100.0f, 100.0f);
+        Transforms.PositionZ[i] = bench_random_r32(&Rng, -100.0f, 100.0f);
+        Transforms.ScaleX[i]    = bench_random_r32(&Rng, 0.1f, 4.0f);
+        Transforms.ScaleY[i]    = bench_random_r32(&Rng, 0.1f, 4.0f);
+        Transforms.ScaleZ[i]    = bench_random_r32(&Rng, 0.1f, 4.0f);
+        
+        r32 X = bench_random_r32(&Rng, -1.0f, 1.0f);
+        r32 Y = bench_random_r32(&Rng, -1.0f, 1.0f);
+        r32 Z = bench_random_r32(&Rng, -1.0f, 1.0f);
+        r32 W = bench_random_r32(&Rng, -1.0f, 1.0f);
+        r32 Length = sqrtf(X * X + Y * Y + Z * Z + W * W);
+        if (Length < 1e-3f)
+        {
+            X = Y = Z = 0.0f;
+            W = Length = 1.0f;
+        }
+        
+        Transforms.RotationX[i] = X / Length;
+        Transforms.RotationY[i] = Y / Length;
+        Transforms.RotationZ[i] = Z / Length;
+        Transforms.RotationW[i] = W / Length;
+    }
+    
+    mat4 *Scalar = (mat4*)malloc(sizeof(mat4) * Count);
+    mat4 *Packed = (mat4*)malloc(sizeof(mat4) * Count);
+    void *Wide   = malloc((u64)MATH_BENCH_WIDE_STRIDE * Count);
+    
+    r64 ScalarBest = 1e9, PackedBest = 1e9, WideBest = 1e9;
+    for (u32 Run = 0; Run < MATH_BENCH_RUNS; ++Run)
+    {
+        r64 Start = bench_now();
+        compose_scalar_chain(&Transforms, Count, Scalar);
+        r64 ScalarEnd = bench_now();
+        mat4_compose_soa(&Transforms, Count, Packed, sizeof(mat4));
+        r64 PackedEnd = bench_now();
+        mat4_compose_soa(&Transforms, Count, Wide, MATH_BENCH_WIDE_STRIDE);
+        r64 WideEnd = bench_now();
+        
+        if (ScalarEnd - Start < ScalarBest)   ScalarBest = ScalarEnd - Start;
+        if (PackedEnd - ScalarEnd < PackedBest) PackedBest = PackedEnd - ScalarEnd;
+        if (WideEnd - PackedEnd < WideBest)   WideBest = WideEnd - PackedEnd;
+    }
+    
+    r32 PackedError = max_error(Scalar, Packed, Count, sizeof(mat4));
+    r32 WideError   = max_error(Scalar, Wide, Count, MATH_BENCH_WIDE_STRIDE);
+    
+    printf("%u objects, best of %d runs\n", Count, MATH_BENCH_RUNS);
+    printf("%-28s %10s %10s %12s\n", "path", "ns/object", "speedup", "max rel err");
+    printf("%-28s %10.2f %10.2f %12s\n", "scalar mat4_mul chain", ScalarBest / Count * 1e9, 1.0, "-");
+    printf("%-28s %10.2f %10.2f %12g\n", "mat4_compose_soa", PackedBest / Count * 1e9,
+           ScalarBest / PackedBest, PackedError);
+    printf("%-28s %10.2f %10.2f %12g\n", "mat4_compose_soa stride 256", WideBest / Count * 1e9,
+           ScalarBest / WideBest, WideError);
+    
+    free(Wide);
+    free(Packed);
+    free(Scalar);
+    free(Components);
+    
+    if (PackedError > MATH_BENCH_MAX_ERROR || WideError > MATH_BENCH_MAX_ERROR)
+    {
+        printf("mat4_compose_soa differs from the scalar chain by more than %g\n", MATH_BENCH_MAX_ERROR);
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,453 @@
+//-------------------------------------------------
+// Host side benchmarks for the memory allocator in platform/mm/memory.c. Links
+// nothing but the allocator and the C/C++ runtime, so it runs on any desktop
+// box without a window or a gpu:
+//
+//     build.bat bench                        (Windows, outputs to build\)
+//     c++ -std=c++17 -O2 bench/memory_bench.cpp -o memory_bench -lpthread
+//
+// Usage:
+//     memory_bench latency    Alloc latency percentiles as the live allocation count grows
+//     memory_bench stress     Multi-threaded alloc/release throughput with thread caches and
+//                             blocks released across threads. Build with -fsanitize=thread
+//                             (or address) to check the lock free paths.
+//     memory_bench replay <trace>
+//                             Replays a trace recorded with MEMORY_TRACE against a fresh heap
+//                             and against malloc
+//-------------------------------------------------
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <string.h>
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "../platform/utils/maple_types.h"
+#include "../platform/mm/memory.h"
+#include "../platform/mm/memory.c"
+
+// Cycles, same clock the trace replay reports in
+#define bench_timestamp() __rdtsc()
+
+// xorshift, so every run and allocator sees the same sequence
+file_internal u64 bench_random(u64 *State)
+{
+    u64 X = *State;
+    X ^= X << 13;
+    X ^= X >> 7;
+    X ^= X << 17;
+    *State = X;
+    return X;
+}
+
+// Mostly small blocks with a tail of larger ones, roughly what the engine asks for
+file_internal u64 bench_random_size(u64 *State)
+{
+    u64 Roll = bench_random(State) % 100;
+    if (Roll < 70) return 8 + bench_random(State) % 248;
+    if (Roll < 95) return 256 + bench_random(State) % 3840;
+    return 4096 + bench_random(State) % 28672;
+}
+
+file_internal int bench_compare_u64(const void *A, const void *B)
+{
+    u64 X = *(const u64*)A;
+    u64 Y = *(const u64*)B;
+    return (X < Y) ? -1 : (X > Y) ? 1 : 0;
+}
+
+//~ Latency
+
+#define LATENCY_SAMPLES 200000
+
+typedef struct latency_result
+{
+    u64 P50;
+    u64 P99;
+    u64 P999;
+    u64 Max;
+} latency_result;
+
+file_internal void* latency_alloc(memory *Memory, u64 Size)
+{
+    return (Memory) ? memory_alloc(Memory, Size) : malloc(Size);
+}
+
+file_internal void latency_release(memory *Memory, void *Ptr)
+{
+    if (Memory) memory_release(Memory, Ptr);
+    else        free(Ptr);
+}
+
+// Fills the allocator with LiveCount blocks and churns them until the free space
+// is fragmented, then times LATENCY_SAMPLES allocations while the live count is
+// held steady (every timed alloc replaces a random live block). Memory is NULL to
+// measure malloc.
+file_internal latency_result latency_measure(memory *Memory, u32 LiveCount)
+{
+    latency_result Result = {};
+    u64 Rng = 0x9E3779B97F4A7C15ULL ^ LiveCount;
+    
+    void **Live    = (void**)malloc(sizeof(void*) * LiveCount);
+    u64   *Samples = (u64*)malloc(sizeof(u64) * LATENCY_SAMPLES);
+    
+    for (u32 i = 0; i < LiveCount; ++i)
+    {
+        Live[i] = latency_alloc(Memory, bench_random_size(&Rng));
+    }
+    
+    // Untimed churn, so the free lists are in a steady state before measuring
+    for (u32 i = 0; i < LiveCount * 2; ++i)
+    {
+        u32 Slot = (u32)(bench_random(&Rng) % LiveCount);
+        latency_release(Memory, Live[Slot]);
+        Live[Slot] = latency_alloc(Memory, bench_random_size(&Rng));
+    }
+    
+    for (u32 i = 0; i < LATENCY_SAMPLES; ++i)
+    {
+        u32 Slot = (u32)(bench_random(&Rng) % LiveCount);
+        u64 Size = bench_random_size(&Rng);
+        latency_release(Memory, Live[Slot]);
+        
+        u64 Start = bench_timestamp();
+        Live[Slot] = latency_alloc(Memory, Size);
+        Samples[i] = bench_timestamp() - Start;
+        
+        if (!Live[Slot])
+        {
+            printf("Allocation of %llu bytes failed with %u live blocks!\n", (unsigned long long)Size, LiveCount);
+            break;
+        }
+    }
+    
+    qsort(Samples, LATENCY_SAMPLES, sizeof(u64), bench_compare_u64);
+    Result.P50  = Samples[LATENCY_SAMPLES / 2];
+    Result.P99  = Samples[(u64)LATENCY_SAMPLES * 99 / 100];
+    Result.P999 = Samples[(u64)LATENCY_SAMPLES * 999 / 1000];
+    Result.Max  = Samples[LATENCY_SAMPLES - 1];
+    
+    for (u32 i = 0; i < LiveCount; ++i)
+    {
+        latency_release(Memory, Live[i]);
+    }
+    
+    free(Samples);
+    free(Live);
+    
+    return Result;
+}
+
+// The p99 of memory_alloc should stay flat as the live count grows, a linear free
+// list walk would grow with it.
+file_internal int latency_run()
+{
+    u32 LiveCounts[] = { 1000, 4000, 16000, 64000, 256000 };
+    u32 LiveCountsCount = sizeof(LiveCounts) / sizeof(LiveCounts[0]);
+    
+    u64 HeapSize = 1024ULL * 1024 * 1024;
+    void *HeapMemory = malloc(HeapSize);
+    if (!HeapMemory)
+    {
+        printf("Unable to allocate the %llu byte heap!\n", (unsigned long long)HeapSize);
+        return 1;
+    }
+    // Fault the pages in up front, otherwise the first touch past the break pointer lands in the samples
+    memset(HeapMemory, 0, HeapSize);
+    
+    printf("alloc latency in cycles, %d samples per row\n", LATENCY_SAMPLES);
+    printf("%-8s %10s %8s %8s %8s %10s\n", "", "live", "p50", "p99", "p99.9", "max");
+    
+    for (u32 i = 0; i < LiveCountsCount; ++i)
+    {
+        memory Heap = {};
+        memory_init(&Heap, HeapSize, HeapMemory);
+        
+        latency_result HeapResult   = latency_measure(&Heap, LiveCounts[i]);
+        latency_result MallocResult = latency_measure(NULL, LiveCounts[i]);
+        
+        printf("%-8s %10u %8llu %8llu %8llu %10llu\n", "memory", LiveCounts[i],
+               (unsigned long long)HeapResult.P50, (unsigned long long)HeapResult.P99,
+               (unsigned long long)HeapResult.P999, (unsigned long long)HeapResult.Max);
+        printf("%-8s %10u %8llu %8llu %8llu %10llu\n", "malloc", LiveCounts[i],
+               (unsigned long long)MallocResult.P50, (unsigned long long)MallocResult.P99,
+               (unsigned long long)MallocResult.P999, (unsigned long long)MallocResult.Max);
+        
+        memory_free(&Heap);
+    }
+    
+    free(HeapMemory);
+    return 0;
+}
+
+//~ Stress
+
+#define STRESS_ITERATIONS   200000 // per thread
+#define STRESS_LOCAL_SLOTS  256
+#define STRESS_SHARED_SLOTS 4096
+#define STRESS_MAX_THREADS  8
+
+typedef struct stress_context
+{
+    memory              *Memory; // NULL to run against malloc
+    std::atomic<void*>  *Shared;
+    std::atomic<u64>     Corruptions;
+} stress_context;
+
+// Every live block starts with a stamp derived from its address, so a block handed
+// out twice or overwritten by the allocator shows up when it is released
+file_internal u64 stress_stamp(void *Ptr)
+{
+    return (u64)(uptr)Ptr * 0x9E3779B97F4A7C15ULL;
+}
+
+file_internal void* stress_alloc(stress_context *Context, memory_thread_cache *Cache, u64 Size, bool FromHeap)
+{
+    void *Result;
+    if (!Context->Memory) Result = malloc(Size);
+    else if (FromHeap)    Result = memory_alloc(Context->Memory, Size);
+    else                  Result = memory_cache_alloc(Cache, Size);
+    
+    if (Result) *(u64*)Result = stress_stamp(Result);
+    return Result;
+}
+
+// Blocks from either path are released through the cache half the time, so heap
+// blocks, own cache blocks and other threads' cache blocks all hit memory_cache_release
+file_internal void stress_release(stress_context *Context, memory_thread_cache *Cache, void *Ptr, bool ThroughCache)
+{
+    if (*(u64*)Ptr != stress_stamp(Ptr))
+    {
+        Context->Corruptions.fetch_add(1);
+    }
+    
+    if (!Context->Memory) free(Ptr);
+    else if (ThroughCache) memory_cache_release(Cache, Ptr);
+    else                   memory_release(Context->Memory, Ptr);
+}
+
+// Returns the thread's cache, which can only be freed once no other thread can
+// release its blocks
+file_internal memory_thread_cache* stress_worker(stress_context *Context, u32 ThreadIndex)
+{
+    memory_thread_cache *Cache = (Context->Memory) ? memory_thread_cache_create(Context->Memory) : NULL;
+    u64 Rng = 0x2545F4914F6CDD1DULL * (ThreadIndex + 1);
+    
+    void *Local[STRESS_LOCAL_SLOTS] = {};
+    
+    for (u32 i = 0; i < STRESS_ITERATIONS; ++i)
+    {
+        // Thread local churn. Most blocks are cache sized, the rest come from the shared
+        // heap, where neighbouring blocks are split and merged by the other threads
+        u32 Slot = (u32)(bench_random(&Rng) % STRESS_LOCAL_SLOTS);
+        if (Local[Slot])
+        {
+            stress_release(Context, Cache, Local[Slot], bench_random(&Rng) & 1);
+            Local[Slot] = NULL;
+        }
+        else
+        {
+            bool FromHeap = (bench_random(&Rng) % 4) == 0;
+            u64 Size = (FromHeap) ? 256 + bench_random(&Rng) % 3840 : 8 + bench_random(&Rng) % 248;
+            Local[Slot] = stress_alloc(Context, Cache, Size, FromHeap);
+        }
+        
+        // Hand blocks to whichever thread picks the slot up next
+        u32 SharedSlot = (u32)(bench_random(&Rng) % STRESS_SHARED_SLOTS);
+        void *Ptr = Context->Shared[SharedSlot].exchange(NULL);
+        if (Ptr)
+        {
+            stress_release(Context, Cache, Ptr, bench_random(&Rng) & 1);
+        }
+        else
+        {
+            Ptr = stress_alloc(Context, Cache, 8 + bench_random(&Rng) % 248, false);
+            void *Old = Context->Shared[SharedSlot].exchange(Ptr);
+            if (Old) stress_release(Context, Cache, Old, true);
+        }
+    }
+    
+    for (u32 i = 0; i < STRESS_LOCAL_SLOTS; ++i)
+    {
+        if (Local[i]) stress_release(Context, Cache, Local[i], true);
+    }
+    
+    return Cache;
+}
+
+// Returns false if a block was corrupted or the heap did not get all of its memory back
+file_internal bool stress_measure(memory *Memory, u32 ThreadCount, r64 *OpsPerSecond)
+{
+    stress_context Context;
+    Context.Memory = Memory;
+    Context.Shared = new std::atomic<void*>[STRESS_SHARED_SLOTS];
+    Context.Corruptions.store(0);
+    for (u32 i = 0; i < STRESS_SHARED_SLOTS; ++i) Context.Shared[i].store(NULL);
+    
+    std::thread          Threads[STRESS_MAX_THREADS];
+    memory_thread_cache *Caches[STRESS_MAX_THREADS] = {};
+    
+    auto Start = std::chrono::steady_clock::now();
+    
+    for (u32 i = 0; i < ThreadCount; ++i)
+    {
+        Threads[i] = std::thread([&Context, &Caches, i]() { Caches[i] = stress_worker(&Context, i); });
+    }
+    
+    for (u32 i = 0; i < ThreadCount; ++i)
+    {
+        Threads[i].join();
+    }
+    
+    r64 Seconds = std::chrono::duration<r64>(std::chrono::steady_clock::now() - Start).count();
+    
+    // Two operations per iteration, the local slot and the shared slot
+    *OpsPerSecond = (r64)ThreadCount * STRESS_ITERATIONS * 2.0 / Seconds;
+    
+    for (u32 i = 0; i < STRESS_SHARED_SLOTS; ++i)
+    {
+        void *Ptr = Context.Shared[i].load();
+        if (Ptr) stress_release(&Context, NULL, Ptr, false);
+    }
+    
+    for (u32 i = 0; i < ThreadCount; ++i)
+    {
+        if (Caches[i]) memory_thread_cache_free(Caches[i]);
+    }
+    
+    delete[] Context.Shared;
+    
+    bool Result = Context.Corruptions.load() == 0;
+    if (!Result)
+    {
+        printf("%llu corrupted blocks!\n", (unsigned long long)Context.Corruptions.load());
+    }
+    
+    if (Memory && (Memory->NumAllocations || Memory->UsedMemory))
+    {
+        printf("%llu allocations with %llu bytes were not returned to the heap!\n",
+               (unsigned long long)Memory->NumAllocations, (unsigned long long)Memory->UsedMemory);
+        Result = false;
+    }
+    
+    return Result;
+}
+
+file_internal int stress_run()
+{
+    u64 HeapSize = 256ULL * 1024 * 1024;
+    void *HeapMemory = malloc(HeapSize);
+    if (!HeapMemory)
+    {
+        printf("Unable to allocate the %llu byte heap!\n", (unsigned long long)HeapSize);
+        return 1;
+    }
+    
+    printf("alloc + release throughput, %d iterations per thread\n", STRESS_ITERATIONS);
+    printf("%-8s %8s %12s %12s\n", "", "threads", "Mops/s", "vs malloc");
+    
+    bool Passed = true;
+    for (u32 ThreadCount = 1; ThreadCount <= STRESS_MAX_THREADS; ThreadCount *= 2)
+    {
+        memory Heap = {};
+        memory_init(&Heap, HeapSize, HeapMemory);
+        
+        r64 HeapOps, MallocOps;
+        Passed &= stress_measure(&Heap, ThreadCount, &HeapOps);
+        Passed &= stress_measure(NULL, ThreadCount, &MallocOps);
+        
+        printf("%-8s %8u %12.2f %11.2fx\n", "memory", ThreadCount, HeapOps / 1e6, HeapOps / MallocOps);
+        printf("%-8s %8u %12.2f\n", "malloc", ThreadCount, MallocOps / 1e6);
+        
+        memory_free(&Heap);
+    }
+    
+    free(HeapMemory);
+    
+    printf("%s\n", (Passed) ? "ok" : "FAILED");
+    return (Passed) ? 0 : 1;
+}
+
+//~ Replay
+
+file_internal void replay_print_result(const char *Allocator, memory_replay_result *Result)
+{
+    printf("%s:\n", Allocator);
+    printf("    operations:       %llu (%llu failed, %llu skipped)\n", (unsigned long long)Result->Operations,
+           (unsigned long long)Result->Failures, (unsigned long long)Result->Skipped);
+    printf("    cycles/operation: %.1f\n", (Result->Operations) ? (r64)Result->Cycles / (r64)Result->Operations : 0.0);
+    printf("    peak footprint:   %llu bytes\n", (unsigned long long)Result->PeakFootprint);
+    printf("    peak live bytes:  %llu bytes\n", (unsigned long long)Result->PeakLiveBytes);
+    printf("    fragmentation:    %.3f (peak %.3f)\n", Result->Fragmentation, Result->PeakFragmentation);
+}
+
+// Runs an allocation trace against a fresh heap and against malloc, so allocator
+// changes can be compared on a trace recorded from a real session.
+file_internal int replay_run(const char *Filename)
+{
+    u64 HeapSize = 1024ULL * 1024 * 1024;
+    void *HeapMemory = malloc(HeapSize);
+    if (!HeapMemory)
+    {
+        printf("Unable to allocate the %llu byte heap!\n", (unsigned long long)HeapSize);
+        return 1;
+    }
+    
+    memory Heap = {};
+    memory_init(&Heap, HeapSize, HeapMemory);
+    
+    int Result = 0;
+    
+    memory_replay_result ReplayResult;
+    if (memory_trace_replay(&Heap, Filename, &ReplayResult))
+    {
+        replay_print_result("memory", &ReplayResult);
+        
+        memory_trace_replay(NULL, Filename, &ReplayResult);
+        replay_print_result("malloc", &ReplayResult);
+    }
+    else
+    {
+        printf("Unable to replay the memory trace \"%s\"!\n", Filename);
+        Result = 1;
+    }
+    
+    memory_free(&Heap);
+    free(HeapMemory);
+    
+    return Result;
+}
+
+file_internal void print_usage()
+{
+    printf("usage: memory_bench latency|stress|replay <trace>\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "latency") == 0)
+    {
+        return latency_run();
+    }
+    else if (argc >= 2 && strcmp(argv[1], "stress") == 0)
+    {
+        return stress_run();
+    }
+    else if (argc >= 3 && strcmp(argv[1], "replay") == 0)
+    {
+        return replay_run(argv[2]);
+    }
+    
+    print_usage();
+    return 1;
+}
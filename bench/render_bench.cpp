@@ -0,0 +1,360 @@
+//-------------------------------------------------
+// Command list throughput of the render path. Builds the graphics module against
+// the null vulkan backend (maple_vk_null.cpp), so it needs neither a gpu nor a
+// window:
+//
+//     build.bat bench                        (Windows, outputs to build\)
+//     c++ -std=c++17 -O2 bench/render_bench.cpp -o render_bench -lpthread
+//
+// Usage:
+//     render_bench [draws] [pipelines] [meshes] [updates]
+//
+// Every frame records one command list with `draws` draws spread over `pipelines`
+// pipelines and `meshes` render components, `updates` of the draws get new object
+// data first. The list is recorded in several bind/draw mixes, and for each the
+// recording time (the cmd_* calls) and the translation time (end_frame) are
+// reported per frame and per command type.
+//
+// Translation scratch (model matrices, sort keys) comes from the 16MB graphics
+// heap, which holds a list of about 30000 draws with an update each.
+//-------------------------------------------------
+
+// Per command timings are only kept with RENDER_PROFILE
+#define MAPLE_NULL_VULKAN
+#define VK_NO_PROTOTYPES
+#define RENDER_PROFILE
+
+#include "../graphics/graphics_unity.cpp"
+
+#define RENDER_BENCH_WARMUP_FRAMES 4
+#define RENDER_BENCH_FRAMES        16
+
+//~ Platform
+
+file_internal void* bench_request_memory(u64 Size)
+{
+    return calloc(1, Size);
+}
+
+file_internal void bench_release_memory(void *Ptr, u64)
+{
+    free(Ptr);
+}
+
+file_internal void bench_get_client_window_dimensions(u32 *Width, u32 *Height)
+{
+    *Width  = 1920;
+    *Height = 1080;
+}
+
+file_internal void bench_print(char *Fmt, ...)
+{
+    va_list Args;
+    va_start(Args, Fmt);
+    vprintf(Fmt, Args);
+    va_end(Args);
+}
+
+// Shaders are only handed to the null backend, so their contents do not matter
+file_internal u64 bench_file_get_fsize(const char*, const char*)
+{
+    return 64;
+}
+
+file_internal file_error bench_load_file(const char*, bool, const char*, void *Buffer, u64 Size)
+{
+    memset(Buffer, 0, Size);
+    return File_Success;
+}
+
+//~ Benchmark
+
+// One way of recording the same draws
+typedef struct render_bench_mix
+{
+    const char *Name;
+    bool        Shuffled;          // random pipeline and mesh per draw, with a pipeline bind before every draw
+    bool        IsSorted;
+    bool        HasInstancing;
+    bool        HasIndirectDraws;
+    bool        HasPushObjectData; // object data is recorded with cmd_push_object_data
+} render_bench_mix;
+
+typedef struct render_bench_result
+{
+    u64 RecordNs;
+    u64 TranslateNs;
+    u64 Recorded;
+    u64 Translated;
+    u64 VkCalls;
+    render_command_stats Commands[CmdType_Count];
+} render_bench_result;
+
+file_internal const char *CmdTypeNames[CmdType_Count] = {
+    "BeginFrame", "EndFrame", "BindPipeline", "BindDescriptor", "Draw",
+    "SetCamera", "UpdateObjectData", "SetSortPass", "PushObjectData",
+};
+
+// xorshift, so every mix sees the same sequence
+file_internal u32 bench_random(u64 *State)
+{
+    u64 X = *State;
+    X ^= X << 13;
+    X ^= X >> 7;
+    X ^= X << 17;
+    *State = X;
+    return (u32)(X >> 32);
+}
+
+file_internal u64 bench_now_ns()
+{
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+file_internal void render_bench_record(render_bench_mix *Mix, command_list List, pipeline *Pipelines, u32 PipelineCount,
+                                       render_component *Meshes, u32 MeshCount, u32 DrawCount, u32 UpdateCount)
+{
+    u64 Rng = 0x9E3779B97F4A7C15ULL;
+    
+    // Runs of draws that share a pipeline, and runs of a mesh inside them
+    u32 PipelineRun = (DrawCount + PipelineCount - 1) / PipelineCount;
+    u32 MeshRun     = (PipelineRun + MeshCount - 1) / MeshCount;
+    u32 UpdateEvery = (UpdateCount) ? DrawCount / UpdateCount : DrawCount + 1;
+    if (UpdateCount && !UpdateEvery) UpdateEvery = 1;
+    
+    cmd_set_camera(List, mat4_diag(1), mat4_diag(1));
+    
+    for (u32 DrawIdx = 0; DrawIdx < DrawCount; ++DrawIdx)
+    {
+        u32 PipelineIdx, MeshIdx;
+        if (Mix->Shuffled)
+        {
+            PipelineIdx = bench_random(&Rng) % PipelineCount;
+            MeshIdx     = bench_random(&Rng) % MeshCount;
+            cmd_bind_pipeline(Pipelines[PipelineIdx], List);
+        }
+        else
+        {
+            PipelineIdx = DrawIdx / PipelineRun;
+            MeshIdx     = (DrawIdx % PipelineRun) / MeshRun;
+            if (DrawIdx % PipelineRun == 0) cmd_bind_pipeline(Pipelines[PipelineIdx], List);
+        }
+        
+        if (DrawIdx % UpdateEvery == 0)
+        {
+            vec3 Position = { (r32)(DrawIdx % 256), (r32)(DrawIdx / 256 % 256), -5.0f - (r32)(DrawIdx % 64) };
+            if (Mix->HasPushObjectData)
+            {
+                mat4 Model = mat4_diag(1);
+                Model.data[3][0] = Position.x;
+                Model.data[3][1] = Position.y;
+                Model.data[3][2] = Position.z;
+                cmd_push_object_data(List, Model);
+            }
+            else
+            {
+                cmd_set_object_world_data(List, Position, { 1, 1, 1 }, { 0, 0, 0, 1 });
+            }
+        }
+        
+        cmd_draw(Meshes[MeshIdx % MeshCount], List);
+    }
+}
+
+file_internal render_bench_result render_bench_run(render_bench_mix *Mix, command_pool Pool, render_component *Meshes,
+                                                   u32 PipelineCount, u32 MeshCount, u32 DrawCount, u32 UpdateCount)
+{
+    render_bench_result Result = {};
+    
+    pipeline *Pipelines = (pipeline*)malloc(sizeof(pipeline) * PipelineCount);
+    for (u32 i = 0; i < PipelineCount; ++i)
+    {
+        pipeline_create_info PipelineInfo = {};
+        PipelineInfo.VertexShader      = (char*)"bench.vert";
+        PipelineInfo.FragmentShader    = (char*)"bench.frag";
+        PipelineInfo.LineWidth         = 1.0f;
+        PipelineInfo.HasInstancing     = Mix->HasInstancing;
+        PipelineInfo.HasIndirectDraws  = Mix->HasIndirectDraws;
+        PipelineInfo.HasPushObjectData = Mix->HasPushObjectData;
+        create_pipeline(&PipelineInfo, &Pipelines[i]);
+    }
+    
+    command_list List;
+    command_list_create_info ListInfo = {};
+    ListInfo.CommandList = &List;
+    ListInfo.CommandPool = Pool;
+    ListInfo.IsSorted    = Mix->IsSorted;
+    create_command_list(&ListInfo);
+    
+    for (u32 Frame = 0; Frame < RENDER_BENCH_WARMUP_FRAMES + RENDER_BENCH_FRAMES; ++Frame)
+    {
+        vk_null_reset_call_counts();
+        begin_frame();
+        
+        u64 Start = bench_now_ns();
+        render_bench_record(Mix, List, Pipelines, PipelineCount, Meshes, MeshCount, DrawCount, UpdateCount);
+        u64 Recorded = bench_now_ns();
+        
+        end_frame_cmd EndFrame = { &List, 1 };
+        end_frame(&EndFrame);
+        u64 Translated = bench_now_ns();
+        
+        if (Frame < RENDER_BENCH_WARMUP_FRAMES) continue;
+        
+        render_stats Stats;
+        get_render_stats(&Stats);
+        
+        Result.RecordNs    += Recorded - Start;
+        Result.TranslateNs += Translated - Recorded;
+        for (u32 Type = 0; Type < CmdType_Count; ++Type)
+        {
+            Result.Commands[Type].Recorded    += Stats.Commands[Type].Recorded;
+            Result.Commands[Type].Translated  += Stats.Commands[Type].Translated;
+            Result.Commands[Type].RecordNs    += Stats.Commands[Type].RecordNs;
+            Result.Commands[Type].TranslateNs += Stats.Commands[Type].TranslateNs;
+            Result.Recorded   += Stats.Commands[Type].Recorded;
+            Result.Translated += Stats.Commands[Type].Translated;
+        }
+        
+        for (u32 Call = 0; Call < VkCall_Count; ++Call)
+        {
+            Result.VkCalls += vk_null_call_count((vk_call)Call);
+        }
+    }
+    
+    free_command_list(&List);
+    for (u32 i = 0; i < PipelineCount; ++i)
+    {
+        free_pipeline(&Pipelines[i]);
+    }
+    free(Pipelines);
+    
+    return Result;
+}
+
+file_internal void render_bench_print(render_bench_mix *Mix, render_bench_result *Result, u32 DrawCount)
+{
+    r64 Frames = RENDER_BENCH_FRAMES;
+    
+    printf("%-18s %10.3f %10.3f %9.1f %12.2f %12.2f %10.0f\n", Mix->Name,
+           Result->RecordNs / Frames / 1e6, Result->TranslateNs / Frames / 1e6,
+           (r64)(Result->RecordNs + Result->TranslateNs) / Frames / DrawCount,
+           (Result->RecordNs) ? Result->Recorded * 1e3 / Result->RecordNs : 0.0,
+           (Result->TranslateNs) ? Result->Translated * 1e3 / Result->TranslateNs : 0.0,
+           Result->VkCalls / Frames);
+}
+
+file_internal void render_bench_print_commands(render_bench_mix *Mix, render_bench_result *Result)
+{
+    printf("\n%s\n", Mix->Name);
+    printf("    %-18s %10s %10s %12s %12s\n", "command", "recorded", "translated", "record ns", "translate ns");
+    
+    for (u32 Type = 0; Type < CmdType_Count; ++Type)
+    {
+        render_command_stats *Stats = Result->Commands + Type;
+        if (!Stats->Recorded) continue;
+        
+        printf("    %-18s %10.0f %10.0f %12.1f %12.1f\n", CmdTypeNames[Type],
+               Stats->Recorded / (r64)RENDER_BENCH_FRAMES, Stats->Translated / (r64)RENDER_BENCH_FRAMES,
+               (r64)Stats->RecordNs / Stats->Recorded,
+               (Stats->Translated) ? (r64)Stats->TranslateNs / Stats->Translated : 0.0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    u32 DrawCount     = (argc > 1) ? (u32)atoi(argv[1]) : 20000;
+    u32 PipelineCount = (argc > 2) ? (u32)atoi(argv[2]) : 8;
+    u32 MeshCount     = (argc > 3) ? (u32)atoi(argv[3]) : 64;
+    u32 UpdateCount   = (argc > 4) ? (u32)atoi(argv[4]) : DrawCount;
+    if (!DrawCount || !PipelineCount || !MeshCount)
+    {
+        printf("usage: render_bench [draws] [pipelines] [meshes] [updates]\n");
+        return 1;
+    }
+    
+    static platform BenchPlatform = {};
+    BenchPlatform.request_memory               = bench_request_memory;
+    BenchPlatform.release_memory               = bench_release_memory;
+    BenchPlatform.get_client_window_dimensions = bench_get_client_window_dimensions;
+    BenchPlatform.mprint                       = bench_print;
+    BenchPlatform.mprinte                      = bench_print;
+    BenchPlatform.file_get_fsize               = bench_file_get_fsize;
+    BenchPlatform.load_file                    = bench_load_file;
+    
+    u64 FrameArenaSize = 4ULL * 1024 * 1024;
+    void *FrameArenaMemory = malloc(FrameArenaSize * FRAME_ARENA_FRAME_COUNT);
+    frame_arena FrameArena;
+    frame_arena_init(&FrameArena, FrameArenaSize, FrameArenaMemory);
+    BenchPlatform.FrameArena = &FrameArena;
+    
+    graphics_create_info GraphicsInfo = {};
+    GraphicsInfo.Platform     = &BenchPlatform;
+    GraphicsInfo.WindowWidth  = 1920;
+    GraphicsInfo.WindowHeight = 1080;
+    initialize_graphics(&GraphicsInfo);
+    
+    r32 Vertices[9] = {};
+    u32 Indices[3]  = { 0, 1, 2 };
+    
+    render_component *Meshes = (render_component*)malloc(sizeof(render_component) * MeshCount);
+    for (u32 i = 0; i < MeshCount; ++i)
+    {
+        render_component_create_info MeshInfo = {};
+        MeshInfo.VertexData   = Vertices;
+        MeshInfo.VertexCount  = 3;
+        MeshInfo.VertexStride = sizeof(r32) * 3;
+        MeshInfo.HasIndices   = true;
+        MeshInfo.IndexData    = Indices;
+        MeshInfo.IndexCount   = 3;
+        MeshInfo.IndexStride  = sizeof(u32);
+        create_render_component(&MeshInfo, &Meshes[i]);
+    }
+    
+    command_pool Pool;
+    command_pool_create_info PoolInfo = {};
+    PoolInfo.CommandPool = &Pool;
+    create_command_pool(&PoolInfo);
+    
+    render_bench_mix Mixes[] = {
+        { "runs" },
+        { "shuffled",        true },
+        { "shuffled sorted", true, true },
+        { "instanced",       false, false, true },
+        { "indirect",        false, false, true, true },
+        { "push constants",  false, false, false, false, true },
+    };
+    u32 MixCount = sizeof(Mixes) / sizeof(Mixes[0]);
+    
+    render_bench_result Results[sizeof(Mixes) / sizeof(Mixes[0])];
+    for (u32 i = 0; i < MixCount; ++i)
+    {
+        Results[i] = render_bench_run(Mixes + i, Pool, Meshes, PipelineCount, MeshCount, DrawCount, UpdateCount);
+    }
+    
+    printf("\n%u draws, %u pipelines, %u meshes, %u object data updates per frame, %d frames\n",
+           DrawCount, PipelineCount, MeshCount, UpdateCount, RENDER_BENCH_FRAMES);
+    printf("%-18s %10s %10s %9s %12s %12s %10s\n", "mix", "record ms", "xlate ms", "ns/draw",
+           "rec Mcmd/s", "xlate Mcmd/s", "vk calls");
+    for (u32 i = 0; i < MixCount; ++i)
+    {
+        render_bench_print(Mixes + i, Results + i, DrawCount);
+    }
+    
+    for (u32 i = 0; i < MixCount; ++i)
+    {
+        render_bench_print_commands(Mixes + i, Results + i);
+    }
+    
+    free_command_pool(&Pool);
+    for (u32 i = 0; i < MeshCount; ++i)
+    {
+        free_render_component(&Meshes[i]);
+    }
+    free(Meshes);
+    
+    shutdown_graphics();
+    
+    free(FrameArenaMemory);
+    return 0;
+}
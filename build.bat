@@ -8,22 +8,28 @@ SET VK_COMPILER="C:\VulkanSDK\1.2.135.0\Bin"
 SET HOST_DIR=%~dp0
 set HOST_DIR=%HOST_DIR:~0,-1%
 
+:: Defines shared by every module. Add -DMEMORY_TRACE to record every heap allocation
+:: to memory_trace.bin, replay a trace with "memory_bench.exe replay memory_trace.bin"
+SET MM_DEFS=
+
 :: Flags for Platform
 SET MP_CFLAGS=-std=c99 -g -D_DEBUG -Wno-microsoft-include
 SET MP_INC=
-SET MP_LIB=-llibcpmtd.lib -luser32.lib -lGdi32.lib -lwinmm.lib
+SET MP_LIB=-llibcpmtd.lib -luser32.lib -lGdi32.lib -lwinmm.lib -lAdvapi32.lib
 SET MP_INPUT=%HOST_DIR%\platform\engine_unity.c
 SET MP_OUTPUT=maple.exe
-SET MP_DEFS=-DVK_NO_PROTOTYPES
+SET MP_DEFS=-DVK_NO_PROTOTYPES %MM_DEFS%
 
-:: Flags for Graphics
+:: Flags for Graphics. Add /DMAPLE_NULL_VULKAN to VK_DEFS to swap maple_vk.cpp for the null
+:: backend in maple_vk_null.cpp, which records calls instead of talking to a device. Add
+:: /DRENDER_PROFILE to time every recorded and translated command (see render_stats)
 SET VK_CFLAGS=/Zi /MTd /std:c++17 -nologo /EHsc /D_DEBUG
 SET VK_INC=
 SET VK_LIB=%LIB_PATH% libcpmtd.lib user32.lib Gdi32.lib winmm.lib
 SET VK_INPUT=%HOST_DIR%\graphics\graphics_unity.cpp
 SET VK_OUTPUT=/Femaple_vk.dll
 SET VK_EXPORTS=
-SET VK_DEFS=/DVK_USE_PLATFORM_WIN32_KHR /DVK_NO_PROTOTYPES /DGRAPHICS_DLL_EXPORT
+SET VK_DEFS=/DVK_USE_PLATFORM_WIN32_KHR /DVK_NO_PROTOTYPES /DGRAPHICS_DLL_EXPORT %MM_DEFS%
 
 :: Flags for the Game
 SET GM_CFLAGS=-std=c99 -g -D_DEBUG -Wno-microsoft-include
@@ -32,7 +38,11 @@ SET GM_LIB=
 SET GM_INPUT=%HOST_DIR%\game\game_unity.c
 SET GM_OUTPUT=maple_game.dll
 SET GM_EXPORTS=
-SET GM_DEFS=-DGAME_DLL_EXPORT
+SET GM_DEFS=-DGAME_DLL_EXPORT %MM_DEFS%
+
+:: Host side benchmarks in bench\, plain executables that do not need a window or a gpu
+SET BN_CFLAGS=-std=c++17 -O2 -Wno-microsoft-include
+SET BN_DEFS=%MM_DEFS%
 
 IF NOT EXIST build\data\terrain\ (
     1>NUL MKDIR build\data\terrain\
@@ -85,3 +95,13 @@ IF "%1" == "mp" (
 	popd
     EXIT /B %ERRORLEVEL%
 )
+
+IF "%1" == "bench" (
+    pushd build\
+        echo Building benchmarks...
+        clang++ %BN_CFLAGS% %BN_DEFS% %HOST_DIR%\bench\memory_bench.cpp -omemory_bench.exe
+        clang++ %BN_CFLAGS% %BN_DEFS% %HOST_DIR%\bench\render_bench.cpp -orender_bench.exe
+        clang++ %BN_CFLAGS% %BN_DEFS% %HOST_DIR%\bench\math_bench.cpp -omath_bench.exe
+    popd
+    EXIT /B %ERRORLEVEL%
+)
@@ -26,7 +26,13 @@
 #include "../platform/frame_params/frame_params.h"
 
 #include "../platform/mm/memory.h"
+#include "../platform/mm/frame_arena.h"
+#include "../platform/mm/tagged_heap.h"
+#include "../platform/mm/compact_heap.h"
 #include "../platform/mm/memory.c"
+#include "../platform/mm/frame_arena.c"
+#include "../platform/mm/tagged_heap.c"
+#include "../platform/mm/compact_heap.c"
 
 //~ Game Source
 
@@ -1,4 +1,11 @@
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define mp_atomic_add_32(Dst, Value) (u32)_InterlockedExchangeAdd((volatile long*)(Dst), (long)(Value))
+#else
+#define mp_atomic_add_32(Dst, Value) __atomic_fetch_add((Dst), (Value), __ATOMIC_ACQ_REL)
+#endif
+
 file_internal void mp_dynamic_uniform_buffer_init(mp_dynamic_uniform_buffer *Buffer, u64 TotalSize)
 {
     u64 MinAlignment  = Core->VkCore.GetMinUniformMemoryOffsetAlignment();
@@ -53,20 +60,25 @@ file_internal i32 mp_dynamic_uniform_buffer_alloc(mp_dynamic_uniform_buffer *Buf
     
     u32 AlignedSize = memory_align(DataSize, Buffer->Alignment);
     
-    if (Buffer->Offset + AlignedSize <= Buffer->Size)
+    // NOTE(Dustin): Command lists are translated on several threads at once, so the
+    // space is claimed with an atomic add. A failed claim still moves the offset,
+    // which does not matter since the buffer stays full until the next reset.
+    u32 Offset = mp_atomic_add_32(&Buffer->Offset, AlignedSize);
+    
+    if (Offset + AlignedSize <= Buffer->Size)
     {
         u32 ImageIndex = Core->Renderer->CurrentImageIndex;
         buffer_parameters *Handle = Buffer->Handles + ImageIndex;
         
-        char *Ptr = (char*)Handle->AllocationInfo.pMappedData + Buffer->Offset;
+        char *Ptr = (char*)Handle->AllocationInfo.pMappedData + Offset;
         memcpy(Ptr, Data, DataSize);
         
-        Result = Buffer->Offset;
-        Buffer->Offset += AlignedSize;
+        Result = Offset;
     }
     else
     {
-        Platform->mprinte("Attempting to allocate space in a dynamic uniform buffer, but there is not enough space! Requested size: %d, Aligned Size: %d, Remaining Size: %d\n", DataSize, AlignedSize, Buffer->Size - Buffer->Offset);
+        u64 Remaining = (Offset < Buffer->Size) ? Buffer->Size - Offset : 0;
+        Platform->mprinte("Attempting to allocate space in a dynamic uniform buffer, but there is not enough space! Requested size: %d, Aligned Size: %d, Remaining Size: %d\n", DataSize, AlignedSize, Remaining);
     }
     
     return Result;
@@ -77,3 +89,5 @@ file_internal void mp_dynamic_uniform_buffer_reset(mp_dynamic_uniform_buffer *Bu
     // easy peasy
     Buffer->Offset = 0;
 }
+
+#undef mp_atomic_add_32
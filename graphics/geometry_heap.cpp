@@ -0,0 +1,221 @@
+
+typedef struct geometry_range
+{
+    u32 Offset;
+    u32 Size;
+} geometry_range;
+
+typedef struct geometry_block
+{
+    buffer_parameters Buffer;
+    geometry_range   *FreeRanges;     // sorted by offset
+    u32               FreeRangeCount;
+} geometry_block;
+
+typedef struct geometry_heap
+{
+    geometry_block Blocks[Geometry_Count][GEOMETRY_HEAP_MAX_BLOCKS];
+    u32            BlockCount[Geometry_Count];
+} geometry_heap;
+
+file_global geometry_heap GeometryHeap;
+
+file_internal bool geometry_heap_create_block(geometry_block *Block, geometry_type Type, u32 Size)
+{
+    VkBufferCreateInfo create_info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    create_info.size  = Size;
+    create_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    create_info.usage |= (Type == Geometry_Vertex) ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    
+    VmaAllocationCreateInfo alloc_info = {};
+    alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    
+    Core->VkCore.CreateVmaBuffer(create_info,
+                                 alloc_info,
+                                 Block->Buffer.Handle,
+                                 Block->Buffer.Memory,
+                                 Block->Buffer.AllocationInfo);
+    if (Block->Buffer.Handle == VK_NULL_HANDLE) return false;
+    
+    Block->Buffer.Size = Size;
+    
+    Block->FreeRanges = palloc<geometry_range>(GEOMETRY_HEAP_MAX_RANGES);
+    Block->FreeRanges[0].Offset = 0;
+    Block->FreeRanges[0].Size   = Size;
+    Block->FreeRangeCount = 1;
+    
+    return true;
+}
+
+// First fit, the padding needed to align the range stays part of the allocation
+file_internal bool geometry_block_alloc(geometry_block *Block, u32 Size, u32 Alignment, geometry_alloc *Alloc)
+{
+    for (u32 RangeIdx = 0; RangeIdx < Block->FreeRangeCount; ++RangeIdx)
+    {
+        geometry_range *Range = Block->FreeRanges + RangeIdx;
+        
+        u64 Offset = ((u64)Range->Offset + Alignment - 1) / Alignment * Alignment;
+        u64 Used   = Offset + Size - Range->Offset;
+        if (Used > Range->Size) continue;
+        
+        Alloc->Buffer      = Block->Buffer.Handle;
+        Alloc->Offset      = (u32)Offset;
+        Alloc->RangeOffset = Range->Offset;
+        Alloc->RangeSize   = (u32)Used;
+        
+        Range->Offset += (u32)Used;
+        Range->Size   -= (u32)Used;
+        if (!Range->Size)
+        {
+            memmove(Range, Range + 1, sizeof(geometry_range) * (Block->FreeRangeCount - RangeIdx - 1));
+            Block->FreeRangeCount--;
+        }
+        
+        return true;
+    }
+    
+    return false;
+}
+
+file_internal void geometry_block_release(geometry_block *Block, u32 Offset, u32 Size)
+{
+    // First free range past the released one
+    u32 Next = 0;
+    while (Next < Block->FreeRangeCount && Block->FreeRanges[Next].Offset < Offset) ++Next;
+    
+    bool MergePrev = Next > 0 && Block->FreeRanges[Next - 1].Offset + Block->FreeRanges[Next - 1].Size == Offset;
+    bool MergeNext = Next < Block->FreeRangeCount && Offset + Size == Block->FreeRanges[Next].Offset;
+    
+    if (MergePrev && MergeNext)
+    {
+        Block->FreeRanges[Next - 1].Size += Size + Block->FreeRanges[Next].Size;
+        memmove(Block->FreeRanges + Next, Block->FreeRanges + Next + 1,
+                sizeof(geometry_range) * (Block->FreeRangeCount - Next - 1));
+        Block->FreeRangeCount--;
+    }
+    else if (MergePrev)
+    {
+        Block->FreeRanges[Next - 1].Size += Size;
+    }
+    else if (MergeNext)
+    {
+        Block->FreeRanges[Next].Offset = Offset;
+        Block->FreeRanges[Next].Size  += Size;
+    }
+    else if (Block->FreeRangeCount < GEOMETRY_HEAP_MAX_RANGES)
+    {
+        memmove(Block->FreeRanges + Next + 1, Block->FreeRanges + Next,
+                sizeof(geometry_range) * (Block->FreeRangeCount - Next));
+        Block->FreeRanges[Next] = { Offset, Size };
+        Block->FreeRangeCount++;
+    }
+    else
+    {
+        // NOTE(Dustin): The range is lost until the heap is freed
+        Platform->mprinte("Geometry heap block has too many free ranges (%d), dropping %d bytes!\n",
+                          GEOMETRY_HEAP_MAX_RANGES, Size);
+    }
+}
+
+void geometry_heap_init()
+{
+    for (u32 Type = 0; Type < Geometry_Count; ++Type)
+    {
+        GeometryHeap.BlockCount[Type] = 0;
+    }
+}
+
+void geometry_heap_free()
+{
+    for (u32 Type = 0; Type < Geometry_Count; ++Type)
+    {
+        for (u32 BlockIdx = 0; BlockIdx < GeometryHeap.BlockCount[Type]; ++BlockIdx)
+        {
+            geometry_block *Block = GeometryHeap.Blocks[Type] + BlockIdx;
+            Core->VkCore.DestroyVmaBuffer(Block->Buffer.Handle, Block->Buffer.Memory);
+            pfree(Block->FreeRanges);
+            *Block = {};
+        }
+        
+        GeometryHeap.BlockCount[Type] = 0;
+    }
+}
+
+geometry_alloc geometry_heap_alloc(geometry_type Type, void *Data, u32 Size, u32 Alignment)
+{
+    geometry_alloc Result = {};
+    Result.Type = (u16)Type;
+    
+    if (!Size || !Alignment) return Result;
+    
+    u32 BlockIdx = 0;
+    for (; BlockIdx < GeometryHeap.BlockCount[Type]; ++BlockIdx)
+    {
+        if (geometry_block_alloc(GeometryHeap.Blocks[Type] + BlockIdx, Size, Alignment, &Result)) break;
+    }
+    
+    if (BlockIdx == GeometryHeap.BlockCount[Type])
+    {
+        if (BlockIdx == GEOMETRY_HEAP_MAX_BLOCKS)
+        {
+            Platform->mprinte("The geometry heap is out of blocks (%d blocks of at least %d bytes)!\n",
+                              GEOMETRY_HEAP_MAX_BLOCKS, GEOMETRY_HEAP_BLOCK_SIZE);
+            return Result;
+        }
+        
+        // Geometry larger than a block gets a block of its own size
+        u64 BlockSize = (u64)Size + Alignment - 1;
+        if (BlockSize < GEOMETRY_HEAP_BLOCK_SIZE) BlockSize = GEOMETRY_HEAP_BLOCK_SIZE;
+        
+        geometry_block *Block = GeometryHeap.Blocks[Type] + BlockIdx;
+        if (BlockSize > 0xFFFFFFFF || !geometry_heap_create_block(Block, Type, (u32)BlockSize)) return Result;
+        GeometryHeap.BlockCount[Type]++;
+        
+        geometry_block_alloc(Block, Size, Alignment, &Result);
+    }
+    
+    Result.Block = (u16)BlockIdx;
+    
+    if (Data)
+    {
+        VkBufferCreateInfo StagingBufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        StagingBufferInfo.size  = Size;
+        StagingBufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        
+        VmaAllocationCreateInfo AllocInfo = {};
+        AllocInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+        AllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        
+        buffer_parameters Staging = {};
+        Core->VkCore.CreateVmaBuffer(StagingBufferInfo,
+                                     AllocInfo,
+                                     Staging.Handle,
+                                     Staging.Memory,
+                                     Staging.AllocationInfo);
+        
+        memcpy(Staging.AllocationInfo.pMappedData, Data, Size);
+        
+        Core->VkCore.CopyBuffer(Core->Renderer->CommandPool, Staging.Handle, Result.Buffer, Size, Result.Offset);
+        Core->VkCore.DestroyVmaBuffer(Staging.Handle, Staging.Memory);
+    }
+    
+    return Result;
+}
+
+void geometry_heap_release(geometry_alloc *Alloc)
+{
+    if (Alloc->Buffer == VK_NULL_HANDLE) return;
+    
+    // Blocks are never freed before the heap, so a missing block means the heap
+    // was already shut down
+    if (Alloc->Type < Geometry_Count && Alloc->Block < GeometryHeap.BlockCount[Alloc->Type])
+    {
+        geometry_block *Block = GeometryHeap.Blocks[Alloc->Type] + Alloc->Block;
+        if (Block->Buffer.Handle == Alloc->Buffer)
+        {
+            geometry_block_release(Block, Alloc->RangeOffset, Alloc->RangeSize);
+        }
+    }
+    
+    *Alloc = {};
+}
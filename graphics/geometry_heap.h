@@ -0,0 +1,53 @@
+#ifndef GRAPHICS_GEOMETRY_HEAP_H
+#define GRAPHICS_GEOMETRY_HEAP_H
+
+// Long lived gpu memory for render component geometry. Vertices and indices are
+// suballocated from a few large GPU_ONLY buffers instead of one buffer pair per
+// component, so draws of different components share their vertex and index
+// buffer bindings and only differ in vertexOffset/firstIndex. That is what lets
+// an indirect run cover more than one component, see mp_add_indirect.
+//
+// Each block keeps a list of its free ranges sorted by offset, allocations are
+// first fit and released ranges are merged with their neighbours. A block is
+// only created when none of the existing ones has room.
+//
+// NOTE(Dustin): Not thread safe, only called where render components are created
+// and freed.
+#define GEOMETRY_HEAP_BLOCK_SIZE  _MB(16)
+#define GEOMETRY_HEAP_MAX_BLOCKS  16   // per geometry type
+#define GEOMETRY_HEAP_MAX_RANGES  1024 // free ranges per block
+
+// Indices are always 4 byte aligned, so a range can be read as 16 or 32 bit indices
+#define GEOMETRY_HEAP_INDEX_ALIGNMENT 4
+
+typedef enum geometry_type
+{
+    Geometry_Vertex,
+    Geometry_Index,
+    
+    Geometry_Count,
+} geometry_type;
+
+typedef struct geometry_alloc
+{
+    VkBuffer Buffer;      // VK_NULL_HANDLE when the allocation failed
+    u32      Offset;      // into Buffer, a multiple of the requested alignment
+    
+    // The range taken from the block, including the alignment padding in front
+    // of Offset
+    u32      RangeOffset;
+    u32      RangeSize;
+    u16      Type;
+    u16      Block;
+} geometry_alloc;
+
+void geometry_heap_init();
+void geometry_heap_free();
+
+// Alignment does not have to be a power of two, vertices are aligned to their
+// stride so Offset / stride is the draw's vertexOffset. Size bytes of Data are
+// copied to the allocation through a staging buffer.
+geometry_alloc geometry_heap_alloc(geometry_type Type, void *Data, u32 Size, u32 Alignment);
+void geometry_heap_release(geometry_alloc *Alloc);
+
+#endif //GRAPHICS_GEOMETRY_HEAP_H
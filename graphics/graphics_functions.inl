@@ -14,6 +14,7 @@ GRAPHICS_EXPORTED_FUNCTION( get_render_mode     )
 GRAPHICS_EXPORTED_FUNCTION( begin_frame         )
 GRAPHICS_EXPORTED_FUNCTION( end_frame           )
 GRAPHICS_EXPORTED_FUNCTION( wait_for_last_frame )
+GRAPHICS_EXPORTED_FUNCTION( get_render_stats    )
 
 // Command List Functions
 
@@ -21,6 +22,7 @@ GRAPHICS_EXPORTED_FUNCTION( create_command_pool )
 GRAPHICS_EXPORTED_FUNCTION( create_command_list )
 
 GRAPHICS_EXPORTED_FUNCTION( free_command_pool    )
+GRAPHICS_EXPORTED_FUNCTION( reset_command_pool   )
 GRAPHICS_EXPORTED_FUNCTION( free_command_list    )
 GRAPHICS_EXPORTED_FUNCTION( execute_command_list )
 
@@ -73,5 +75,7 @@ GRAPHICS_EXPORTED_FUNCTION( cmd_draw                  )
 GRAPHICS_EXPORTED_FUNCTION( cmd_set_object_world_data )
 GRAPHICS_EXPORTED_FUNCTION( cmd_set_camera            )
 GRAPHICS_EXPORTED_FUNCTION( cmd_bind_descriptor_set   )
+GRAPHICS_EXPORTED_FUNCTION( cmd_set_sort_pass         )
+GRAPHICS_EXPORTED_FUNCTION( cmd_push_object_data      )
 
 #undef GRAPHICS_EXPORTED_FUNCTION
@@ -6,15 +6,25 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include <assert.h>
 #include <string.h>
-#include <math.h.>
+#include <math.h>
 
 // NOTE(Dustin): Used for queue and graphics families
 #include <set>
 #include <optional>
 
+// NOTE(Dustin): Used by the render workers
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// NOTE(Dustin): Used for the render stats timings
+#include <chrono>
+
 //~ Type System & Utils
 
 #define STB_DS_IMPLEMENTATION
@@ -40,7 +50,10 @@ platform *Platform;
 // Lines 15344
 // Lines 15349
 // Lines 15360
+// NOTE(Dustin): The null backend never creates an allocator, only the types are needed
+#if !defined(MAPLE_NULL_VULKAN)
 #define VMA_IMPLEMENTATION
+#endif
 
 #include "vulkan_functions.h"        // imported functions
 #include "vma/vk_mem_alloc.h" // gpu memory allocator
@@ -68,28 +81,47 @@ typedef struct
 extern globals *Core;
 
 #include "../platform/mm/memory.h"
+#include "../platform/mm/frame_arena.h"
+#include "../platform/mm/tagged_heap.h"
+#include "../platform/mm/compact_heap.h"
 #include "mm.h"
+#include "resource_pool.h"
 #include "../platform/utils/stb_ds.h"
 #include "../platform/utils/mstr.h"
 #include "../platform/utils/vector_math.h" 
 
 #include "dynamic_uniform_buffer.h"
 #include "uniform_buffer.h"
+#include "transient_ring.h"
+#include "geometry_heap.h"
 #include "maple_graphics.h"
 #include "renderer.h"
+#include "render_workers.h"
 
 //-------------------------------------------------
 // SOURCE
 //-------------------------------------------------
 
 #include "../platform/mm/memory.c"
+#include "../platform/mm/frame_arena.c"
+#include "../platform/mm/tagged_heap.c"
+#include "../platform/mm/compact_heap.c"
 
 #include "vulkan_functions.cpp"
+#if defined(MAPLE_NULL_VULKAN)
+#include "maple_vk_null.cpp"
+#else
 #include "maple_vk.cpp"
+#endif
 
 #include "dynamic_uniform_buffer.c"
 #include "uniform_buffer.c"
+#include "transient_ring.cpp"
+#include "geometry_heap.cpp"
 #include "renderer.c"
 #include "maple_graphics.cpp"
+#include "render_workers.cpp"
 
+#ifdef VK_USE_PLATFORM_WIN32_KHR
 #include "graphics_win32.cpp"
+#endif
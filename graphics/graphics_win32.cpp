@@ -47,36 +47,6 @@ file_internal void DisplayError(LPTSTR lpszFunction)
     LocalFree(lpDisplayBuf);
 }
 
-// An internal allocation scheme that allocates from the 2MB Platform Linear allcoator.
-// this functions is primarily used by print/formatting functions that need temporary,
-// dynamic memory. When the heap is filled, the allocator is reset.
-file_internal void* PlatformLocalAlloc(u32 Size)
-{
-    void* Result = NULL;
-    
-#if 0
-    if (!PlatformHeap.Start)
-        PlatformHeap = TaggedHeapRequestAllocation(&Core->TaggedHeap, PlatformTag);
-    
-    Result = TaggedHeapBlockAlloc(&PlatformHeap, Size);
-    if (!Result)
-    {
-        PlatformHeap.Brkp = PlatformHeap.Start;
-        
-        Result = TaggedHeapBlockAlloc(&PlatformHeap, Size);
-        if (!Result)
-            Platform->mprinte("Error allocating from Platform Heap Allocator!\n");
-    }
-#else
-    
-    // TODO(Dustin): Temporary fix for not having a tagged heap/string right now
-    Result = malloc(Size);
-    
-#endif
-    
-    return Result;
-}
-
 i32 __Win32FormatString(char *buff, i32 len, char *fmt, va_list list)
 {
     // if a caller doesn't actually know the length of the
@@ -107,7 +77,7 @@ void PlatformFatalError(char *Fmt, ...)
     
     char *Message = NULL;
     int CharsRead = 1 + __Win32FormatString(Message, 1, Fmt, Args);
-    Message = (char*)PlatformLocalAlloc(CharsRead);
+    Message = (char*)Platform->local_alloc(CharsRead);
     __Win32FormatString(Message, CharsRead, Fmt, Args);
     
     HWND *ClientWindow;
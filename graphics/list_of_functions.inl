@@ -136,6 +136,8 @@ VK_DEVICE_LEVEL_FUNCTION( vkCmdSetScissor )
 VK_DEVICE_LEVEL_FUNCTION( vkCmdBindVertexBuffers )
 VK_DEVICE_LEVEL_FUNCTION( vkCmdDraw )
 VK_DEVICE_LEVEL_FUNCTION( vkCmdDrawIndexed )
+VK_DEVICE_LEVEL_FUNCTION( vkCmdDrawIndirect )
+VK_DEVICE_LEVEL_FUNCTION( vkCmdDrawIndexedIndirect )
 VK_DEVICE_LEVEL_FUNCTION( vkCmdDispatch )
 VK_DEVICE_LEVEL_FUNCTION( vkCmdCopyImage )
 VK_DEVICE_LEVEL_FUNCTION( vkCmdPushConstants )
@@ -161,5 +163,6 @@ VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkGetSwapchainImagesKHR, VK_KHR_SWAPCHA
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkAcquireNextImageKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkQueuePresentKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkDestroySwapchainKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME )
+VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkCmdDrawIndexedIndirectCountKHR, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME )
 
 #undef VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION
@@ -3,21 +3,6 @@
 
 globals *Core;
 
-typedef enum cmd_type
-{
-    CmdType_BeginFrame,
-    CmdType_EndFrame,
-    
-    CmdType_BindPipeline,
-    CmdType_BindDescriptor,
-    CmdType_Draw,
-    
-    CmdType_SetCamera,
-    CmdType_UpdateObjectData,
-    
-    CmdType_Count,
-    CmdType_Invalid,
-} cmd_type;
 
 typedef enum image_layout
 {
@@ -26,63 +11,176 @@ typedef enum image_layout
     ImageLayout_ShaderReadOnly,
 } image_layout;
 
-typedef struct cmd_bind_pipeline_info
+//~ Command packets
+// Every command type has a fixed packet layout. Packets only hold handles and
+// small POD payloads and are stored at their natural alignment, see
+// mp_command_list_encode.
+//
+// NOTE(Dustin): Static command lists hash packets byte for byte, so a packet
+// must not contain padding.
+template<cmd_type Type> struct cmd_packet;
+
+template<> struct cmd_packet<CmdType_BindPipeline>
 {
     pipeline Pipeline;
-} cmd_bind_pipeline_info;
+};
+
+template<> struct cmd_packet<CmdType_BindDescriptor>
+{
+    descriptor_set Set;
+};
 
-typedef struct cmd_set_camera
+template<> struct cmd_packet<CmdType_Draw>
 {
-    mat4 Projection;
-    mat4 View;
-} cmd_set_camera;
+    render_component RenderComponent;
+};
 
-typedef struct cmd_set_object_world_data_info
+template<> struct cmd_packet<CmdType_SetCamera>
+{
+    camera_data Camera;
+};
+
+template<> struct cmd_packet<CmdType_UpdateObjectData>
 {
     vec3       Position;
     vec3       Scale;
     quaternion Rotation;
-} cmd_set_object_world_data_info;
+    u32        ModelIndex; // written by the translator, see mp_command_list_compose_models
+};
+
+template<> struct cmd_packet<CmdType_SetSortPass>
+{
+    u32 Pass;
+};
+
+template<> struct cmd_packet<CmdType_PushObjectData>
+{
+    mat4 Matrix;
+};
+
+typedef cmd_packet<CmdType_BindPipeline>     cmd_bind_pipeline_packet;
+typedef cmd_packet<CmdType_BindDescriptor>   cmd_bind_descriptor_packet;
+typedef cmd_packet<CmdType_Draw>             cmd_draw_packet;
+typedef cmd_packet<CmdType_SetCamera>        cmd_set_camera_packet;
+typedef cmd_packet<CmdType_UpdateObjectData> cmd_object_data_packet;
+typedef cmd_packet<CmdType_SetSortPass>      cmd_set_sort_pass_packet;
+typedef cmd_packet<CmdType_PushObjectData>   cmd_push_object_data_packet;
+
+// Command lists are recorded into a chain of fixed size chunks owned by the
+// command pool. The commands follow the chunk header. Chunks are aligned to the
+// largest packet alignment.
+#define COMMAND_LIST_CHUNK_SIZE  _KB(8)
+#define COMMAND_LIST_CHUNK_ALIGN 16
+
+typedef struct command_list_chunk
+{
+    struct command_list_chunk *Next;     // next chunk of the same command list
+    struct command_list_chunk *PoolNext; // next chunk in the pool's used or free list
+    u32                        Used;     // bytes of commands, including this header
+    u32                        CommandCount;
+} command_list_chunk;
 
 typedef struct mp_command_pool
 {
     void   *Ptr;
     memory  Pool;
     
-    u64 LastCommandListSize;
+    // Every chunk handed out since the last reset is on the used list, so a reset
+    // moves all of them to the free list at once. Command lists notice the reset
+    // through the Epoch and start over with no chunks.
+    command_list_chunk *UsedChunks;
+    command_list_chunk *UsedChunksTail;
+    command_list_chunk *FreeChunks;
+    u32                 UsedChunkCount;
+    u32                 FreeChunkCount;
+    u32                 Epoch;
     
-    VkCommandPool Handle;
+    // Chunks used during the frame before the last reset. The free list is kept
+    // at about this size so the next frame does not have to allocate.
+    u32                 LastFrameChunkCount;
     
-    // TODO(Dustin): Track all command lists allocated
-    // from this pool. Introduce a Reset functions + have
-    // free function clear all allocated command lists
+    VkCommandPool Handle;
 } mp_command_pool;
 
+// Packet header. The payload follows at its alignment, the next header at Size.
 typedef struct command_list_cmd
 {
-    cmd_type Type;
-    u32      DataSize;
+    u8  Type;
+    u8  PayloadOffset; // from the start of the header
+    u16 Size;          // of the header, the payload and any padding after it
 } command_list_cmd;
 
+// Instance models and indirect draw commands of a static list, one mapped
+// CPU_TO_GPU buffer per swapchain image. Allocated linearly while the list is
+// recorded, a static list is only ever recorded by one worker at a time.
+typedef struct mp_instance_buffer
+{
+    buffer_parameters *Handles;
+    VkDescriptorSet   *Sets;     // instance data set of each handle
+    VkDescriptorPool   Pool;
+    u32                Size;     // of each handle, 0 while nothing is allocated
+    u32                Used;     // of the handle being recorded
+} mp_instance_buffer;
+
 typedef struct mp_command_list
 {
     command_pool AttachedPool;
+    u32          Epoch;       // pool epoch the chunks belong to
     
-    char *Start;
-    char *End;
-    char *Offset;
+    command_list_chunk *Head;
+    command_list_chunk *Tail; // chunk currently being recorded into
     
     bool  IsActive;
+    bool  IsSorted;
     u32   CommandCount;
     
-    VkCommandBuffer *Handles;
-    u32            CommandListCount;
+    // Static lists hash their commands while they are recorded. The secondary
+    // command buffer of a swapchain image is replayed as long as the cache key it
+    // was recorded with (see mp_command_list_cache_key) still matches.
+    bool  IsStatic;
+    bool  IsCacheable;  // cleared by commands that have to run every frame
+    u64   Hash;
+    u32   ObjectCount;  // object data commands since the last execute
+    bool  HasInstancing; // an instanced or indirect pipeline was bound since the last execute
+    
+    // Static lists only. The list has its own command pool since it can be
+    // recorded on any of the render workers.
+    VkCommandPool    CommandPool;
+    VkCommandBuffer *Handles;           // secondary, one per swapchain image
+    u64             *CacheKeys;         // 0 while the image's buffer is not recorded
+    u32              CommandListCount;
+    
+    // The object data of a static list is kept in its own buffer, so the offsets
+    // baked into the recorded command buffers stay valid from frame to frame. The
+    // buffer has one VkBuffer per swapchain image (ObjectData.Handles) and one set
+    // pointing at each (ObjectDataSets), so recording the buffer of one image only
+    // rewrites that image's object data. The other images' recorded buffers keep
+    // reading their own copies, which is what lets their CacheKeys stay valid.
+    mp_dynamic_uniform_buffer ObjectData;
+    VkDescriptorPool          ObjectDataPool;
+    VkDescriptorSet          *ObjectDataSets;
+    u32                       ObjectCapacity;
+    
+    // Instanced and indirect draws write their models and draw commands to the
+    // list's own buffer for the same reason, see mp_command_list_reserve_instances
+    mp_instance_buffer        Instances;
+    
+    // Recording cost of each command type since the last execute, handed to
+    // the render stats when the list is translated
+    render_command_stats      Profile[CmdType_Count];
+    
+    // The last camera recorded since the last execute, only valid while
+    // Profile[CmdType_SetCamera].Recorded is not 0. See mp_command_list_apply_camera.
+    camera_data               Camera;
 } mp_command_list;
 
 typedef struct mp_pipeline
 {
     VkPipeline       Handle;
     VkPipelineLayout Layout;
+    bool             HasInstancing;
+    bool             HasIndirectDraws;
+    bool             HasPushObjectData;
     
     // Debug Pipelines
     VkPipeline       Wireframe;
@@ -90,11 +188,21 @@ typedef struct mp_pipeline
     
 } mp_pipeline;
 
+// Geometry is suballocated from the geometry heap, VertexBuffer and IndexBuffer
+// are then the heap's blocks and the draws start at VertexOffset/FirstIndex. A
+// component that an upload buffer outgrew owns its buffers, see copy_upload_buffer.
 typedef struct mp_render_component
 {
     buffer_parameters VertexBuffer;
     buffer_parameters IndexBuffer;
     
+    // Buffer is VK_NULL_HANDLE when the component owns the buffer
+    geometry_alloc    VertexGeometry;
+    geometry_alloc    IndexGeometry;
+    
+    u32               VertexOffset;   // in vertices
+    u32               FirstIndex;
+    
     bool              IsIndexed;
     VkIndexType       IndexType;
     u32               DrawCount;
@@ -109,290 +217,1626 @@ typedef struct mp_upload_buffer
     u64                Size;
 } mp_upload_buffer;
 
-typedef struct mp_descriptor_layout
+typedef struct mp_descriptor_layout
+{
+    VkDescriptorSetLayout Handle;
+} mp_descriptor_layout;
+
+typedef struct mp_descriptor_set
+{
+    VkDescriptorSet *Handles;
+    u32              HandleCount;
+    
+    u32              Binding;
+    u32              Set;
+} mp_descriptor_set;
+
+typedef struct mp_image
+{
+    VkImage           Handle;
+    VkImageView       View;
+    VkSampler         Sampler;
+    VkFormat          Format;
+    
+    VmaAllocation     Memory;
+    VmaAllocationInfo AllocationInfo;
+    
+    u32               Width;
+    u32               Height;
+    u32               MipLevels;
+    
+    image_layout CurrentLayout;
+    
+} mp_image;
+
+// Capacity of each resource pool
+#define MAX_PIPELINES          64
+#define MAX_RENDER_COMPONENTS  1024
+#define MAX_UPLOAD_BUFFERS     256
+#define MAX_IMAGES             256
+#define MAX_DESCRIPTOR_LAYOUTS 64
+#define MAX_DESCRIPTOR_SETS    256
+
+typedef struct resource_pools
+{
+    // Bumped whenever a resource changes in a way that invalidates command
+    // buffers it was recorded into
+    u32                                 Version;
+    
+    resource_pool<mp_pipeline>          Pipelines;
+    resource_pool<mp_render_component>  RenderComponents;
+    resource_pool<mp_upload_buffer>     UploadBuffers;
+    resource_pool<mp_image>             Images;
+    resource_pool<mp_descriptor_layout> DescriptorLayouts;
+    resource_pool<mp_descriptor_set>    DescriptorSets;
+} resource_pools;
+
+resource_pools *Resources;
+
+void resource_pools_init(resource_pools *Pools)
+{
+    Pools->Version = 0;
+    
+    resource_pool_init(&Pools->Pipelines,         ResourceType_Pipeline,         MAX_PIPELINES);
+    resource_pool_init(&Pools->RenderComponents,  ResourceType_RenderComponent,  MAX_RENDER_COMPONENTS);
+    resource_pool_init(&Pools->UploadBuffers,     ResourceType_UploadBuffer,     MAX_UPLOAD_BUFFERS);
+    resource_pool_init(&Pools->Images,            ResourceType_Image,            MAX_IMAGES);
+    resource_pool_init(&Pools->DescriptorLayouts, ResourceType_DescriptorLayout, MAX_DESCRIPTOR_LAYOUTS);
+    resource_pool_init(&Pools->DescriptorSets,    ResourceType_DescriptorSet,    MAX_DESCRIPTOR_SETS);
+}
+
+void resource_pools_free(resource_pools *Pools)
+{
+    resource_pool_free(&Pools->Pipelines);
+    resource_pool_free(&Pools->RenderComponents);
+    resource_pool_free(&Pools->UploadBuffers);
+    resource_pool_free(&Pools->Images);
+    resource_pool_free(&Pools->DescriptorLayouts);
+    resource_pool_free(&Pools->DescriptorSets);
+}
+
+void mp_command_pool_init(command_pool *CommandPool)
+{
+    u64 InitialMemory = _64KB;
+    
+    command_pool pCommandPool = (command_pool)memory_alloc_tagged(Core->Memory, sizeof(mp_command_pool), MemoryTag_CommandPool);
+    *pCommandPool = {};
+    pCommandPool->Ptr = memory_alloc_tagged(Core->Memory, InitialMemory, MemoryTag_CommandPool);
+    memory_init(&pCommandPool->Pool, InitialMemory, pCommandPool->Ptr);
+    
+    pCommandPool->Handle = Core->VkCore.CreateCommandPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                                                          VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    
+    *CommandPool = pCommandPool;
+}
+
+file_internal void mp_command_pool_release_chunks(command_list_chunk *Chunk)
+{
+    while (Chunk)
+    {
+        command_list_chunk *Next = Chunk->PoolNext;
+        memory_release(Core->Memory, Chunk);
+        Chunk = Next;
+    }
+}
+
+void mp_command_pool_free(command_pool *CommandPool)
+{
+    Core->VkCore.DestroyCommandPool((*CommandPool)->Handle);
+    
+    mp_command_pool_release_chunks((*CommandPool)->UsedChunks);
+    mp_command_pool_release_chunks((*CommandPool)->FreeChunks);
+    
+    memory_free(&(*CommandPool)->Pool);
+    memory_release(Core->Memory, (*CommandPool)->Ptr);
+    memory_release(Core->Memory, *CommandPool);
+    *CommandPool = NULL;
+}
+
+// Recycles the chunks of every command list allocated from the pool. The lists
+// themselves stay valid and are empty afterwards.
+void mp_command_pool_reset(command_pool CommandPool)
+{
+    CommandPool->LastFrameChunkCount = CommandPool->UsedChunkCount;
+    
+    if (CommandPool->UsedChunks)
+    {
+        CommandPool->UsedChunksTail->PoolNext = CommandPool->FreeChunks;
+        CommandPool->FreeChunks      = CommandPool->UsedChunks;
+        CommandPool->FreeChunkCount += CommandPool->UsedChunkCount;
+        
+        CommandPool->UsedChunks     = NULL;
+        CommandPool->UsedChunksTail = NULL;
+        CommandPool->UsedChunkCount = 0;
+    }
+    
+    CommandPool->Epoch++;
+    
+    // Hand back what the last frame did not need, keeping some slack for growth
+    u32 KeepCount = CommandPool->LastFrameChunkCount + (CommandPool->LastFrameChunkCount >> 1) + 1;
+    while (CommandPool->FreeChunkCount > KeepCount)
+    {
+        command_list_chunk *Chunk = CommandPool->FreeChunks;
+        CommandPool->FreeChunks = Chunk->PoolNext;
+        CommandPool->FreeChunkCount--;
+        
+        memory_release(Core->Memory, Chunk);
+    }
+}
+
+file_internal command_list_chunk* mp_command_pool_get_chunk(command_pool CommandPool)
+{
+    command_list_chunk *Chunk = CommandPool->FreeChunks;
+    if (Chunk)
+    {
+        CommandPool->FreeChunks = Chunk->PoolNext;
+        CommandPool->FreeChunkCount--;
+    }
+    else
+    {
+        Chunk = (command_list_chunk*)memory_alloc_aligned_tagged(Core->Memory, COMMAND_LIST_CHUNK_SIZE,
+                                                                 COMMAND_LIST_CHUNK_ALIGN, MemoryTag_CommandPool);
+        if (!Chunk) return NULL;
+    }
+    
+    Chunk->Next         = NULL;
+    Chunk->Used         = sizeof(command_list_chunk);
+    Chunk->CommandCount = 0;
+    
+    Chunk->PoolNext = CommandPool->UsedChunks;
+    if (!CommandPool->UsedChunks) CommandPool->UsedChunksTail = Chunk;
+    CommandPool->UsedChunks = Chunk;
+    CommandPool->UsedChunkCount++;
+    
+    return Chunk;
+}
+
+// Seed of the hash of a static list's commands
+#define COMMAND_LIST_HASH_SEED 0x9E3779B97F4A7C15ULL
+
+void mp_command_list_init(command_list *CommandList, command_pool CommandPool, bool IsSorted, bool IsStatic)
+{
+    // The recorded camera is 16 byte aligned
+    command_list pCommandList  = (command_list)memory_alloc_aligned(&CommandPool->Pool, sizeof(mp_command_list),
+                                                                    alignof(mp_command_list));
+    *pCommandList = {};
+    pCommandList->AttachedPool = CommandPool;
+    pCommandList->Epoch        = CommandPool->Epoch;
+    pCommandList->Head         = NULL;
+    pCommandList->Tail         = NULL;
+    pCommandList->IsActive     = false;
+    pCommandList->IsSorted     = IsSorted;
+    pCommandList->CommandCount = 0;
+    
+    pCommandList->IsStatic     = IsStatic;
+    pCommandList->IsCacheable  = true;
+    pCommandList->Hash         = COMMAND_LIST_HASH_SEED;
+    
+    if (IsStatic)
+    {
+        pCommandList->CommandPool = Core->VkCore.CreateCommandPool(VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+        
+        pCommandList->CommandListCount = Core->VkCore.GetSwapChainImageCount();
+        pCommandList->Handles   = palloc<VkCommandBuffer>(pCommandList->CommandListCount);
+        pCommandList->CacheKeys = palloc<u64>(pCommandList->CommandListCount);
+        memset(pCommandList->CacheKeys, 0, sizeof(u64) * pCommandList->CommandListCount);
+        
+        Core->VkCore.CreateCommandBuffers(pCommandList->CommandPool,
+                                          VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                                          pCommandList->CommandListCount,
+                                          pCommandList->Handles);
+    }
+    
+    *CommandList = pCommandList;
+}
+
+file_internal void mp_command_list_free_object_data(command_list CommandList)
+{
+    if (!CommandList->ObjectCapacity) return;
+    
+    // NOTE(Dustin): Destroying the pool frees the sets
+    Core->VkCore.DestroyDescriptorPool(CommandList->ObjectDataPool);
+    pfree(CommandList->ObjectDataSets);
+    mp_dynamic_uniform_buffer_free(&CommandList->ObjectData);
+    
+    CommandList->ObjectDataPool = VK_NULL_HANDLE;
+    CommandList->ObjectDataSets = NULL;
+    CommandList->ObjectCapacity = 0;
+}
+
+file_internal void mp_command_list_free_instances(command_list CommandList)
+{
+    mp_instance_buffer *Instances = &CommandList->Instances;
+    if (!Instances->Size) return;
+    
+    // NOTE(Dustin): Destroying the pool frees the sets
+    Core->VkCore.DestroyDescriptorPool(Instances->Pool);
+    for (u32 HandleIdx = 0; HandleIdx < CommandList->CommandListCount; ++HandleIdx)
+    {
+        Core->VkCore.DestroyVmaBuffer(Instances->Handles[HandleIdx].Handle, Instances->Handles[HandleIdx].Memory);
+    }
+    pfree(Instances->Handles);
+    pfree(Instances->Sets);
+    
+    *Instances = {};
+}
+
+// NOTE(Dustin): The chunks of a freed command list go back to the pool's free
+// list on the next pool reset.
+void mp_command_list_free(command_list *CommandList)
+{
+    if ((*CommandList)->IsStatic)
+    {
+        // The recorded buffers might still be in flight
+        Core->VkCore.Idle();
+        
+        mp_command_list_free_object_data(*CommandList);
+        mp_command_list_free_instances(*CommandList);
+        
+        // NOTE(Dustin): Destroying the pool frees the command buffers
+        Core->VkCore.DestroyCommandPool((*CommandList)->CommandPool);
+        pfree((*CommandList)->Handles);
+        pfree((*CommandList)->CacheKeys);
+    }
+    
+    (*CommandList)->Head         = NULL;
+    (*CommandList)->Tail         = NULL;
+    
+    command_pool CommandPool = (*CommandList)->AttachedPool;
+    (*CommandList)->AttachedPool = NULL;
+    
+    memory_release_aligned(&CommandPool->Pool, (*CommandList));
+    
+    *CommandList = NULL;
+}
+
+// Drops the commands of a list whose chunks were recycled by a pool reset
+file_internal void mp_command_list_sync_epoch(command_list CommandList)
+{
+    if (CommandList->Epoch != CommandList->AttachedPool->Epoch)
+    {
+        CommandList->Epoch        = CommandList->AttachedPool->Epoch;
+        CommandList->Head         = NULL;
+        CommandList->Tail         = NULL;
+        CommandList->CommandCount = 0;
+        
+        CommandList->IsCacheable  = true;
+        CommandList->Hash         = COMMAND_LIST_HASH_SEED;
+        CommandList->ObjectCount  = 0;
+        CommandList->HasInstancing = false;
+        memset(CommandList->Profile, 0, sizeof(CommandList->Profile));
+    }
+}
+
+// Empties the list but keeps its chunks for the next recording
+file_internal void mp_command_list_rewind(command_list CommandList)
+{
+    for (command_list_chunk *Chunk = CommandList->Head; Chunk; Chunk = Chunk->Next)
+    {
+        Chunk->Used         = sizeof(command_list_chunk);
+        Chunk->CommandCount = 0;
+    }
+    
+    CommandList->Tail         = CommandList->Head;
+    CommandList->CommandCount = 0;
+    
+    CommandList->IsCacheable  = true;
+    CommandList->Hash         = COMMAND_LIST_HASH_SEED;
+    CommandList->ObjectCount  = 0;
+    CommandList->HasInstancing = false;
+    memset(CommandList->Profile, 0, sizeof(CommandList->Profile));
+}
+
+
+// Memory Layout for a Single Command List Cmd
+// | Type, PayloadOffset, Size | padding | Payload | padding
+//
+// Headers are 4 byte aligned and the payload starts at the alignment of its
+// packet type. Commands never straddle two chunks. When the current chunk is
+// full, recording continues in the next chunk of the list, a new chunk is taken
+// from the pool if the list does not have one yet.
+//
+// for each chunk in commandlist
+//    char *Offset = (char*)Chunk + sizeof(command_list_chunk);
+//    for each command in chunk
+//        command_list_cmd *Cmd = (command_list_cmd*)Offset;
+//        void *Data = Offset + Cmd->PayloadOffset;
+//
+//        Offset += Cmd->Size;
+//
+
+// Places a packet with a payload of Size bytes, aligned to Align, at the end of
+// the list and fills in its header. Returns the payload, NULL if the list could
+// not grow.
+file_internal void* mp_command_list_reserve(command_list CommandList, cmd_type Type, u32 Size, u32 Align)
+{
+    mp_command_list_sync_epoch(CommandList);
+    
+    u32 HeaderAlign = alignof(command_list_cmd);
+    
+    command_list_chunk *Chunk = CommandList->Tail;
+    u32 Header  = (Chunk) ? Chunk->Used : 0;
+    u32 Payload = memory_align(Header + sizeof(command_list_cmd), Align);
+    u32 End     = memory_align(Payload + Size, HeaderAlign);
+    
+    if (!Chunk || End > COMMAND_LIST_CHUNK_SIZE)
+    {
+        Header  = sizeof(command_list_chunk);
+        Payload = memory_align(Header + sizeof(command_list_cmd), Align);
+        End     = memory_align(Payload + Size, HeaderAlign);
+        if (End > COMMAND_LIST_CHUNK_SIZE)
+        {
+            Platform->mprinte("Command of %d bytes does not fit in a command list chunk!\n", Size);
+            return NULL;
+        }
+        
+        command_list_chunk *Next = (Chunk) ? Chunk->Next : NULL;
+        if (!Next)
+        {
+            Next = mp_command_pool_get_chunk(CommandList->AttachedPool);
+            if (!Next)
+            {
+                Platform->mprinte("Unable to grow the command list: out of memory!\n");
+                return NULL;
+            }
+            
+            if (Chunk) Chunk->Next = Next;
+            else       CommandList->Head = Next;
+        }
+        
+        Chunk = Next;
+        CommandList->Tail = Chunk;
+    }
+    
+    command_list_cmd *Cmd = (command_list_cmd*)((char*)Chunk + Header);
+    Cmd->Type          = (u8)Type;
+    Cmd->PayloadOffset = (u8)(Payload - Header);
+    Cmd->Size          = (u16)(End - Header);
+    
+    Chunk->Used = End;
+    Chunk->CommandCount++;
+    CommandList->CommandCount++;
+    
+    return (char*)Chunk + Payload;
+}
+
+// Bookkeeping for static lists, once the payload has been written
+file_internal void mp_command_list_hash_packet(command_list CommandList, cmd_type Type, void *Payload, u32 Size)
+{
+    u32 TypeValue = Type;
+    CommandList->Hash = stbds_hash_bytes(&TypeValue, sizeof(u32), CommandList->Hash);
+    CommandList->Hash = stbds_hash_bytes(Payload, Size, CommandList->Hash);
+    
+    // The camera is a global uniform that is written while translating, a
+    // replayed buffer would not update it
+    if (Type == CmdType_SetCamera) CommandList->IsCacheable = false;
+    // Pushed object data falls back to the list's buffer on pipelines without
+    // a push constant for it
+    if (Type == CmdType_UpdateObjectData || Type == CmdType_PushObjectData) CommandList->ObjectCount++;
+    
+    // Instanced draws need room in the list's instance buffer
+    if (Type == CmdType_BindPipeline)
+    {
+        mp_pipeline *Pipeline = resource_pool_get(&Resources->Pipelines, ((cmd_bind_pipeline_packet*)Payload)->Pipeline);
+        if (Pipeline && Pipeline->HasInstancing) CommandList->HasInstancing = true;
+    }
+}
+
+// Per command timings for RENDER_PROFILE builds. The clock is read twice per
+// command, which costs about as much as translating a bind.
+#if defined(RENDER_PROFILE)
+#define mp_profile_start(Var)        u64 Var = renderer_clock_ns()
+#define mp_profile_end(Var, Counter) (Counter) += renderer_clock_ns() - (Var)
+#else
+#define mp_profile_start(Var)
+#define mp_profile_end(Var, Counter)
+#endif
+
+// Typed encoder, the packet layout and alignment are known at compile time
+template<cmd_type Type>
+void mp_command_list_encode(command_list CommandList, const cmd_packet<Type> &Packet)
+{
+    mp_profile_start(Start);
+    
+    cmd_packet<Type> *Payload = (cmd_packet<Type>*)mp_command_list_reserve(CommandList, Type,
+                                                                            sizeof(cmd_packet<Type>),
+                                                                            alignof(cmd_packet<Type>));
+    if (!Payload) return;
+    
+    *Payload = Packet;
+    
+    if (CommandList->IsStatic)
+    {
+        mp_command_list_hash_packet(CommandList, Type, Payload, sizeof(cmd_packet<Type>));
+    }
+    
+    CommandList->Profile[Type].Recorded++;
+    mp_profile_end(Start, CommandList->Profile[Type].RecordNs);
+}
+
+//~ Bind filtering
+// The translator goes through these instead of binding directly so that state
+// which is already bound on the context's command buffer is not bound again.
+
+file_internal void mp_bind_pipeline(translate_context *Context, VkPipeline Pipeline, VkPipelineLayout Layout)
+{
+    bound_state  *State = &Context->BoundState;
+    render_stats *Stats = &Context->Stats;
+    
+    if (State->Pipeline == Pipeline)
+    {
+        Stats->PipelineBindsElided++;
+        return;
+    }
+    
+    Core->VkCore.BindPipeline(Context->CommandBuffer, Pipeline);
+    Stats->PipelineBinds++;
+    
+    State->Pipeline = Pipeline;
+    if (State->Layout != Layout)
+    {
+        // NOTE(Dustin): Sets bound through a different layout are not guaranteed
+        // to survive the switch, so forget about them.
+        memset(State->DescriptorSets, 0, sizeof(State->DescriptorSets));
+        State->Layout = Layout;
+    }
+}
+
+// DynamicOffset is ignored unless HasDynamicOffset is set
+file_internal void mp_bind_descriptor_set(translate_context *Context, VkPipelineLayout Layout, u32 Set,
+                                          VkDescriptorSet DescriptorSet, bool HasDynamicOffset, u32 DynamicOffset)
+{
+    bound_state  *State = &Context->BoundState;
+    render_stats *Stats = &Context->Stats;
+    
+    bool IsTracked = Set < MAX_BOUND_DESCRIPTOR_SETS && Layout == State->Layout;
+    if (IsTracked && State->DescriptorSets[Set] == DescriptorSet &&
+        (!HasDynamicOffset || State->DynamicOffsets[Set] == DynamicOffset))
+    {
+        Stats->DescriptorSetBindsElided++;
+        return;
+    }
+    
+    Core->VkCore.BindDescriptorSets(Context->CommandBuffer, Layout, Set, 1, &DescriptorSet,
+                                    (HasDynamicOffset) ? 1 : 0, (HasDynamicOffset) ? &DynamicOffset : NULL);
+    Stats->DescriptorSetBinds++;
+    
+    if (IsTracked)
+    {
+        State->DescriptorSets[Set] = DescriptorSet;
+        State->DynamicOffsets[Set] = DynamicOffset;
+    }
+}
+
+file_internal void mp_bind_vertex_buffer(translate_context *Context, VkBuffer Buffer)
+{
+    bound_state  *State = &Context->BoundState;
+    render_stats *Stats = &Context->Stats;
+    
+    if (State->VertexBuffer == Buffer)
+    {
+        Stats->VertexBufferBindsElided++;
+        return;
+    }
+    
+    u64 Offset = 0;
+    Core->VkCore.BindVertexBuffers(Context->CommandBuffer, 0, 1, &Buffer, &Offset);
+    Stats->VertexBufferBinds++;
+    
+    State->VertexBuffer = Buffer;
+}
+
+file_internal void mp_bind_index_buffer(translate_context *Context, VkBuffer Buffer, VkIndexType IndexType)
+{
+    bound_state  *State = &Context->BoundState;
+    render_stats *Stats = &Context->Stats;
+    
+    if (State->IndexBuffer == Buffer && State->IndexType == IndexType)
+    {
+        Stats->IndexBufferBindsElided++;
+        return;
+    }
+    
+    Core->VkCore.BindIndexBuffer(Context->CommandBuffer, Buffer, 0, IndexType);
+    Stats->IndexBufferBinds++;
+    
+    State->IndexBuffer = Buffer;
+    State->IndexType   = IndexType;
+}
+
+//~ Command translation
+// One translator per command type, emitting Vulkan calls on the context's
+// command buffer.
+
+//~ Instancing
+// On instanced pipelines draws are not emitted right away. A draw is added to the
+// context's instance batch and the batch is emitted as one instanced draw when a
+// draw of another render component, a bind or the end of the list comes along.
+// The models are copied to the transient ring, or the static list's instance
+// buffer, and the draw's firstInstance points gl_InstanceIndex at the first of them.
+
+file_internal void mp_draw_render_component(translate_context *Context, mp_render_component *RenderComponent,
+                                            u32 InstanceCount, u32 FirstInstance)
+{
+    // Bind Vertex Buffers
+    mp_bind_vertex_buffer(Context, RenderComponent->VertexBuffer.Handle);
+    
+    Context->Stats.Draws++;
+    Context->Stats.Instances += InstanceCount;
+    
+    if (RenderComponent->IsIndexed)
+    {
+        // Bind Index Buffers
+        mp_bind_index_buffer(Context, 
+                             RenderComponent->IndexBuffer.Handle, 
+                             RenderComponent->IndexType);
+        
+        Core->VkCore.DrawIndexed(Context->CommandBuffer, RenderComponent->DrawCount, InstanceCount,
+                                 RenderComponent->FirstIndex, RenderComponent->VertexOffset, FirstInstance);
+    }
+    else
+    {
+        Core->VkCore.Draw(Context->CommandBuffer, RenderComponent->DrawCount, InstanceCount,
+                          RenderComponent->VertexOffset, FirstInstance);
+    }
+}
+
+// Instance models and indirect draw commands go to the transient ring, or to the
+// static list's own buffer while one is recorded
+file_internal transient_alloc mp_translate_alloc(translate_context *Context, u32 Size, u32 Alignment)
+{
+    mp_instance_buffer *Instances = Context->InstanceBuffer;
+    if (!Instances) return transient_ring_alloc(Size, Alignment);
+    
+    transient_alloc Result = {};
+    
+    u32 Offset = (Instances->Used + Alignment - 1) / Alignment * Alignment;
+    if ((u64)Offset + Size > Instances->Size)
+    {
+        Platform->mprinte("Static command list instance buffer is full (%d bytes)!\n", Instances->Size);
+        return Result;
+    }
+    Instances->Used = Offset + Size;
+    
+    u32 ImageIndex = Core->Renderer->CurrentImageIndex;
+    Result.Ptr             = (char*)Instances->Handles[ImageIndex].AllocationInfo.pMappedData + Offset;
+    Result.Buffer          = Instances->Handles[ImageIndex].Handle;
+    Result.Offset          = Offset;
+    Result.InstanceDataSet = Instances->Sets[ImageIndex];
+    
+    return Result;
+}
+
+file_internal void mp_flush_instances(translate_context *Context)
+{
+    instance_batch *Batch = &Context->Instances;
+    if (!Batch->Count) return;
+    
+    u32 Count = Batch->Count;
+    Batch->Count = 0;
+    
+    mp_render_component *RenderComponent = resource_pool_get(&Resources->RenderComponents, 
+                                                             Batch->RenderComponent);
+    if (!RenderComponent || !Context->ActivePipeline) return;
+    
+    transient_alloc Alloc = mp_translate_alloc(Context, Count * sizeof(mat4), sizeof(mat4));
+    if (!Alloc.Ptr) return;
+    
+    memcpy(Alloc.Ptr, Batch->Models, Count * sizeof(mat4));
+    
+    // The set covers the whole page, so it only changes when the ring moves on
+    // to another page (or never, for a static list)
+    mp_bind_descriptor_set(Context,
+                           Context->ActivePipeline->Layout,
+                           1,
+                           Alloc.InstanceDataSet,
+                           false, 0);
+    
+    mp_draw_render_component(Context, RenderComponent, Count, Alloc.Offset / sizeof(mat4));
+}
+
+//~ Indirect draws
+// Indirect pipelines collect their draws like instanced ones, but a run is not
+// limited to a single render component: every draw that reads the same vertex and
+// index buffers joins it. Components are suballocated from the geometry heap, so
+// that is every component in the same heap block, each draw command picking its
+// geometry with vertexOffset/firstIndex. When the run ends its models are copied
+// to the transient ring as the instance buffer and its draw commands are written
+// right after, so the whole run costs the CPU one indirect call.
+
+file_internal void mp_flush_indirect(translate_context *Context)
+{
+    indirect_batch *Batch = &Context->Indirect;
+    if (!Batch->Count) return;
+    
+    u32 Count        = Batch->Count;
+    u32 CommandCount = Batch->CommandCount;
+    Batch->Count        = 0;
+    Batch->CommandCount = 0;
+    
+    if (!Context->ActivePipeline) return;
+    
+    transient_alloc Models = mp_translate_alloc(Context, Count * sizeof(mat4), sizeof(mat4));
+    if (!Models.Ptr) return;
+    
+    memcpy(Models.Ptr, Batch->Models, Count * sizeof(mat4));
+    u32 FirstModel = Models.Offset / sizeof(mat4);
+    
+    mp_bind_descriptor_set(Context,
+                           Context->ActivePipeline->Layout,
+                           1,
+                           Models.InstanceDataSet,
+                           false, 0);
+    
+    mp_bind_vertex_buffer(Context, Batch->VertexBuffer);
+    if (Batch->IsIndexed) mp_bind_index_buffer(Context, Batch->IndexBuffer, Batch->IndexType);
+    
+    Context->Stats.Instances += Count;
+    
+    // The models can not be offset into the page without firstInstance, fall back
+    // to regular draws
+    if (!Core->VkCore.HasDrawIndirectFirstInstance)
+    {
+        for (u32 CommandIdx = 0; CommandIdx < CommandCount; ++CommandIdx)
+        {
+            VkDrawIndexedIndirectCommand *Command = Batch->Commands + CommandIdx;
+            
+            if (Batch->IsIndexed)
+            {
+                Core->VkCore.DrawIndexed(Context->CommandBuffer, Command->indexCount, Command->instanceCount,
+                                         Command->firstIndex, Command->vertexOffset,
+                                         FirstModel + Command->firstInstance);
+            }
+            else
+            {
+                Core->VkCore.Draw(Context->CommandBuffer, Command->indexCount, Command->instanceCount,
+                                  Command->vertexOffset, FirstModel + Command->firstInstance);
+            }
+            
+            Context->Stats.Draws++;
+        }
+        return;
+    }
+    
+    // The draw count goes in front of the commands so a count draw can read it
+    u32 Stride = (Batch->IsIndexed) ? sizeof(VkDrawIndexedIndirectCommand) : sizeof(VkDrawIndirectCommand);
+    transient_alloc Args = mp_translate_alloc(Context, sizeof(u32) + CommandCount * Stride, sizeof(u32));
+    if (!Args.Ptr) return;
+    
+    *(u32*)Args.Ptr = CommandCount;
+    VkDeviceSize CommandsOffset = Args.Offset + sizeof(u32);
+    
+    if (Batch->IsIndexed)
+    {
+        VkDrawIndexedIndirectCommand *Commands = (VkDrawIndexedIndirectCommand*)((char*)Args.Ptr + sizeof(u32));
+        for (u32 CommandIdx = 0; CommandIdx < CommandCount; ++CommandIdx)
+        {
+            Commands[CommandIdx] = Batch->Commands[CommandIdx];
+            Commands[CommandIdx].firstInstance += FirstModel;
+        }
+    }
+    else
+    {
+        VkDrawIndirectCommand *Commands = (VkDrawIndirectCommand*)((char*)Args.Ptr + sizeof(u32));
+        for (u32 CommandIdx = 0; CommandIdx < CommandCount; ++CommandIdx)
+        {
+            Commands[CommandIdx].vertexCount   = Batch->Commands[CommandIdx].indexCount;
+            Commands[CommandIdx].instanceCount = Batch->Commands[CommandIdx].instanceCount;
+            Commands[CommandIdx].firstVertex   = Batch->Commands[CommandIdx].vertexOffset;
+            Commands[CommandIdx].firstInstance = Batch->Commands[CommandIdx].firstInstance + FirstModel;
+        }
+    }
+    
+    Context->Stats.IndirectDraws += CommandCount;
+    
+    if (Batch->IsIndexed && Core->VkCore.HasDrawIndirectCount)
+    {
+        // NOTE(Dustin): The count is written on the CPU for now, a culling pass on
+        // the gpu could lower it without touching the commands.
+        Core->VkCore.DrawIndexedIndirectCount(Context->CommandBuffer, Args.Buffer, CommandsOffset,
+                                              Args.Buffer, Args.Offset, CommandCount, Stride);
+        Context->Stats.Draws++;
+    }
+    else if (Core->VkCore.HasMultiDrawIndirect)
+    {
+        if (Batch->IsIndexed)
+            Core->VkCore.DrawIndexedIndirect(Context->CommandBuffer, Args.Buffer, CommandsOffset, CommandCount, Stride);
+        else
+            Core->VkCore.DrawIndirect(Context->CommandBuffer, Args.Buffer, CommandsOffset, CommandCount, Stride);
+        Context->Stats.Draws++;
+    }
+    else
+    {
+        // A single draw per indirect call
+        for (u32 CommandIdx = 0; CommandIdx < CommandCount; ++CommandIdx)
+        {
+            VkDeviceSize Offset = CommandsOffset + CommandIdx * Stride;
+            if (Batch->IsIndexed)
+                Core->VkCore.DrawIndexedIndirect(Context->CommandBuffer, Args.Buffer, Offset, 1, Stride);
+            else
+                Core->VkCore.DrawIndirect(Context->CommandBuffer, Args.Buffer, Offset, 1, Stride);
+            Context->Stats.Draws++;
+        }
+    }
+}
+
+file_internal void mp_add_indirect(translate_context *Context, mp_render_component *RenderComponent)
+{
+    indirect_batch *Batch = &Context->Indirect;
+    
+    bool SameBuffers = Batch->VertexBuffer == RenderComponent->VertexBuffer.Handle &&
+        Batch->IsIndexed == RenderComponent->IsIndexed &&
+        (!RenderComponent->IsIndexed || (Batch->IndexBuffer == RenderComponent->IndexBuffer.Handle &&
+                                         Batch->IndexType   == RenderComponent->IndexType));
+    if (Batch->Count && (!SameBuffers || Batch->Count == MAX_INDIRECT_DRAWS))
+    {
+        mp_flush_indirect(Context);
+    }
+    
+    if (!Batch->Count)
+    {
+        Batch->VertexBuffer = RenderComponent->VertexBuffer.Handle;
+        Batch->IndexBuffer  = RenderComponent->IndexBuffer.Handle;
+        Batch->IndexType    = RenderComponent->IndexType;
+        Batch->IsIndexed    = RenderComponent->IsIndexed;
+    }
+    
+    u32 Model = Batch->Count++;
+    Batch->Models[Model] = Context->InstanceModel;
+    
+    // Another instance of the last command when it draws the same geometry
+    if (Batch->CommandCount)
+    {
+        VkDrawIndexedIndirectCommand *Last = Batch->Commands + Batch->CommandCount - 1;
+        if (Last->indexCount == RenderComponent->DrawCount && Last->firstIndex == RenderComponent->FirstIndex &&
+            Last->vertexOffset == (i32)RenderComponent->VertexOffset &&
+            Last->firstInstance + Last->instanceCount == Model)
+        {
+            Last->instanceCount++;
+            return;
+        }
+    }
+    
+    VkDrawIndexedIndirectCommand *Command = Batch->Commands + Batch->CommandCount++;
+    Command->indexCount    = RenderComponent->DrawCount;
+    Command->instanceCount = 1;
+    Command->firstIndex    = RenderComponent->FirstIndex;
+    Command->vertexOffset  = RenderComponent->VertexOffset;
+    Command->firstInstance = Model;
+}
+
+file_internal void mp_translate_bind_pipeline(translate_context *Context, cmd_bind_pipeline_packet *Packet)
+{
+    mp_flush_instances(Context);
+    mp_flush_indirect(Context);
+    
+    mp_pipeline *Pipeline = resource_pool_get(&Resources->Pipelines, Packet->Pipeline);
+    if (!Pipeline)
+    {
+        Platform->mprinte("Attempting to bind an invalid pipeline (%#x)!\n", Packet->Pipeline);
+        Context->ActivePipeline = NULL;
+        return;
+    }
+    
+    if (Core->Renderer->RenderMode & RenderMode_Solid)
+    {
+        mp_bind_pipeline(Context, Pipeline->Handle, Pipeline->Layout);
+    }
+    else if (Core->Renderer->RenderMode & RenderMode_Wireframe)
+    {
+        mp_bind_pipeline(Context, Pipeline->Wireframe, Pipeline->Layout);
+    }
+    
+    Context->ActivePipeline = Pipeline;
+    mp_bind_descriptor_set(Context,
+                           Context->ActivePipeline->Layout,
+                           0,
+                           Core->Renderer->GlobalShaderData.DescriptorSets[Core->Renderer->CurrentImageIndex],
+                           false, 0);
+}
+
+file_internal void mp_translate_bind_descriptor(translate_context *Context, cmd_bind_descriptor_packet *Packet)
+{
+    mp_flush_instances(Context);
+    mp_flush_indirect(Context);
+    
+    mp_descriptor_set *Set = resource_pool_get(&Resources->DescriptorSets, Packet->Set);
+    if (!Set || !Context->ActivePipeline) return;
+    
+    mp_bind_descriptor_set(Context,
+                           Context->ActivePipeline->Layout,
+                           Set->Set,
+                           Set->Handles[Core->Renderer->CurrentImageIndex],
+                           false, 0);
+}
+
+file_internal void mp_translate_draw(translate_context *Context, cmd_draw_packet *Packet)
+{
+    mp_render_component *RenderComponent = resource_pool_get(&Resources->RenderComponents, 
+                                                             Packet->RenderComponent);
+    if (!RenderComponent) return;
+    
+    if (Context->ActivePipeline && Context->ActivePipeline->HasIndirectDraws)
+    {
+        mp_add_indirect(Context, RenderComponent);
+        return;
+    }
+    
+    if (Context->ActivePipeline && Context->ActivePipeline->HasInstancing)
+    {
+        instance_batch *Batch = &Context->Instances;
+        if (Batch->Count && (Batch->RenderComponent != Packet->RenderComponent ||
+                             Batch->Count == MAX_INSTANCES_PER_DRAW))
+        {
+            mp_flush_instances(Context);
+        }
+        
+        Batch->RenderComponent = Packet->RenderComponent;
+        Batch->Models[Batch->Count++] = Context->InstanceModel;
+        return;
+    }
+    
+    mp_draw_render_component(Context, RenderComponent, 1, 0);
+}
+
+// NOTE(Dustin): The descriptor is bound with the pipeline since it is a global
+// descriptor, so there is a single camera per frame.
+file_internal void mp_apply_camera(camera_data *Camera)
+{
+    Core->Renderer->ActiveCamera = *Camera;
+    
+    mp_uniform_buffer_update(&Core->Renderer->GlobalShaderData.Buffer,
+                             &Core->Renderer->ActiveCamera,
+                             sizeof(camera_data),
+                             0);
+}
+
+// Applies the list's camera ahead of translation. Lists translated on the render
+// workers go through here on the main thread before the job is posted, so the
+// workers only ever read the active camera (sort keys, static list cache keys).
+file_internal void mp_command_list_apply_camera(command_list CommandList)
+{
+    mp_command_list_sync_epoch(CommandList);
+    if (CommandList->Profile[CmdType_SetCamera].Recorded)
+    {
+        mp_apply_camera(&CommandList->Camera);
+    }
+}
+
+file_internal void mp_translate_set_camera(translate_context *Context, cmd_set_camera_packet *Packet)
+{
+    if (!Context->CameraApplied) mp_apply_camera(&Packet->Camera);
+}
+
+// Makes Model the object data of the draws that follow
+file_internal void mp_set_object_data(translate_context *Context, mat4 *Model)
+{
+    if (Context->ActivePipeline->HasPushObjectData)
+    {
+        Core->VkCore.PushConstants(Context->CommandBuffer,
+                                   Context->ActivePipeline->Layout,
+                                   VK_SHADER_STAGE_VERTEX_BIT,
+                                   0, sizeof(mat4), Model);
+    }
+    else if (Context->ActivePipeline->HasInstancing)
+    {
+        // Written out with the draws that use it
+        Context->InstanceModel = *Model;
+    }
+    else if (Context->ObjectData)
+    {
+        u32 Offset = mp_dynamic_uniform_buffer_alloc(Context->ObjectData,
+                                                     Model,
+                                                     sizeof(mat4));
+        
+        mp_bind_descriptor_set(Context,
+                               Context->ActivePipeline->Layout,
+                               1,
+                               Context->ObjectDataSets[Core->Renderer->CurrentImageIndex],
+                               true, Offset);
+    }
+    else
+    {
+        transient_alloc Alloc = transient_ring_alloc_uniform(Model, sizeof(mat4));
+        if (!Alloc.Ptr) return;
+        
+        mp_bind_descriptor_set(Context,
+                               Context->ActivePipeline->Layout,
+                               1,
+                               Alloc.ObjectDataSet,
+                               true, Alloc.Offset);
+    }
+}
+
+file_internal void mp_translate_object_data(translate_context *Context, cmd_object_data_packet *Packet)
+{
+    if (!Context->ActivePipeline) return;
+    
+    if (Context->Models)
+    {
+        mp_set_object_data(Context, Context->Models + Packet->ModelIndex);
+    }
+    else
+    {
+        mat4 Model = mat4_compose(Packet->Position, Packet->Scale, Packet->Rotation);
+        mp_set_object_data(Context, &Model);
+    }
+}
+
+file_internal void mp_translate_push_object_data(translate_context *Context, cmd_push_object_data_packet *Packet)
+{
+    if (!Context->ActivePipeline) return;
+    
+    mp_set_object_data(Context, &Packet->Matrix);
+}
+
+file_internal void mp_translate_set_sort_pass(translate_context *Context, cmd_set_sort_pass_packet *Packet)
+{
+    // Only used when gathering the draws of a sorted command list
+}
+
+//~ Command decoding
+// The decoder table is indexed by cmd_type. Each entry casts the payload to the
+// packet of its type and forwards it to the translator.
+typedef void (*pfn_cmd_decode)(translate_context *Context, void *Payload);
+
+template<cmd_type Type, void (*Translate)(translate_context*, cmd_packet<Type>*)>
+void mp_cmd_decode(translate_context *Context, void *Payload)
+{
+    Translate(Context, (cmd_packet<Type>*)Payload);
+}
+
+file_internal void mp_cmd_decode_nop(translate_context *Context, void *Payload)
+{
+}
+
+file_global pfn_cmd_decode CmdDecoders[] = {
+    mp_cmd_decode_nop, // CmdType_BeginFrame
+    mp_cmd_decode_nop, // CmdType_EndFrame
+    mp_cmd_decode<CmdType_BindPipeline,     mp_translate_bind_pipeline>,
+    mp_cmd_decode<CmdType_BindDescriptor,   mp_translate_bind_descriptor>,
+    mp_cmd_decode<CmdType_Draw,             mp_translate_draw>,
+    mp_cmd_decode<CmdType_SetCamera,        mp_translate_set_camera>,
+    mp_cmd_decode<CmdType_UpdateObjectData, mp_translate_object_data>,
+    mp_cmd_decode<CmdType_SetSortPass,      mp_translate_set_sort_pass>,
+    mp_cmd_decode<CmdType_PushObjectData,   mp_translate_push_object_data>,
+};
+static_assert(sizeof(CmdDecoders) / sizeof(CmdDecoders[0]) == CmdType_Count,
+              "Every command type needs a decoder");
+
+// Walks the commands of a list in recording order
+typedef struct command_list_iterator
+{
+    command_list_chunk *Chunk;
+    char               *Offset;
+    u32                 ChunkCommand;
+    u32                 Remaining;
+} command_list_iterator;
+
+file_internal command_list_iterator mp_command_list_begin(command_list CommandList)
+{
+    command_list_iterator Result = {};
+    Result.Chunk     = CommandList->Head;
+    Result.Offset    = (Result.Chunk) ? (char*)Result.Chunk + sizeof(command_list_chunk) : NULL;
+    Result.Remaining = CommandList->CommandCount;
+    return Result;
+}
+
+// Returns NULL after the last command
+file_internal command_list_cmd* mp_command_list_next(command_list_iterator *Iter)
+{
+    if (!Iter->Remaining) return NULL;
+    
+    if (Iter->ChunkCommand == Iter->Chunk->CommandCount)
+    {
+        Iter->Chunk        = Iter->Chunk->Next;
+        Iter->Offset       = (char*)Iter->Chunk + sizeof(command_list_chunk);
+        Iter->ChunkCommand = 0;
+    }
+    
+    command_list_cmd *Cmd = (command_list_cmd*)Iter->Offset;
+    Iter->Offset += Cmd->Size;
+    Iter->ChunkCommand++;
+    Iter->Remaining--;
+    
+    return Cmd;
+}
+
+#define cmd_data(Cmd) ((void*)((char*)(Cmd) + (Cmd)->PayloadOffset))
+
+//~ Sorted translation
+// A sorted command list turns every draw into a packet that carries the state it
+// was recorded with, sorts the packets by a 64 bit key and then translates them
+// in key order. Draws sharing a pipeline, descriptor set or mesh end up next to
+// each other, so most of the binds are filtered out.
+//
+// | Pass (4) | Pipeline (12) | Descriptor Set (12) | Mesh (16) | Depth (20) |
+//
+// Depth is the view space depth of the object, so draws are front to back within
+// a mesh. Camera commands are translated up front in recording order.
+
+#define SORT_KEY_PASS_SHIFT     60
+#define SORT_KEY_PIPELINE_SHIFT 48
+#define SORT_KEY_SET_SHIFT      36
+#define SORT_KEY_MESH_SHIFT     20
+#define SORT_KEY_DEPTH_BITS     20
+
+typedef struct sorted_draw
+{
+    u64                     Pass;
+    pipeline                Pipeline;
+    descriptor_set          Set;
+    render_component        RenderComponent;
+    command_list_cmd       *ObjectData; // object data or push object data command
+} sorted_draw;
+
+// LSD radix sort, 8 bits per pass. Passes where every key has the same digit are
+// skipped, which is most of them when only a few pipelines and meshes are used.
+// The sorted result ends up in Keys/Values.
+file_internal void mp_radix_sort(u64 *Keys, u32 *Values, u64 *TmpKeys, u32 *TmpValues, u32 Count)
+{
+    for (u32 Shift = 0; Shift < 64; Shift += 8)
+    {
+        u32 Offsets[256] = {};
+        for (u32 i = 0; i < Count; ++i)
+        {
+            Offsets[(Keys[i] >> Shift) & 0xFF]++;
+        }
+        
+        if (Offsets[(Keys[0] >> Shift) & 0xFF] == Count) continue;
+        
+        u32 Sum = 0;
+        for (u32 Digit = 0; Digit < 256; ++Digit)
+        {
+            u32 DigitCount = Offsets[Digit];
+            Offsets[Digit] = Sum;
+            Sum += DigitCount;
+        }
+        
+        for (u32 i = 0; i < Count; ++i)
+        {
+            u32 Dst = Offsets[(Keys[i] >> Shift) & 0xFF]++;
+            TmpKeys[Dst]   = Keys[i];
+            TmpValues[Dst] = Values[i];
+        }
+        
+        memcpy(Keys,   TmpKeys,   sizeof(u64) * Count);
+        memcpy(Values, TmpValues, sizeof(u32) * Count);
+    }
+}
+
+file_internal u64 mp_sort_key_depth(mat4 *View, vec3 Position)
+{
+    r32 Depth = -(View->data[0][2] * Position.x + View->data[1][2] * Position.y +
+                  View->data[2][2] * Position.z + View->data[3][2]);
+    if (!(Depth > 0.0f)) Depth = 0.0f;
+    
+    // A positive float's bits sort like the float itself
+    u32 Bits;
+    memcpy(&Bits, &Depth, sizeof(u32));
+    return Bits >> (31 - SORT_KEY_DEPTH_BITS);
+}
+
+// Pushed object data is assumed to be a model matrix, a precomputed MVP only
+// sorts roughly
+file_internal vec3 mp_object_data_position(command_list_cmd *ObjectData)
+{
+    if (ObjectData->Type == CmdType_PushObjectData)
+    {
+        mat4 *Matrix = &((cmd_push_object_data_packet*)cmd_data(ObjectData))->Matrix;
+        return { Matrix->data[3][0], Matrix->data[3][1], Matrix->data[3][2] };
+    }
+    
+    return ((cmd_object_data_packet*)cmd_data(ObjectData))->Position;
+}
+
+file_internal void mp_command_list_translate_sorted(translate_context *Context, command_list CommandList)
+{
+    // NOTE(Dustin): The frame arena is not thread safe and lists can be translated
+    // on the render workers, so the packets come from the heap.
+    if (!CommandList->CommandCount) return;
+    
+    u32 DrawCount = 0;
+    sorted_draw *Draws = palloc<sorted_draw>(CommandList->CommandCount);
+    u64 *Keys = palloc<u64>(CommandList->CommandCount * 2);
+    u32 *Values = palloc<u32>(CommandList->CommandCount * 2);
+    
+    mat4 View = Core->Renderer->ActiveCamera.View;
+    
+    // Gather the draw packets
+    sorted_draw Current = {};
+    
+    command_list_iterator Iter = mp_command_list_begin(CommandList);
+    while (command_list_cmd *Cmd = mp_command_list_next(&Iter))
+    {
+        void *Data = cmd_data(Cmd);
+        switch (Cmd->Type)
+        {
+            case CmdType_BindPipeline:
+            {
+                Current.Pipeline = ((cmd_bind_pipeline_packet*)Data)->Pipeline;
+                Current.Set      = 0;
+            } break;
+            
+            case CmdType_BindDescriptor:
+            {
+                Current.Set = ((cmd_bind_descriptor_packet*)Data)->Set;
+            } break;
+            
+            case CmdType_UpdateObjectData:
+            case CmdType_PushObjectData:
+            {
+                Current.ObjectData = Cmd;
+            } break;
+            
+            case CmdType_SetSortPass:
+            {
+                Current.Pass = ((cmd_set_sort_pass_packet*)Data)->Pass & 0xF;
+            } break;
+            
+            case CmdType_SetCamera:
+            {
+                cmd_set_camera_packet *Packet = (cmd_set_camera_packet*)Data;
+                View = Packet->Camera.View;
+                
+                mp_profile_start(Start);
+                mp_translate_set_camera(Context, Packet);
+                mp_profile_end(Start, Context->Stats.Commands[CmdType_SetCamera].TranslateNs);
+                Context->Stats.Commands[CmdType_SetCamera].Translated++;
+            } break;
+            
+            case CmdType_Draw:
+            {
+                Current.RenderComponent = ((cmd_draw_packet*)Data)->RenderComponent;
+                
+                u64 Key = (Current.Pass << SORT_KEY_PASS_SHIFT) |
+                    ((u64)(Current.Pipeline & 0xFFF) << SORT_KEY_PIPELINE_SHIFT) |
+                    ((u64)(Current.Set & 0xFFF) << SORT_KEY_SET_SHIFT) |
+                    ((u64)(Current.RenderComponent & 0xFFFF) << SORT_KEY_MESH_SHIFT);
+                if (Current.ObjectData)
+                {
+                    Key |= mp_sort_key_depth(&View, mp_object_data_position(Current.ObjectData));
+                }
+                
+                Keys[DrawCount]   = Key;
+                Values[DrawCount] = DrawCount;
+                Draws[DrawCount]  = Current;
+                DrawCount++;
+            } break;
+            
+            default: break;
+        }
+    }
+    
+    mp_radix_sort(Keys, Values, Keys + DrawCount, Values + DrawCount, DrawCount);
+    
+    // Replay the packets, only emitting the commands whose state changed
+    u64                     LastPass       = 0;
+    pipeline                LastPipeline   = 0;
+    descriptor_set          LastSet        = 0;
+    command_list_cmd       *LastObjectData = NULL;
+    
+    render_command_stats *Profile = Context->Stats.Commands;
+    for (u32 i = 0; i < DrawCount; ++i)
+    {
+        sorted_draw *Draw = Draws + Values[i];
+        
+        // Passes sort above pipelines, so the first draw of a pass can share the
+        // pipeline of the previous pass. Its set and object data were recorded in
+        // a different part of the list and are not inherited.
+        if (Draw->Pass != LastPass)
+        {
+            LastPass       = Draw->Pass;
+            LastSet        = 0;
+            LastObjectData = NULL;
+        }
+        
+        if (Draw->Pipeline != LastPipeline)
+        {
+            cmd_bind_pipeline_packet Packet = { Draw->Pipeline };
+            
+            mp_profile_start(Start);
+            mp_translate_bind_pipeline(Context, &Packet);
+            mp_profile_end(Start, Profile[CmdType_BindPipeline].TranslateNs);
+            Profile[CmdType_BindPipeline].Translated++;
+            
+            // The pipeline bind may have invalidated the other sets
+            LastPipeline   = Draw->Pipeline;
+            LastSet        = 0;
+            LastObjectData = NULL;
+        }
+        
+        if (Draw->Set && Draw->Set != LastSet)
+        {
+            cmd_bind_descriptor_packet Packet = { Draw->Set };
+            
+            mp_profile_start(Start);
+            mp_translate_bind_descriptor(Context, &Packet);
+            mp_profile_end(Start, Profile[CmdType_BindDescriptor].TranslateNs);
+            Profile[CmdType_BindDescriptor].Translated++;
+            LastSet = Draw->Set;
+        }
+        
+        if (Draw->ObjectData && Draw->ObjectData != LastObjectData)
+        {
+            u8 Type = Draw->ObjectData->Type;
+            
+            mp_profile_start(Start);
+            CmdDecoders[Type](Context, cmd_data(Draw->ObjectData));
+            mp_profile_end(Start, Profile[Type].TranslateNs);
+            Profile[Type].Translated++;
+            
+            LastObjectData = Draw->ObjectData;
+        }
+        
+        cmd_draw_packet Packet = { Draw->RenderComponent };
+        
+        mp_profile_start(Start);
+        mp_translate_draw(Context, &Packet);
+        mp_profile_end(Start, Profile[CmdType_Draw].TranslateNs);
+        Profile[CmdType_Draw].Translated++;
+    }
+    
+    pfree(Values);
+    pfree(Keys);
+    pfree(Draws);
+}
+
+// Composes the model matrices of every object data command in the list in one
+// go, before any of them is translated. The transforms are gathered into SoA
+// arrays for mat4_compose_soa and each packet is given the index of its matrix
+// in Context->Models.
+//
+// TODO(Dustin): Set up real model matrix, the translation is applied before
+// the rotation and the scale (see mat4_compose).
+file_internal void mp_command_list_compose_models(translate_context *Context, command_list CommandList,
+                                                  u32 ObjectCount)
+{
+    // NOTE(Dustin): The frame arena is not thread safe, see mp_command_list_translate_sorted
+    r32 *Components = palloc<r32>(ObjectCount * 10);
+    
+    transform_soa Transforms;
+    Transforms.PositionX = Components;
+    Transforms.PositionY = Components + ObjectCount;
+    Transforms.PositionZ = Components + ObjectCount * 2;
+    Transforms.ScaleX    = Components + ObjectCount * 3;
+    Transforms.ScaleY    = Components + ObjectCount * 4;
+    Transforms.ScaleZ    = Components + ObjectCount * 5;
+    Transforms.RotationX = Components + ObjectCount * 6;
+    Transforms.RotationY = Components + ObjectCount * 7;
+    Transforms.RotationZ = Components + ObjectCount * 8;
+    Transforms.RotationW = Components + ObjectCount * 9;
+    
+    u32 ObjectIdx = 0;
+    command_list_iterator Iter = mp_command_list_begin(CommandList);
+    while (command_list_cmd *Cmd = mp_command_list_next(&Iter))
+    {
+        if (Cmd->Type != CmdType_UpdateObjectData) continue;
+        
+        cmd_object_data_packet *Packet = (cmd_object_data_packet*)cmd_data(Cmd);
+        Transforms.PositionX[ObjectIdx] = Packet->Position.x;
+        Transforms.PositionY[ObjectIdx] = Packet->Position.y;
+        Transforms.PositionZ[ObjectIdx] = Packet->Position.z;
+        Transforms.ScaleX[ObjectIdx]    = Packet->Scale.x;
+        Transforms.ScaleY[ObjectIdx]    = Packet->Scale.y;
+        Transforms.ScaleZ[ObjectIdx]    = Packet->Scale.z;
+        Transforms.RotationX[ObjectIdx] = Packet->Rotation.x;
+        Transforms.RotationY[ObjectIdx] = Packet->Rotation.y;
+        Transforms.RotationZ[ObjectIdx] = Packet->Rotation.z;
+        Transforms.RotationW[ObjectIdx] = Packet->Rotation.w;
+        
+        Packet->ModelIndex = ObjectIdx++;
+    }
+    
+    Context->Models = palloc<mat4>(ObjectIdx);
+    mat4_compose_soa(&Transforms, ObjectIdx, Context->Models, sizeof(mat4));
+    
+    pfree(Components);
+}
+
+// Translates the list into the context's command buffer and empties it
+file_internal void mp_command_list_translate(translate_context *Context, command_list CommandList)
+{
+    u64 TranslateStart = renderer_clock_ns();
+    
+    mp_command_list_sync_epoch(CommandList);
+    
+    u32 ObjectCount = CommandList->Profile[CmdType_UpdateObjectData].Recorded;
+    if (ObjectCount)
+    {
+        mp_profile_start(Start);
+        mp_command_list_compose_models(Context, CommandList, ObjectCount);
+        mp_profile_end(Start, Context->Stats.Commands[CmdType_UpdateObjectData].TranslateNs);
+    }
+    
+    if (CommandList->IsSorted)
+    {
+        mp_command_list_translate_sorted(Context, CommandList);
+    }
+    else
+    {
+        command_list_iterator Iter = mp_command_list_begin(CommandList);
+        while (command_list_cmd *Cmd = mp_command_list_next(&Iter))
+        {
+            render_command_stats *Profile = Context->Stats.Commands + Cmd->Type;
+            
+            mp_profile_start(Start);
+            CmdDecoders[Cmd->Type](Context, cmd_data(Cmd));
+            mp_profile_end(Start, Profile->TranslateNs);
+            Profile->Translated++;
+        }
+    }
+    
+    mp_flush_instances(Context);
+    mp_flush_indirect(Context);
+    
+    if (Context->Models)
+    {
+        pfree(Context->Models);
+        Context->Models = NULL;
+    }
+    
+    for (u32 Type = 0; Type < CmdType_Count; ++Type)
+    {
+        Context->Stats.Commands[Type].Recorded += CommandList->Profile[Type].Recorded;
+        Context->Stats.Commands[Type].RecordNs += CommandList->Profile[Type].RecordNs;
+    }
+    
+    mp_command_list_rewind(CommandList);
+    
+    Context->Stats.TranslateNs += renderer_clock_ns() - TranslateStart;
+}
+
+// Begins a secondary command buffer that continues the primary render pass and
+// points the context at it
+file_internal void mp_translate_context_begin_secondary(translate_context *Context, VkCommandBuffer CommandBuffer,
+                                                        bool OneTimeSubmit)
 {
-    VkDescriptorSetLayout Handle;
-} mp_descriptor_layout;
+    Core->VkCore.BeginSecondaryCommandBuffer(CommandBuffer, Core->Renderer->PrimaryRenderPass, 0,
+                                             Core->Renderer->Framebuffers[Core->Renderer->CurrentImageIndex],
+                                             OneTimeSubmit);
+    Core->VkCore.SetScissor(CommandBuffer, 0, 1, &Core->Renderer->ActiveScissor);
+    Core->VkCore.SetViewport(CommandBuffer, 0, 1, &Core->Renderer->ActiveViewport);
+    
+    // Nothing is bound on a freshly begun command buffer
+    Context->CommandBuffer  = CommandBuffer;
+    Context->ActivePipeline = NULL;
+    Context->BoundState     = {};
+    Context->ObjectData     = NULL;
+    Context->ObjectDataSets = NULL;
+    Context->InstanceBuffer = NULL;
+    Context->InstanceModel  = {};
+}
 
-typedef struct mp_descriptor_set
+//~ Static command lists
+
+// Everything a static list's recorded command buffer depends on besides the
+// commands themselves. Resources referenced by the commands are covered by the
+// resource version, which is coarse: any change to any resource re-records
+// every static list once.
+file_internal u64 mp_command_list_cache_key(command_list CommandList)
 {
-    VkDescriptorSet *Handles;
-    u32              HandleCount;
+    renderer *Renderer = Core->Renderer;
     
-    u32              Binding;
-    u32              Set;
-} mp_descriptor_set;
+    u64 Key = CommandList->Hash;
+    Key = stbds_hash_bytes(&Resources->Version,      sizeof(u32),        Key);
+    Key = stbds_hash_bytes(&Renderer->RenderMode,    sizeof(u32),        Key);
+    Key = stbds_hash_bytes(&Renderer->ActiveViewport, sizeof(VkViewport), Key);
+    Key = stbds_hash_bytes(&Renderer->ActiveScissor,  sizeof(VkRect2D),   Key);
+    
+    // The draw order of a sorted list depends on the view
+    if (CommandList->IsSorted)
+    {
+        Key = stbds_hash_bytes(&Renderer->ActiveCamera.View, sizeof(mat4), Key);
+    }
+    
+    return (Key) ? Key : 1;
+}
 
-typedef struct mp_image
+// Makes room for the object data of every object data command in the list
+file_internal void mp_command_list_reserve_object_data(command_list CommandList)
 {
-    VkImage           Handle;
-    VkImageView       View;
-    VkSampler         Sampler;
-    VkFormat          Format;
+    if (CommandList->ObjectCount <= CommandList->ObjectCapacity) return;
     
-    VmaAllocation     Memory;
-    VmaAllocationInfo AllocationInfo;
+    u32 Capacity = (CommandList->ObjectCapacity) ? CommandList->ObjectCapacity * 2 : 16;
+    while (Capacity < CommandList->ObjectCount) Capacity *= 2;
     
-    u32               Width;
-    u32               Height;
-    u32               MipLevels;
+    if (CommandList->ObjectCapacity)
+    {
+        // The old buffer might still be read by a frame in flight
+        Core->VkCore.Idle();
+        mp_command_list_free_object_data(CommandList);
+    }
     
-    image_layout CurrentLayout;
+    u64 MinAlignment = Core->VkCore.GetMinUniformMemoryOffsetAlignment();
+    mp_dynamic_uniform_buffer_init(&CommandList->ObjectData, Capacity * memory_align(sizeof(mat4), MinAlignment));
     
-} mp_image;
-
-void mp_command_pool_init(command_pool *CommandPool)
-{
-    u64 InitialMemory = _64KB;
-    u64 StartingCommandListSize = _KB(1) * sizeof(command_list_cmd);
+    VkDescriptorPoolSize PoolSize = {};
+    PoolSize.type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    PoolSize.descriptorCount = CommandList->CommandListCount;
+    CommandList->ObjectDataPool = Core->VkCore.CreateDescriptorPool(&PoolSize, 1, CommandList->CommandListCount, 0);
     
-    command_pool pCommandPool = (command_pool)memory_alloc(Core->Memory, sizeof(mp_command_pool));
-    pCommandPool->LastCommandListSize = StartingCommandListSize;
-    pCommandPool->Ptr = memory_alloc(Core->Memory, InitialMemory);
-    memory_init(&pCommandPool->Pool, InitialMemory, pCommandPool->Ptr);
+    VkDescriptorSetLayout *Layouts = palloc<VkDescriptorSetLayout>(CommandList->CommandListCount);
+    for (u32 LayoutIdx = 0; LayoutIdx < CommandList->CommandListCount; ++LayoutIdx)
+        Layouts[LayoutIdx] = Core->Renderer->ObjectDataBuffer.DescriptorLayout;
     
-    pCommandPool->Handle = Core->VkCore.CreateCommandPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
-                                                          VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VkDescriptorSetAllocateInfo AllocInfo = {};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    AllocInfo.descriptorPool     = CommandList->ObjectDataPool;
+    AllocInfo.descriptorSetCount = CommandList->CommandListCount;
+    AllocInfo.pSetLayouts        = Layouts;
     
-    *CommandPool = pCommandPool;
-}
-
-void mp_command_pool_free(command_pool *CommandPool)
-{
-    Core->VkCore.DestroyCommandPool((*CommandPool)->Handle);
+    CommandList->ObjectDataSets = palloc<VkDescriptorSet>(CommandList->CommandListCount);
+    Core->VkCore.CreateDescriptorSets(CommandList->ObjectDataSets, AllocInfo);
+    pfree(Layouts);
     
-    memory_free(&(*CommandPool)->Pool);
-    memory_release(Core->Memory, (*CommandPool)->Ptr);
-    memory_release(Core->Memory, *CommandPool);
-    *CommandPool = NULL;
+    object_data_buffer_write_sets(CommandList->ObjectDataSets, &CommandList->ObjectData);
+    CommandList->ObjectCapacity = Capacity;
+    
+    // Every recorded buffer refers to the old sets
+    memset(CommandList->CacheKeys, 0, sizeof(u64) * CommandList->CommandListCount);
 }
 
-void mp_command_list_init(command_list *CommandList, command_pool CommandPool)
+// Makes room for the models and indirect commands of the list's instanced draws.
+// Every draw adds one model and at most one indirect command, the bound covers
+// each draw starting a run of its own and paying the alignment of both allocs.
+file_internal void mp_command_list_reserve_instances(command_list CommandList)
 {
-    command_list pCommandList  = (command_list)memory_alloc(&CommandPool->Pool, sizeof(mp_command_list));
-    pCommandList->AttachedPool = CommandPool;
-    pCommandList->Start        = (char*)memory_alloc(&pCommandList->AttachedPool->Pool, CommandPool->LastCommandListSize);
-    pCommandList->End          = (char*)pCommandList->Start + CommandPool->LastCommandListSize;
-    pCommandList->Offset       = (char*)pCommandList->Start;
-    pCommandList->IsActive     = false;
-    pCommandList->CommandCount = 0;
+    if (!CommandList->HasInstancing) return;
     
-    pCommandList->CommandListCount = Core->VkCore.GetSwapChainImageCount();
-    pCommandList->Handles = (VkCommandBuffer*)memory_alloc(Core->Memory, pCommandList->CommandListCount);
-    Core->VkCore.CreateCommandBuffers(pCommandList->AttachedPool->Handle,
-                                      VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-                                      pCommandList->CommandListCount,
-                                      pCommandList->Handles);
+    u32 DrawCount = CommandList->Profile[CmdType_Draw].Recorded;
+    u64 Required  = (u64)DrawCount * (2 * sizeof(mat4) + sizeof(VkDrawIndexedIndirectCommand) + 2 * sizeof(u32));
     
-    *CommandList = pCommandList;
-}
-
-void mp_command_list_free(command_list *CommandList)
-{
-    memory_release(Core->Memory, (*CommandList)->Handles);
-    memory_release(&(*CommandList)->AttachedPool->Pool, (*CommandList)->Start);
-    (*CommandList)->Start        = NULL;
-    (*CommandList)->End          = NULL;
-    (*CommandList)->Offset       = NULL;
+    mp_instance_buffer *Instances = &CommandList->Instances;
+    if (Required <= Instances->Size) return;
     
-    command_pool CommandPool = (*CommandList)->AttachedPool;
-    (*CommandList)->AttachedPool = NULL;
+    u64 Size = (Instances->Size) ? (u64)Instances->Size * 2 : _KB(16);
+    while (Size < Required) Size *= 2;
+    if (Size > 0xFFFFFFFF) Size = Required;
+    
+    if (Instances->Size)
+    {
+        // The old buffer might still be read by a frame in flight
+        Core->VkCore.Idle();
+        mp_command_list_free_instances(CommandList);
+    }
     
-    memory_release(&CommandPool->Pool, (*CommandList));
+    u32 HandleCount = CommandList->CommandListCount;
+    Instances->Handles = palloc<buffer_parameters>(HandleCount);
+    Instances->Sets    = palloc<VkDescriptorSet>(HandleCount);
+    Instances->Size    = (u32)Size;
     
-    *CommandList = NULL;
+    VkDescriptorPoolSize PoolSize = {};
+    PoolSize.type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    PoolSize.descriptorCount = HandleCount;
+    Instances->Pool = Core->VkCore.CreateDescriptorPool(&PoolSize, 1, HandleCount, 0);
+    
+    VkDescriptorSetLayout *Layouts = palloc<VkDescriptorSetLayout>(HandleCount);
+    for (u32 LayoutIdx = 0; LayoutIdx < HandleCount; ++LayoutIdx)
+        Layouts[LayoutIdx] = Core->Renderer->ObjectDataBuffer.InstanceLayout;
+    
+    VkDescriptorSetAllocateInfo AllocInfo = {};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    AllocInfo.descriptorPool     = Instances->Pool;
+    AllocInfo.descriptorSetCount = HandleCount;
+    AllocInfo.pSetLayouts        = Layouts;
+    
+    Core->VkCore.CreateDescriptorSets(Instances->Sets, AllocInfo);
+    pfree(Layouts);
+    
+    for (u32 HandleIdx = 0; HandleIdx < HandleCount; ++HandleIdx)
+    {
+        buffer_parameters *Handle = Instances->Handles + HandleIdx;
+        
+        VkBufferCreateInfo create_info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+        create_info.size  = Instances->Size;
+        create_info.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        
+        VmaAllocationCreateInfo alloc_info = {};
+        alloc_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+        alloc_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        
+        Core->VkCore.CreateVmaBuffer(create_info,
+                                     alloc_info,
+                                     Handle->Handle,
+                                     Handle->Memory,
+                                     Handle->AllocationInfo);
+        Handle->Size = Instances->Size;
+        
+        VkDescriptorBufferInfo BufferInfo = {};
+        BufferInfo.buffer = Handle->Handle;
+        BufferInfo.offset = 0;
+        BufferInfo.range  = VK_WHOLE_SIZE;
+        
+        VkWriteDescriptorSet DescriptorWrite = {};
+        DescriptorWrite.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        DescriptorWrite.dstSet          = Instances->Sets[HandleIdx];
+        DescriptorWrite.dstBinding      = 0;
+        DescriptorWrite.dstArrayElement = 0;
+        DescriptorWrite.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        DescriptorWrite.descriptorCount = 1;
+        DescriptorWrite.pBufferInfo     = &BufferInfo;
+        
+        Core->VkCore.UpdateDescriptorSets(&DescriptorWrite, 1);
+    }
+    
+    // Every recorded buffer refers to the old sets
+    memset(CommandList->CacheKeys, 0, sizeof(u64) * CommandList->CommandListCount);
 }
 
-
-// Memory Layout for a Single Command List Cmd
-// | Type , DataSize | Data
-//
-// alloc(CommandPool, sizeof(command_list_cmd) + DataSize)
-//
-// char *Offset = (char*)CommandList->Start;
-// for each element in commandlist
-//    command_list_cmd *Cmd = (command_list_cmd*)Offset;
-//    u32 *Size = (u32*)(Offset + sizeof(cmd_type));
-//    void *Data = Offset + sizeof(command_list_cmd);
-//
-//    Offset += sizeof(cmd_type) + sizeof(u32) + *Size;
-//
-
-void mp_command_list_add(command_list CommandList, cmd_type Type, u32 DataSize, void *Data)
+// Returns the static list's command buffer for the current swapchain image. The
+// buffer is only translated again when its cache key changed, otherwise the list
+// is just emptied.
+file_internal VkCommandBuffer mp_command_list_record_static(translate_context *Context, command_list CommandList)
 {
-    u32 NeededMemory = sizeof(command_list_cmd) + DataSize;
+    u32 ImageIndex = Core->Renderer->CurrentImageIndex;
+    VkCommandBuffer CommandBuffer = CommandList->Handles[ImageIndex];
+    
+    mp_command_list_reserve_object_data(CommandList);
+    mp_command_list_reserve_instances(CommandList);
     
-    if (CommandList->Offset + NeededMemory > CommandList->End)
+    u64 Key = mp_command_list_cache_key(CommandList);
+    if (CommandList->CacheKeys[ImageIndex] == Key)
     {
-        // TODO(Dustin): Resize the CommandList!
+        Context->Stats.StaticListsReplayed++;
+        mp_command_list_rewind(CommandList);
+        return CommandBuffer;
     }
     
-    char *Ptr = CommandList->Offset;
-    CommandList->Offset += NeededMemory;
+    // NOTE(Dustin): Like the primary command buffers, the buffer of a swapchain
+    // image is done executing once the image is acquired again, BeginFrame waits
+    // for the frame that last rendered to the image.
+    mp_translate_context_begin_secondary(Context, CommandBuffer, false);
+    
+    // Only the current image's copy is rewritten, mp_dynamic_uniform_buffer_alloc
+    // writes to the handle of the current image
+    assert(CommandList->ObjectData.HandleCount == CommandList->CommandListCount);
+    mp_dynamic_uniform_buffer_reset(&CommandList->ObjectData);
+    Context->ObjectData     = &CommandList->ObjectData;
+    Context->ObjectDataSets = CommandList->ObjectDataSets;
+    
+    // Same for the instance buffer, which is only used when instanced pipelines
+    // were bound
+    mp_instance_buffer *Instances = &CommandList->Instances;
+    Instances->Used = 0;
+    if (Instances->Size) Context->InstanceBuffer = Instances;
+    
+    mp_command_list_translate(Context, CommandList);
+    
+    // The transient ring is flushed before the frame is submitted, the list's
+    // buffer is not part of it
+    if (Instances->Used)
+    {
+        Core->VkCore.VmaFlushAllocation(Instances->Handles[ImageIndex].Memory, 0, Instances->Used);
+    }
     
-    command_list_cmd *Cmd = (command_list_cmd*)Ptr;
-    Cmd->Type = Type;
-    Cmd->DataSize = DataSize;
-    memcpy(Ptr + sizeof(command_list_cmd), Data, DataSize);
+    Core->VkCore.EndCommandBuffer(CommandBuffer);
     
-    CommandList->CommandCount ++;
+    CommandList->CacheKeys[ImageIndex] = Key;
+    Context->Stats.StaticListsRecorded++;
+    
+    return CommandBuffer;
 }
 
 void mp_command_list_execute(command_list CommandList)
 {
-    if (Core->Renderer->ActiveCommandBuffer)
-    {
-        VkCommandBuffer *ActiveCommandBuffer = Core->Renderer->ActiveCommandBuffer;
-        
-        char *Offset = CommandList->Start;
-        for (u32 i = 0; i < CommandList->CommandCount; ++i)
-        {
-            command_list_cmd *Cmd = (command_list_cmd*)Offset;
-            void *Data = Offset + sizeof(command_list_cmd);
-            
-            // TODO(Dustin): Big ol' switch state for processing various commands
-            switch (Cmd->Type)
-            {
-                case CmdType_BeginFrame:
-                {
-                } break;
-                
-                case CmdType_EndFrame:
-                {
-                } break;
-                
-                case CmdType_BindPipeline:
-                {
-                    cmd_bind_pipeline_info *PipelineInfo = (cmd_bind_pipeline_info*)Data;
-                    
-                    if (Core->Renderer->RenderMode & RenderMode_Solid)
-                    {
-                        Core->VkCore.BindPipeline(*ActiveCommandBuffer, PipelineInfo->Pipeline->Handle);
-                    }
-                    else if (Core->Renderer->RenderMode & RenderMode_Wireframe)
-                    {
-                        Core->VkCore.BindPipeline(*ActiveCommandBuffer, PipelineInfo->Pipeline->Wireframe);
-                    }
-                    
-                    Core->Renderer->ActivePipeline = PipelineInfo->Pipeline;
-                    Core->VkCore.BindDescriptorSets(*ActiveCommandBuffer,
-                                                    Core->Renderer->ActivePipeline->Layout,
-                                                    0,
-                                                    1,
-                                                    &Core->Renderer->GlobalShaderData.DescriptorSets[Core->Renderer->CurrentImageIndex],
-                                                    0, NULL);
-                } break;
-                
-                case CmdType_BindDescriptor:
-                {
-                    descriptor_set Set = (descriptor_set)Data;
-                    
-                    Core->VkCore.BindDescriptorSets(*ActiveCommandBuffer,
-                                                    Core->Renderer->ActivePipeline->Layout,
-                                                    Set->Set,
-                                                    1,
-                                                    &Set->Handles[Core->Renderer->CurrentImageIndex],
-                                                    0, NULL);
-                } break;
-                
-                case CmdType_Draw:
-                {
-                    render_component RenderComponent = (render_component)Data;
-                    
-                    // Bind Vertex Buffers
-                    {
-                        u32 BuffersCount = 1;
-                        
-                        VkBuffer Buffers[1] = {
-                            RenderComponent->VertexBuffer.Handle,
-                        };
-                        
-                        u64 BufferOffsets[1] = {
-                            0
-                        };
-                        
-                        Core->VkCore.BindVertexBuffers(*ActiveCommandBuffer, 0, BuffersCount,
-                                                       Buffers, BufferOffsets);
-                    }
-                    
-                    if (RenderComponent->IsIndexed)
-                    {
-                        // Bind Index Buffers
-                        Core->VkCore.BindIndexBuffer(*ActiveCommandBuffer, 
-                                                     RenderComponent->IndexBuffer.Handle, 
-                                                     0, 
-                                                     RenderComponent->IndexType);
-                        
-                        Core->VkCore.DrawIndexed(*ActiveCommandBuffer, RenderComponent->DrawCount, 1, 0, 0, 0);
-                    }
-                    else
-                    {
-                        Core->VkCore.Draw(*ActiveCommandBuffer, RenderComponent->DrawCount, 1, 0, 0);
-                    }
-                    
-                } break;
-                
-                case CmdType_SetCamera:
-                {
-                    camera_data *CameraData = (camera_data*)Data;
-                    
-                    Core->Renderer->ActiveCamera.Projection = CameraData->Projection;
-                    Core->Renderer->ActiveCamera.View       = CameraData->View;
-                    
-                    mp_uniform_buffer_update(&Core->Renderer->GlobalShaderData.Buffer,
-                                             &Core->Renderer->ActiveCamera,
-                                             sizeof(camera_data),
-                                             0);
-                    
-                    // NOTE(Dustin): The descriptor is bound with the pipeline since it is a 
-                    // global descriptor
-                } break;
-                
-                case CmdType_UpdateObjectData:
-                {
-                    cmd_set_object_world_data_info *ObjectData = (cmd_set_object_world_data_info*)Data;
-                    
-                    // TODO(Dustin): Set up real model matrix
-                    mat4 Translation = translate(ObjectData->Position);
-                    mat4 Scale       = scale(ObjectData->Scale.x, ObjectData->Scale.y, ObjectData->Scale.z);
-                    mat4 Rotation    = quaternion_get_rotation_matrix(ObjectData->Rotation);
-                    
-                    mat4 Model = mat4_diag(1.0f);
-                    Model = mat4_mul(Model, Scale);
-                    Model = mat4_mul(Model, Rotation);
-                    Model = mat4_mul(Model, Translation);
-                    
-                    u32 Offset = mp_dynamic_uniform_buffer_alloc(&Core->Renderer->ObjectDataBuffer.Buffer,
-                                                                 &Model,
-                                                                 sizeof(mat4));
-                    
-                    Core->VkCore.BindDescriptorSets(*ActiveCommandBuffer,
-                                                    Core->Renderer->ActivePipeline->Layout,
-                                                    1,
-                                                    1,
-                                                    &Core->Renderer->ObjectDataBuffer.DescriptorSets[Core->Renderer->CurrentImageIndex],
-                                                    1, &Offset);
-                } break;
-                
-            }
-            
-            Offset += sizeof(command_list_cmd) + Cmd->DataSize;
-        }
-    }
-    else
+    if (!Core->Renderer->ActiveCommandBuffer)
     {
         Platform->mprinte("Attempting to execute a Command List without an active Command Buffer. Have you called \"begin_frame\"?\n");
+        mp_command_list_sync_epoch(CommandList);
+        mp_command_list_rewind(CommandList);
+        return;
     }
     
-    CommandList->CommandCount = 0;
-    CommandList->Offset = CommandList->Start;
+    renderer_begin_render_pass(VK_SUBPASS_CONTENTS_INLINE);
+    mp_command_list_translate(&Core->Renderer->PrimaryContext, CommandList);
 }
 
 INITIALIZE_GRAPHICS(initialize_graphics)
 {
     Platform = CreateInfo->Platform;
     
-    u32 MemorySize = _1MB;
+    u32 MemorySize = _MB(16);
     
     // Initialize memory
     void *PlatformMemory = Platform->request_memory(MemorySize);
@@ -406,6 +1850,9 @@ INITIALIZE_GRAPHICS(initialize_graphics)
     Core = (globals*)memory_alloc(pMemory, sizeof(globals));
     Core->Memory = pMemory;
     
+    Resources = palloc<resource_pools>();
+    resource_pools_init(Resources);
+    
     // Initialize Vulkan
     Platform->mprint("Initializing Vulkan...\n");
     Core->VkCore = {};
@@ -425,6 +1872,10 @@ SHUTDOWN_GRAPHICS(shutdown_graphics)
     
     Core->VkCore.Shutdown();
     
+    resource_pools_free(Resources);
+    pfree(Resources);
+    Resources = NULL;
+    
     memory Memory = *Core->Memory;
     void *MemoryPtr = Memory.Start;;
     
@@ -444,35 +1895,41 @@ BEGIN_FRAME(begin_frame)
 
 END_FRAME(end_frame)
 {
-#if 0
-    if (EndFrameInfo->CommandListCount <= 3)
+    if (EndFrameInfo && EndFrameInfo->CommandListCount)
     {
-        VkCommandBuffer CommandBuffers[3];
-        for (u32 i = 0; i < EndFrameInfo->CommandListCount; ++i)
+        if (Core->Renderer->IsRenderPassActive)
         {
-            CommandBuffers[i] = EndFrameInfo->CommandList[i]->Handles[Renderer.CurrentImageIndex];
+            // NOTE(Dustin): Lists were already executed inline this frame and a
+            // subpass can not mix inline commands with secondary command buffers,
+            // so these are translated inline as well.
+            for (u32 ListIdx = 0; ListIdx < EndFrameInfo->CommandListCount; ++ListIdx)
+            {
+                mp_command_list_execute(EndFrameInfo->CommandList[ListIdx]);
+            }
         }
-        
-        Core->VkCore.EndFrame(Renderer.CurrentImageIndex, CommandBuffers, EndFrameInfo->CommandListCount);
-    }
-    else
-    {
-        VkCommandBuffer *CommandBuffers = (VkCommandBuffer*)memory_alloc(Core->Memory, 
-                                                                         sizeof(VkCommandBuffer) * EndFrameInfo->CommandListCount);
-        for (u32 i = 0; i < EndFrameInfo->CommandListCount; ++i)
+        else
         {
-            CommandBuffers[i] = EndFrameInfo->CommandList[i]->Handles[Renderer.CurrentImageIndex];
+            renderer_begin_render_pass(VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            
+            VkCommandBuffer *CommandBuffers = palloc<VkCommandBuffer>(EndFrameInfo->CommandListCount);
+            u32 CommandBufferCount = render_workers_translate(EndFrameInfo->CommandList,
+                                                              EndFrameInfo->CommandListCount,
+                                                              CommandBuffers);
+            if (CommandBufferCount)
+            {
+                Core->VkCore.ExecuteCommands(*Core->Renderer->ActiveCommandBuffer, CommandBufferCount, CommandBuffers);
+            }
+            
+            pfree(CommandBuffers);
         }
-        
-        Core->VkCore.EndFrame(Renderer.CurrentImageIndex, CommandBuffers, EndFrameInfo->CommandListCount);
-        
-        memory_release(Core->Memory, CommandBuffers);
     }
-#else
     
     renderer_end_frame();
-    
-#endif
+}
+
+GET_RENDER_STATS(get_render_stats)
+{
+    *Stats = Core->Renderer->LastFrameStats;
 }
 
 WAIT_FOR_LAST_FRAME(wait_for_last_frame)
@@ -498,7 +1955,7 @@ create_command_list(&info);
 
 CREATE_COMMAND_LIST(create_command_list)
 {
-    mp_command_list_init(CreateInfo->CommandList, CreateInfo->CommandPool);
+    mp_command_list_init(CreateInfo->CommandList, CreateInfo->CommandPool, CreateInfo->IsSorted, CreateInfo->IsStatic);
 }
 
 FREE_COMMAND_LIST(free_command_list)
@@ -521,6 +1978,11 @@ FREE_COMMAND_POOL(free_command_pool)
     mp_command_pool_free(CommandPool);
 }
 
+RESET_COMMAND_POOL(reset_command_pool)
+{
+    mp_command_pool_reset(CommandPool);
+}
+
 file_internal void LoadShader(char *ShaderFileName,
                               VkShaderStageFlagBits ShaderStage,
                               VkShaderModule &ShaderModule,
@@ -547,7 +2009,9 @@ file_internal void LoadShader(char *ShaderFileName,
 
 CREATE_PIPELINE(create_pipeline) 
 {
-    pipeline pPipeline = (pipeline)memory_alloc(Core->Memory, sizeof(mp_pipeline));
+    mp_pipeline *pPipeline;
+    *Pipeline = resource_pool_alloc(&Resources->Pipelines, &pPipeline);
+    if (!pPipeline) return;
     
     VkShaderModule ShaderModules[5];
     VkPipelineShaderStageCreateInfo ShaderStages[5];
@@ -689,22 +2153,49 @@ CREATE_PIPELINE(create_pipeline)
     
     // The descriptors...needs to append descriptors the renderer handles internally.
     // 1. GlobalShaderData DescriptorLayout
-    // 2. ObjectDataBuffer DescriptorLayout
+    // 2. ObjectDataBuffer DescriptorLayout, or its InstanceLayout when instanced
     u32 LayoutCount = PipelineInfo->DescriptorLayoutsCount + 2;
-    VkDescriptorSetLayout *Layouts = (VkDescriptorSetLayout*)memory_alloc(Core->Memory, 
-                                                                          LayoutCount * sizeof(VkDescriptorSetLayout));
+    VkDescriptorSetLayout *Layouts = talloc<VkDescriptorSetLayout>(LayoutCount);
     Layouts[0] = Core->Renderer->GlobalShaderData.DescriptorLayout;
-    Layouts[1] = Core->Renderer->ObjectDataBuffer.DescriptorLayout;
+    pPipeline->HasInstancing     = PipelineInfo->HasInstancing || PipelineInfo->HasIndirectDraws;
+    pPipeline->HasIndirectDraws  = PipelineInfo->HasIndirectDraws;
+    pPipeline->HasPushObjectData = PipelineInfo->HasPushObjectData && !pPipeline->HasInstancing;
+    Layouts[1] = (pPipeline->HasInstancing) ? Core->Renderer->ObjectDataBuffer.InstanceLayout :
+        Core->Renderer->ObjectDataBuffer.DescriptorLayout;
+    
+    if (PipelineInfo->HasPushObjectData && pPipeline->HasInstancing)
+    {
+        Platform->mprinte("Instanced pipelines read their object data from the instance buffer, ignoring HasPushObjectData!\n");
+    }
     
     for (u32 i = 0; i < PipelineInfo->DescriptorLayoutsCount; ++i)
     {
-        Layouts[i + 2] = PipelineInfo->DescriptorLayouts[i]->Handle;
+        mp_descriptor_layout *Layout = resource_pool_get(&Resources->DescriptorLayouts, PipelineInfo->DescriptorLayouts[i]);
+        Layouts[i + 2] = (Layout) ? Layout->Handle : VK_NULL_HANDLE;
+    }
+    
+    // The object data push constant goes in front of the user's ranges
+    u32 PushConstantCount = PipelineInfo->PushConstantsCount + ((pPipeline->HasPushObjectData) ? 1 : 0);
+    VkPushConstantRange *PushConstants = talloc<VkPushConstantRange>(PushConstantCount);
+    
+    u32 PushConstantIdx = 0;
+    if (pPipeline->HasPushObjectData)
+    {
+        PushConstants[PushConstantIdx].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        PushConstants[PushConstantIdx].offset     = 0;
+        PushConstants[PushConstantIdx].size       = sizeof(mat4);
+        PushConstantIdx++;
+    }
+    
+    for (u32 i = 0; i < PipelineInfo->PushConstantsCount; ++i)
+    {
+        PushConstants[PushConstantIdx++] = PipelineInfo->PushConstants[i];
     }
     
     PipelineLayoutInfo.setLayoutCount         = LayoutCount;
     PipelineLayoutInfo.pSetLayouts            = Layouts;
-    PipelineLayoutInfo.pushConstantRangeCount = PipelineInfo->PushConstantsCount;
-    PipelineLayoutInfo.pPushConstantRanges    = PipelineInfo->PushConstants;
+    PipelineLayoutInfo.pushConstantRangeCount = PushConstantCount;
+    PipelineLayoutInfo.pPushConstantRanges    = PushConstants;
     
     pPipeline->Layout = Core->VkCore.CreatePipelineLayout(PipelineLayoutInfo);
     
@@ -811,44 +2302,81 @@ CREATE_PIPELINE(create_pipeline)
     {
         Core->VkCore.DestroyShaderModule(ShaderModules[Shader]);
     }
-    
-    memory_release(Core->Memory, Layouts);
-    
-    *Pipeline = pPipeline;
 }
 
 FREE_PIPELINE(free_pipeline) 
 {
-    Core->VkCore.DestroyPipelineLayout((*Pipeline)->Layout);
-    Core->VkCore.DestroyPipeline((*Pipeline)->Handle);
-    Core->VkCore.DestroyPipeline((*Pipeline)->Wireframe);
-    Core->VkCore.DestroyPipeline((*Pipeline)->NormalVis);
+    mp_pipeline *pPipeline = resource_pool_get(&Resources->Pipelines, *Pipeline);
+    if (pPipeline)
+    {
+        Core->VkCore.DestroyPipelineLayout(pPipeline->Layout);
+        Core->VkCore.DestroyPipeline(pPipeline->Handle);
+        Core->VkCore.DestroyPipeline(pPipeline->Wireframe);
+        Core->VkCore.DestroyPipeline(pPipeline->NormalVis);
+        
+        resource_pool_release(&Resources->Pipelines, *Pipeline);
+        Resources->Version++;
+    }
     
-    memory_release(Core->Memory, (*Pipeline));
-    *Pipeline = NULL;
+    *Pipeline = 0;
 }
 
-CREATE_RENDER_COMPONENT(create_render_component)
+file_internal u32 mp_index_size(VkIndexType IndexType)
 {
-    render_component Result = (render_component)memory_alloc(Core->Memory, sizeof(mp_render_component));
-    
-    VkBufferCreateInfo VertexBufferInfo = {};
-    VertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    VertexBufferInfo.size  = RenderInfo->VertexCount * RenderInfo->VertexStride;
-    VertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    
-    VmaAllocationCreateInfo VertexAllocInfo = {};
-    VertexAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    return (IndexType == VK_INDEX_TYPE_UINT16) ? 2 : 4;
+}
+
+// Gives suballocated geometry back to the geometry heap, or destroys the buffer
+// when the component owns it
+file_internal void mp_render_component_release_buffer(buffer_parameters *Buffer, geometry_alloc *Geometry)
+{
+    if (Geometry->Buffer != VK_NULL_HANDLE)
+    {
+        geometry_heap_release(Geometry);
+    }
+    else
+    {
+        Core->VkCore.DestroyVmaBuffer(Buffer->Handle, Buffer->Memory);
+    }
     
-    Core->VkCore.CreateVmaBufferWithStaging(VertexBufferInfo,
-                                            VertexAllocInfo,
-                                            Core->Renderer->CommandPool,
-                                            Result->VertexBuffer.Handle,
-                                            Result->VertexBuffer.Memory,
-                                            RenderInfo->VertexData,
-                                            VertexBufferInfo.size);
+    *Buffer = {};
+}
+
+CREATE_RENDER_COMPONENT(create_render_component)
+{
+    mp_render_component *Result;
+    *RenderComponent = resource_pool_alloc(&Resources->RenderComponents, &Result);
+    if (!Result) return;
+    
+    u32 VertexSize = RenderInfo->VertexCount * RenderInfo->VertexStride;
+    Result->VertexGeometry = geometry_heap_alloc(Geometry_Vertex, RenderInfo->VertexData,
+                                                 VertexSize, RenderInfo->VertexStride);
+    if (Result->VertexGeometry.Buffer != VK_NULL_HANDLE)
+    {
+        Result->VertexBuffer.Handle = Result->VertexGeometry.Buffer;
+        Result->VertexOffset        = Result->VertexGeometry.Offset / RenderInfo->VertexStride;
+    }
+    else
+    {
+        // Empty geometry, or the heap is full
+        VkBufferCreateInfo VertexBufferInfo = {};
+        VertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        VertexBufferInfo.size  = VertexSize;
+        VertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        
+        VmaAllocationCreateInfo VertexAllocInfo = {};
+        VertexAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        
+        Core->VkCore.CreateVmaBufferWithStaging(VertexBufferInfo,
+                                                VertexAllocInfo,
+                                                Core->Renderer->CommandPool,
+                                                Result->VertexBuffer.Handle,
+                                                Result->VertexBuffer.Memory,
+                                                RenderInfo->VertexData,
+                                                VertexBufferInfo.size);
+    }
     
-    Result->VertexBuffer.Size = VertexBufferInfo.size;
+    Result->VertexBuffer.Size = VertexSize;
     
     if (RenderInfo->HasIndices)
     {
@@ -868,23 +2396,34 @@ CREATE_RENDER_COMPONENT(create_render_component)
             Result->IndexType = VK_INDEX_TYPE_UINT32;
         }
         
-        VkBufferCreateInfo IndexBufferInfo = {};
-        IndexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        IndexBufferInfo.size  = RenderInfo->IndexCount * RenderInfo->IndexStride;
-        IndexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-        
-        VmaAllocationCreateInfo IndexAllocInfo = {};
-        IndexAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-        
-        Core->VkCore.CreateVmaBufferWithStaging(IndexBufferInfo,
-                                                IndexAllocInfo,
-                                                Core->Renderer->CommandPool,
-                                                Result->IndexBuffer.Handle,
-                                                Result->IndexBuffer.Memory,
-                                                RenderInfo->IndexData,
-                                                IndexBufferInfo.size);
+        u32 IndexSize = RenderInfo->IndexCount * RenderInfo->IndexStride;
+        Result->IndexGeometry = geometry_heap_alloc(Geometry_Index, RenderInfo->IndexData,
+                                                   IndexSize, GEOMETRY_HEAP_INDEX_ALIGNMENT);
+        if (Result->IndexGeometry.Buffer != VK_NULL_HANDLE)
+        {
+            Result->IndexBuffer.Handle = Result->IndexGeometry.Buffer;
+            Result->FirstIndex         = Result->IndexGeometry.Offset / mp_index_size(Result->IndexType);
+        }
+        else
+        {
+            VkBufferCreateInfo IndexBufferInfo = {};
+            IndexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+            IndexBufferInfo.size  = IndexSize;
+            IndexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            
+            VmaAllocationCreateInfo IndexAllocInfo = {};
+            IndexAllocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+            
+            Core->VkCore.CreateVmaBufferWithStaging(IndexBufferInfo,
+                                                    IndexAllocInfo,
+                                                    Core->Renderer->CommandPool,
+                                                    Result->IndexBuffer.Handle,
+                                                    Result->IndexBuffer.Memory,
+                                                    RenderInfo->IndexData,
+                                                    IndexBufferInfo.size);
+        }
         
-        Result->IndexBuffer.Size = IndexBufferInfo.size;
+        Result->IndexBuffer.Size = IndexSize;
         Result->DrawCount = RenderInfo->IndexCount;
     }
     else
@@ -892,33 +2431,42 @@ CREATE_RENDER_COMPONENT(create_render_component)
         Result->IsIndexed = false;
         Result->DrawCount = RenderInfo->VertexCount;
     }
-    
-    
-    *RenderComponent = Result;
 }
 
 FREE_RENDER_COMPONENT(free_render_component)
 {
-    Core->VkCore.DestroyVmaBuffer((*RenderComponent)->VertexBuffer.Handle,
-                                  (*RenderComponent)->VertexBuffer.Memory);
-    
-    Core->VkCore.DestroyVmaBuffer((*RenderComponent)->IndexBuffer.Handle,
-                                  (*RenderComponent)->IndexBuffer.Memory);
+    mp_render_component *Component = resource_pool_get(&Resources->RenderComponents, *RenderComponent);
+    if (Component)
+    {
+        mp_render_component_release_buffer(&Component->VertexBuffer, &Component->VertexGeometry);
+        mp_render_component_release_buffer(&Component->IndexBuffer, &Component->IndexGeometry);
+        
+        resource_pool_release(&Resources->RenderComponents, *RenderComponent);
+        Resources->Version++;
+    }
     
-    memory_release(Core->Memory, *RenderComponent);
-    *RenderComponent = NULL;
+    *RenderComponent = 0;
 }
 
 SET_RENDER_COMPONENT_INFO(set_render_component_info)
 {
-    RenderComponent->IsIndexed = IsIndexed;
-    RenderComponent->IndexType = IndexType;
-    RenderComponent->DrawCount = DrawCount;
+    mp_render_component *Component = resource_pool_get(&Resources->RenderComponents, RenderComponent);
+    if (!Component) return;
+    
+    Component->IsIndexed = IsIndexed;
+    Component->IndexType = IndexType;
+    Component->DrawCount = DrawCount;
+    
+    // Index ranges are 4 byte aligned, so they start on an index of either size
+    Component->FirstIndex = Component->IndexGeometry.Offset / mp_index_size(IndexType);
+    Resources->Version++;
 }
 
 CREATE_UPLOAD_BUFFER(create_upload_buffer)
 {
-    upload_buffer Result = (upload_buffer)memory_alloc(Core->Memory, sizeof(mp_upload_buffer));
+    mp_upload_buffer *Result;
+    *Buffer = resource_pool_alloc(&Resources->UploadBuffers, &Result);
+    if (!Result) return;
     
     Result->Type = BufferType;
     Result->Size = BufferSize;
@@ -938,13 +2486,14 @@ CREATE_UPLOAD_BUFFER(create_upload_buffer)
                                  Result->Handle,
                                  Result->Allocation,
                                  Result->AllocationInfo);
-    
-    *Buffer = Result;
 }
 
 RESIZE_UPLOAD_BUFFER(resize_upload_buffer)
 {
-    if (NewSize > Buffer->Size)
+    mp_upload_buffer *UploadBuffer = resource_pool_get(&Resources->UploadBuffers, Buffer);
+    if (!UploadBuffer) return;
+    
+    if (NewSize > UploadBuffer->Size)
     {
         VkBuffer           Handle;
         VmaAllocation      Allocation;
@@ -966,29 +2515,33 @@ RESIZE_UPLOAD_BUFFER(resize_upload_buffer)
                                      AllocationInfo);
         
         char *New = (char*)AllocationInfo.pMappedData;
-        char *Old = (char*)Buffer->AllocationInfo.pMappedData;
-        //memcpy(New, Old, Buffer->Size);
+        char *Old = (char*)UploadBuffer->AllocationInfo.pMappedData;
+        //memcpy(New, Old, UploadBuffer->Size);
         
         Core->VkCore.Idle();
-        Core->VkCore.DestroyVmaBuffer(Buffer->Handle, Buffer->Allocation);
+        Core->VkCore.DestroyVmaBuffer(UploadBuffer->Handle, UploadBuffer->Allocation);
         
-        Buffer->Handle         = Handle;
-        Buffer->Allocation     = Allocation;
-        Buffer->AllocationInfo = AllocationInfo;
-        Buffer->Size           = NewSize;
+        UploadBuffer->Handle         = Handle;
+        UploadBuffer->Allocation     = Allocation;
+        UploadBuffer->AllocationInfo = AllocationInfo;
+        UploadBuffer->Size           = NewSize;
     }
 }
 
 COPY_UPLOAD_BUFFER(copy_upload_buffer)
 {
+    mp_upload_buffer    *Upload    = resource_pool_get(&Resources->UploadBuffers, UploadBuffer);
+    mp_render_component *Component = resource_pool_get(&Resources->RenderComponents, RenderComponent);
+    if (!Upload || !Component) return;
+    
     // Make sure the last frame is done rendering
     // TODO(Dustin): Find a better way to do this so you don't have to vk::idle
     Core->VkCore.Idle();
     
-    if (UploadBuffer->Type == UploadBuffer_Vertex)
+    if (Upload->Type == UploadBuffer_Vertex)
     {
         // First make sure the vertex buffer is large enough
-        if (RenderComponent->VertexBuffer.Size < UploadBuffer->Size)
+        if (Component->VertexBuffer.Size < Upload->Size)
         {
             VkBuffer NewVertexBuffer;
             VmaAllocation NewVmaAllocation;
@@ -996,7 +2549,7 @@ COPY_UPLOAD_BUFFER(copy_upload_buffer)
             
             VkBufferCreateInfo VertexBufferInfo = {};
             VertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            VertexBufferInfo.size  = UploadBuffer->Size;
+            VertexBufferInfo.size  = Upload->Size;
             VertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
             
             VmaAllocationCreateInfo VertexAllocInfo = {};
@@ -1009,31 +2562,33 @@ COPY_UPLOAD_BUFFER(copy_upload_buffer)
                                          NewVmaAllocationInfo);
             
             Core->VkCore.CopyBuffer(Core->Renderer->CommandPool, 
-                                    UploadBuffer->Handle,
+                                    Upload->Handle,
                                     NewVertexBuffer,
-                                    UploadBuffer->Size);
+                                    Upload->Size);
             
             
-            Core->VkCore.DestroyVmaBuffer(RenderComponent->VertexBuffer.Handle, 
-                                          RenderComponent->VertexBuffer.Memory);
+            mp_render_component_release_buffer(&Component->VertexBuffer, &Component->VertexGeometry);
             
-            RenderComponent->VertexBuffer.Handle = NewVertexBuffer;
-            RenderComponent->VertexBuffer.Memory = NewVmaAllocation;
-            RenderComponent->VertexBuffer.Size   = UploadBuffer->Size;
-            RenderComponent->VertexBuffer.AllocationInfo = NewVmaAllocationInfo;
+            Component->VertexBuffer.Handle = NewVertexBuffer;
+            Component->VertexBuffer.Memory = NewVmaAllocation;
+            Component->VertexBuffer.Size   = Upload->Size;
+            Component->VertexBuffer.AllocationInfo = NewVmaAllocationInfo;
+            Component->VertexOffset = 0;
+            Resources->Version++;
         }
         else
         {
             Core->VkCore.CopyBuffer(Core->Renderer->CommandPool, 
-                                    UploadBuffer->Handle,
-                                    RenderComponent->VertexBuffer.Handle,
-                                    UploadBuffer->Size);
+                                    Upload->Handle,
+                                    Component->VertexBuffer.Handle,
+                                    Upload->Size,
+                                    Component->VertexGeometry.Offset);
         }
     }
-    else if (UploadBuffer->Type == UploadBuffer_Index)
+    else if (Upload->Type == UploadBuffer_Index)
     {
         // First make sure the index buffer is large enough
-        if (RenderComponent->IndexBuffer.Size < UploadBuffer->Size)
+        if (Component->IndexBuffer.Size < Upload->Size)
         {
             VkBuffer NewIndexBuffer;
             VmaAllocation NewVmaAllocation;
@@ -1041,7 +2596,7 @@ COPY_UPLOAD_BUFFER(copy_upload_buffer)
             
             VkBufferCreateInfo IndexBufferInfo = {};
             IndexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-            IndexBufferInfo.size  = UploadBuffer->Size;
+            IndexBufferInfo.size  = Upload->Size;
             IndexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
             
             VmaAllocationCreateInfo IndexAllocInfo = {};
@@ -1053,53 +2608,70 @@ COPY_UPLOAD_BUFFER(copy_upload_buffer)
                                          NewVmaAllocation,
                                          NewVmaAllocationInfo);
             
-            Core->VkCore.DestroyVmaBuffer(RenderComponent->IndexBuffer.Handle, 
-                                          RenderComponent->IndexBuffer.Memory);
+            mp_render_component_release_buffer(&Component->IndexBuffer, &Component->IndexGeometry);
             
-            RenderComponent->IndexBuffer.Handle = NewIndexBuffer;
-            RenderComponent->IndexBuffer.Memory = NewVmaAllocation;
-            RenderComponent->IndexBuffer.Size   = UploadBuffer->Size;
-            RenderComponent->IndexBuffer.AllocationInfo = NewVmaAllocationInfo;
+            Component->IndexBuffer.Handle = NewIndexBuffer;
+            Component->IndexBuffer.Memory = NewVmaAllocation;
+            Component->IndexBuffer.Size   = Upload->Size;
+            Component->IndexBuffer.AllocationInfo = NewVmaAllocationInfo;
+            Component->FirstIndex = 0;
+            Resources->Version++;
             
             Core->VkCore.CopyBuffer(Core->Renderer->CommandPool, 
-                                    UploadBuffer->Handle,
-                                    RenderComponent->IndexBuffer.Handle,
-                                    UploadBuffer->Size);
+                                    Upload->Handle,
+                                    Component->IndexBuffer.Handle,
+                                    Upload->Size);
             
         }
         else
         {
             Core->VkCore.CopyBuffer(Core->Renderer->CommandPool, 
-                                    UploadBuffer->Handle,
-                                    RenderComponent->IndexBuffer.Handle,
-                                    UploadBuffer->Size);
+                                    Upload->Handle,
+                                    Component->IndexBuffer.Handle,
+                                    Upload->Size,
+                                    Component->IndexGeometry.Offset);
         }
     }
 }
 
 FREE_UPLOAD_BUFFER(free_upload_buffer)
 {
-    Core->VkCore.DestroyVmaBuffer((*Buffer)->Handle, 
-                                  (*Buffer)->Allocation);
+    mp_upload_buffer *Upload = resource_pool_get(&Resources->UploadBuffers, *Buffer);
+    if (Upload)
+    {
+        Core->VkCore.DestroyVmaBuffer(Upload->Handle, 
+                                      Upload->Allocation);
+        
+        resource_pool_release(&Resources->UploadBuffers, *Buffer);
+    }
     
-    memory_release(Core->Memory, *Buffer);
-    *Buffer = NULL;
+    *Buffer = 0;
 }
 
 UPDATE_UPLOAD_BUFFER(update_upload_buffer)
 {
+    mp_upload_buffer *Upload = resource_pool_get(&Resources->UploadBuffers, UploadBuffer);
+    if (!Upload) return;
+    
     // Resize the buffer
-    if (Offset + Size > UploadBuffer->Size)
+    if (Offset + Size > Upload->Size)
     {
-        resize_upload_buffer(UploadBuffer, (UploadBuffer->Size > 0) ? UploadBuffer->Size * 2 : Size);
+        resize_upload_buffer(UploadBuffer, (Upload->Size > 0) ? Upload->Size * 2 : Size);
     }
     
-    memcpy((char*)UploadBuffer->AllocationInfo.pMappedData + Offset, Data, Size);
+    memcpy((char*)Upload->AllocationInfo.pMappedData + Offset, Data, Size);
 }
 
 MAP_UPLOAD_BUFFER(map_upload_buffer)
 {
-    *Ptr = (char*)UploadBuffer->AllocationInfo.pMappedData + Offset;
+    mp_upload_buffer *Upload = resource_pool_get(&Resources->UploadBuffers, UploadBuffer);
+    if (!Upload)
+    {
+        *Ptr = NULL;
+        return;
+    }
+    
+    *Ptr = (char*)Upload->AllocationInfo.pMappedData + Offset;
 }
 
 UNMAP_UPLOAD_BUFFER(unmap_upload_buffer)
@@ -1111,8 +2683,12 @@ GET_UPLOAD_BUFFER_INFO(get_upload_buffer_info)
 {
     upload_buffer_info Result = {};
     
-    Result.Size = UploadBuffer->Size;
-    Result.Type = UploadBuffer->Type;
+    mp_upload_buffer *Upload = resource_pool_get(&Resources->UploadBuffers, UploadBuffer);
+    if (Upload)
+    {
+        Result.Size = Upload->Size;
+        Result.Type = Upload->Type;
+    }
     
     return Result;
 }
@@ -1120,7 +2696,9 @@ GET_UPLOAD_BUFFER_INFO(get_upload_buffer_info)
 
 CREATE_IMAGE(create_image)
 {
-    image Result = (image)memory_alloc(Core->Memory, sizeof(mp_image));
+    mp_image *Result;
+    *Image = resource_pool_alloc(&Resources->Images, &Result);
+    if (!Result) return;
     
     VkImageCreateInfo imageInfo = {};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -1196,15 +2774,16 @@ CREATE_IMAGE(create_image)
     
     Result->Format = ImageInfo->ImageFormat;
     Result->MipLevels = ImageInfo->MipLevels;
-    
-    *Image = Result;
 }
 
 RESIZE_IMAGE(resize_image)
 {
+    mp_image *pImage = resource_pool_get(&Resources->Images, Image);
+    if (!pImage) return;
+    
     Core->VkCore.Idle();
     
-    Core->VkCore.DestroyVmaImage(Image->Handle, Image->Memory);
+    Core->VkCore.DestroyVmaImage(pImage->Handle, pImage->Memory);
     
     VkImageCreateInfo imageInfo = {};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -1212,9 +2791,9 @@ RESIZE_IMAGE(resize_image)
     imageInfo.extent.width  = Width;
     imageInfo.extent.height = Height;
     imageInfo.extent.depth  = 1;
-    imageInfo.mipLevels     = Image->MipLevels;
+    imageInfo.mipLevels     = pImage->MipLevels;
     imageInfo.arrayLayers   = 1;
-    imageInfo.format        = Image->Format;
+    imageInfo.format        = pImage->Format;
     imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.usage         = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
@@ -1227,126 +2806,158 @@ RESIZE_IMAGE(resize_image)
     alloc_info.usage = VMA_MEMORY_USAGE_GPU_ONLY;
     
     Core->VkCore.CreateVmaImage(imageInfo, alloc_info,
-                                Image->Handle,
-                                Image->Memory,
-                                Image->AllocationInfo);
+                                pImage->Handle,
+                                pImage->Memory,
+                                pImage->AllocationInfo);
     
     Core->VkCore.TransitionImageLayout(Core->Renderer->CommandPool,
-                                       Image->Handle,
-                                       Image->Format,
+                                       pImage->Handle,
+                                       pImage->Format,
                                        VK_IMAGE_LAYOUT_UNDEFINED,
                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                       Image->MipLevels);
+                                       pImage->MipLevels);
     
     
-    Core->VkCore.DestroyImageView(Image->View);
+    Core->VkCore.DestroyImageView(pImage->View);
     
     // Create the Image View
     VkImageViewCreateInfo viewInfo = {};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    viewInfo.image                           = Image->Handle;
+    viewInfo.image                           = pImage->Handle;
     viewInfo.viewType                        = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format                          = Image->Format;
+    viewInfo.format                          = pImage->Format;
     viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel   = 0;
-    viewInfo.subresourceRange.levelCount     = Image->MipLevels;
+    viewInfo.subresourceRange.levelCount     = pImage->MipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount     = 1;
     
-    Image->View = Core->VkCore.CreateImageView(viewInfo);
-    
+    pImage->View = Core->VkCore.CreateImageView(viewInfo);
+    Resources->Version++;
 }
 
 FREE_IMAGE(free_image)
 {
-    Core->VkCore.DestroyImageSampler((*Image)->Sampler);
-    Core->VkCore.DestroyImageView((*Image)->View);
-    Core->VkCore.DestroyVmaImage((*Image)->Handle, (*Image)->Memory);
+    mp_image *pImage = resource_pool_get(&Resources->Images, *Image);
+    if (pImage)
+    {
+        Core->VkCore.DestroyImageSampler(pImage->Sampler);
+        Core->VkCore.DestroyImageView(pImage->View);
+        Core->VkCore.DestroyVmaImage(pImage->Handle, pImage->Memory);
+        
+        resource_pool_release(&Resources->Images, *Image);
+        Resources->Version++;
+    }
     
-    memory_release(Core->Memory, (*Image));
-    (*Image) = NULL;
+    (*Image) = 0;
 }
 
 COPY_BUFFER_TO_IMAGE(copy_buffer_to_image)
 {
+    mp_image         *pImage = resource_pool_get(&Resources->Images, Image);
+    mp_upload_buffer *Upload = resource_pool_get(&Resources->UploadBuffers, UploadBuffer);
+    if (!pImage || !Upload) return;
+    
     // TODO(Dustin): Find an alternative to idling.
     Core->VkCore.Idle();
     
     // Transition the image to TransferDestinationOptimal 
-    if (Image->CurrentLayout == ImageLayout_Undefined)
+    if (pImage->CurrentLayout == ImageLayout_Undefined)
     {
         Core->VkCore.TransitionImageLayout(Core->Renderer->CommandPool,
-                                           Image->Handle,
-                                           Image->Format,
+                                           pImage->Handle,
+                                           pImage->Format,
                                            VK_IMAGE_LAYOUT_UNDEFINED,
                                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                           Image->MipLevels);
+                                           pImage->MipLevels);
     }
-    else if (Image->CurrentLayout == ImageLayout_TransferDst)
+    else if (pImage->CurrentLayout == ImageLayout_TransferDst)
     {
         // Don't have to do anything. Ready to recieve the data
     }
-    else if (Image->CurrentLayout == ImageLayout_ShaderReadOnly)
+    else if (pImage->CurrentLayout == ImageLayout_ShaderReadOnly)
     {
         Core->VkCore.TransitionImageLayout(Core->Renderer->CommandPool,
-                                           Image->Handle,
-                                           Image->Format,
+                                           pImage->Handle,
+                                           pImage->Format,
                                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                           Image->MipLevels);
+                                           pImage->MipLevels);
     }
     
     // Copy the buffer into the image
     Core->VkCore.CopyBufferToImage(Core->Renderer->CommandPool,
-                                   UploadBuffer->Handle,
-                                   Image->Handle,
-                                   Image->Width, Image->Height);
+                                   Upload->Handle,
+                                   pImage->Handle,
+                                   pImage->Width, pImage->Height);
     
     // Transition the image to ShaderReadOnlyOptimal
     Core->VkCore.TransitionImageLayout(Core->Renderer->CommandPool,
-                                       Image->Handle,
-                                       Image->Format,
+                                       pImage->Handle,
+                                       pImage->Format,
                                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                                       Image->MipLevels);
+                                       pImage->MipLevels);
     
-    Image->CurrentLayout = ImageLayout_ShaderReadOnly;
+    pImage->CurrentLayout = ImageLayout_ShaderReadOnly;
 }
 
 GET_IMAGE_DIMENSIONS(get_image_dimensions)
 {
-    *Width  = Image->Width;
-    *Height = Image->Height;
+    mp_image *pImage = resource_pool_get(&Resources->Images, Image);
+    if (!pImage)
+    {
+        *Width  = 0;
+        *Height = 0;
+        return;
+    }
+    
+    *Width  = pImage->Width;
+    *Height = pImage->Height;
 }
 
 CREATE_DESCRIPTOR_SET_LAYOUT(create_descriptor_set_layout)
 {
-    descriptor_layout Result = (descriptor_layout)memory_alloc(Core->Memory, sizeof(mp_descriptor_layout));
+    mp_descriptor_layout *Result;
+    *Layout = resource_pool_alloc(&Resources->DescriptorLayouts, &Result);
+    if (!Result) return;
     
     Result->Handle = Core->VkCore.CreateDescriptorSetLayout(LayoutInfo->Bindings, 
                                                             LayoutInfo->BindingsCount);
-    
-    *Layout = Result;
 }
 
 FREE_DESCRIPTOR_SET_LAYOUT(free_descriptor_set_layout)
 {
-    Core->VkCore.DestroyDescriptorSetLayout((*Layout)->Handle);
-    memory_release(Core->Memory, (*Layout));
-    (*Layout) = NULL;
+    mp_descriptor_layout *pLayout = resource_pool_get(&Resources->DescriptorLayouts, *Layout);
+    if (pLayout)
+    {
+        Core->VkCore.DestroyDescriptorSetLayout(pLayout->Handle);
+        resource_pool_release(&Resources->DescriptorLayouts, *Layout);
+    }
+    
+    (*Layout) = 0;
 }
 
 CREATE_DESCRIPTOR_SET(create_descriptor_set) 
 {
-    descriptor_set Result = (descriptor_set)memory_alloc(Core->Memory, sizeof(mp_descriptor_set));
+    mp_descriptor_layout *Layout = resource_pool_get(&Resources->DescriptorLayouts, SetInfo->Layout);
+    if (!Layout)
+    {
+        Platform->mprinte("Attempting to create a descriptor set with an invalid layout (%#x)!\n", SetInfo->Layout);
+        *Set = 0;
+        return;
+    }
+    
+    mp_descriptor_set *Result;
+    *Set = resource_pool_alloc(&Resources->DescriptorSets, &Result);
+    if (!Result) return;
     
     u32 SwapChainImageCount = Core->VkCore.GetSwapChainImageCount();
     Result->HandleCount = SwapChainImageCount;
     
-    VkDescriptorSetLayout *Layouts = (VkDescriptorSetLayout*)memory_alloc(Core->Memory, 
-                                                                          sizeof(VkDescriptorSetLayout) * SwapChainImageCount);
+    VkDescriptorSetLayout *Layouts = talloc<VkDescriptorSetLayout>(SwapChainImageCount);
     for (u32 LayoutIdx = 0; LayoutIdx < SwapChainImageCount; ++LayoutIdx)
-        Layouts[LayoutIdx] = SetInfo->Layout->Handle;
+        Layouts[LayoutIdx] = Layout->Handle;
     
     VkDescriptorSetAllocateInfo AllocInfo = {};
     AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -1360,24 +2971,30 @@ CREATE_DESCRIPTOR_SET(create_descriptor_set)
     Core->VkCore.CreateDescriptorSets(Result->Handles,
                                       AllocInfo);
     
-    memory_release(Core->Memory, Layouts);
-    
     Result->Binding = SetInfo->Binding;
     Result->Set     = SetInfo->Set;
-    
-    *Set = Result;
 }
 
 FREE_DESCRIPTOR_SET(free_descriptor_set) 
 {
-    memory_release(Core->Memory, (*Set)->Handles);
-    memory_release(Core->Memory, (*Set));
-    (*Set) = NULL;
+    mp_descriptor_set *pSet = resource_pool_get(&Resources->DescriptorSets, *Set);
+    if (pSet)
+    {
+        memory_release(Core->Memory, pSet->Handles);
+        resource_pool_release(&Resources->DescriptorSets, *Set);
+        Resources->Version++;
+    }
+    
+    (*Set) = 0;
 }
 
 BIND_BUFFER_TO_DESCRIPTOR_SET(bind_buffer_to_descriptor_set)
 {
-    for (u32 i = 0; i < Set->HandleCount; ++i) 
+    mp_descriptor_set *pSet   = resource_pool_get(&Resources->DescriptorSets, Set);
+    mp_image          *pImage = resource_pool_get(&Resources->Images, WriteInfo->Image);
+    if (!pSet || !pImage) return;
+    
+    for (u32 i = 0; i < pSet->HandleCount; ++i) 
     {
         VkWriteDescriptorSet DescriptorWrites[1] = {};
         
@@ -1389,13 +3006,13 @@ BIND_BUFFER_TO_DESCRIPTOR_SET(bind_buffer_to_descriptor_set)
 #else
         VkDescriptorImageInfo ImageInfo = {};
         ImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        ImageInfo.imageView   = WriteInfo->Image->View;
-        ImageInfo.sampler     = WriteInfo->Image->Sampler;
+        ImageInfo.imageView   = pImage->View;
+        ImageInfo.sampler     = pImage->Sampler;
 #endif
         
         DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        DescriptorWrites[0].dstSet           = Set->Handles[i];
-        DescriptorWrites[0].dstBinding       = Set->Binding;
+        DescriptorWrites[0].dstSet           = pSet->Handles[i];
+        DescriptorWrites[0].dstBinding       = pSet->Binding;
         DescriptorWrites[0].dstArrayElement  = 0;
         DescriptorWrites[0].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         DescriptorWrites[0].descriptorCount  = 1;
@@ -1405,51 +3022,71 @@ BIND_BUFFER_TO_DESCRIPTOR_SET(bind_buffer_to_descriptor_set)
         
         Core->VkCore.UpdateDescriptorSets(DescriptorWrites, 1);
     }
+    
+    // Updating a set invalidates the command buffers it is bound in
+    Resources->Version++;
 }
 
 //~ Command List commands
 
 CMD_BIND_PIPELINE(cmd_bind_pipeline)
 {
-    cmd_bind_pipeline_info Info = {0};
-    Info.Pipeline = Pipeline;
+    cmd_bind_pipeline_packet Packet = {0};
+    Packet.Pipeline = Pipeline;
     
-    mp_command_list_add(CommandList, CmdType_BindPipeline, sizeof(cmd_bind_pipeline_info), &Pipeline);
+    mp_command_list_encode(CommandList, Packet);
 }
 
 CMD_DRAW(cmd_draw)
 {
-    mp_command_list_add(CommandList, CmdType_Draw, sizeof(mp_render_component), RenderComponent);
+    cmd_draw_packet Packet = {0};
+    Packet.RenderComponent = RenderComponent;
+    
+    mp_command_list_encode(CommandList, Packet);
 }
 
 CMD_SET_OBJECT_WORLD_DATA(cmd_set_object_world_data)
 {
-    cmd_set_object_world_data_info Data = {0};
-    Data.Position = Position;
-    Data.Scale    = Scale;
-    Data.Rotation = Rotation;
+    cmd_object_data_packet Packet = {0};
+    Packet.Position = Position;
+    Packet.Scale    = Scale;
+    Packet.Rotation = Rotation;
     
-    mp_command_list_add(CommandList, CmdType_UpdateObjectData, 
-                        sizeof(cmd_set_object_world_data_info), 
-                        &Data);
+    mp_command_list_encode(CommandList, Packet);
 }
 
 CMD_SET_CAMERA(cmd_set_camera)
 {
-    camera_data Data = {0};
-    Data.Projection = Projection;
-    Data.View = View;
+    cmd_set_camera_packet Packet = {0};
+    Packet.Camera.Projection = Projection;
+    Packet.Camera.View       = View;
+    
+    CommandList->Camera = Packet.Camera;
+    mp_command_list_encode(CommandList, Packet);
+}
+
+CMD_SET_SORT_PASS(cmd_set_sort_pass)
+{
+    cmd_set_sort_pass_packet Packet = {0};
+    Packet.Pass = Pass;
+    
+    mp_command_list_encode(CommandList, Packet);
+}
+
+CMD_PUSH_OBJECT_DATA(cmd_push_object_data)
+{
+    cmd_push_object_data_packet Packet = {0};
+    Packet.Matrix = Matrix;
     
-    mp_command_list_add(CommandList, CmdType_SetCamera, 
-                        sizeof(camera_data), 
-                        &Data);
+    mp_command_list_encode(CommandList, Packet);
 }
 
 CMD_BIND_DESCRIPTOR_SET(cmd_bind_descriptor_set)
 {
-    mp_command_list_add(CommandList, CmdType_BindDescriptor, 
-                        sizeof(mp_descriptor_set), 
-                        Set);
+    cmd_bind_descriptor_packet Packet = {0};
+    Packet.Set = Set;
+    
+    mp_command_list_encode(CommandList, Packet);
 }
 
 SET_RENDER_MODE(set_render_mode)
@@ -1477,4 +3114,6 @@ GET_RENDER_MODE(get_render_mode)
     return Core->Renderer->RenderMode;
 }
 
+#undef mp_profile_end
+#undef mp_profile_start
 #undef EXTERN_GRAPHICS_API
\ No newline at end of file
@@ -42,7 +42,12 @@ extern "C"
     // used by C++ source code
 #endif
     
-#if defined(GRAPHICS_DLL_EXPORT)
+#if !defined(_WIN32)
+    
+#define GRAPHICS_API __attribute__((visibility("default")))
+#define GRAPHICS_CALL
+    
+#elif defined(GRAPHICS_DLL_EXPORT)
     
 #define GRAPHICS_API __declspec(dllexport)
 #define GRAPHICS_CALL __cdecl
@@ -59,19 +64,21 @@ extern "C"
     typedef struct mp_command_pool*           command_pool;
     typedef struct mp_command_list*           command_list;
     
-    typedef struct mp_pipeline*               pipeline;
+    // Gpu resources are referred to by 32 bit handles. 0 is never a valid handle,
+    // and handles of resources that have been freed are detected and ignored.
+    typedef u32                               pipeline;
     
-    typedef struct mp_render_component*       render_component;  
-    typedef struct mp_upload_buffer*          upload_buffer;
-    typedef struct mp_image*                  image;
+    typedef u32                               render_component;  
+    typedef u32                               upload_buffer;
+    typedef u32                               image;
     
     typedef struct mp_uniform_buffer*         uniform_buffer;
     // TODO(Dustin): Expose in the future
     typedef struct mp_dynamic_uniform_buffer* dynamic_uniform_buffer;
     
     typedef struct mp_descriptor_pool*         descriptor_pool;
-    typedef struct mp_descriptor_layout*       descriptor_layout;
-    typedef struct mp_descriptor_set*          descriptor_set;
+    typedef u32                                descriptor_layout;
+    typedef u32                                descriptor_set;
     
     //~ Create Info Structs
     
@@ -105,6 +112,16 @@ extern "C"
         command_list *CommandList;
         command_pool  CommandPool;
         
+        // Sort the draws by pass, pipeline, descriptor set, mesh and depth before
+        // translating them, instead of translating in recording order
+        bool          IsSorted;
+        
+        // For lists that are recorded the same way every frame. When handed to
+        // end_frame, the list keeps the command buffer it was translated into and
+        // replays it for as long as the commands, the resources and the render mode
+        // stay the same. Lists that set the camera are translated every frame.
+        bool          IsStatic;
+        
     } command_list_create_info;
     
     typedef struct begin_frame_cmd
@@ -147,6 +164,24 @@ extern "C"
         // Depth/Stencil
         bool HasDepthStencil;
         
+        // Instanced pipelines read their model matrices from a storage buffer at
+        // set 1 instead of the object data uniform, see simple_tri_instanced.vert.
+        // Consecutive draws of the same render component are merged into a single
+        // instanced draw.
+        bool HasInstancing;
+        
+        // Draws are written as VkDrawIndexedIndirectCommands to the transient ring
+        // and emitted with a single vkCmdDrawIndexedIndirect per run of draws that
+        // share their vertex and index buffers (vkCmdDrawIndexedIndirectCount when
+        // VK_KHR_draw_indirect_count is available). Implies HasInstancing, the models
+        // are read from the same instance buffer.
+        bool HasIndirectDraws;
+        
+        // Object data is sent as a push constant (a mat4 at offset 0, vertex stage)
+        // instead of a dynamic uniform, see simple_tri_push.vert. Push constant
+        // ranges in PushConstants have to start after it.
+        bool HasPushObjectData;
+        
         // LayoutCreateInfo
         VkPushConstantRange   *PushConstants;
         u32                    PushConstantsCount;
@@ -220,6 +255,59 @@ extern "C"
         u32               Binding;
     } descriptor_set_create_info;
     
+    // Commands recorded into a command list
+    typedef enum cmd_type
+    {
+        CmdType_BeginFrame,
+        CmdType_EndFrame,
+        
+        CmdType_BindPipeline,
+        CmdType_BindDescriptor,
+        CmdType_Draw,
+        
+        CmdType_SetCamera,
+        CmdType_UpdateObjectData,
+        CmdType_SetSortPass,
+        CmdType_PushObjectData,
+        
+        CmdType_Count,
+        CmdType_Invalid,
+    } cmd_type;
+    
+    // Cost of one command type during a frame. The counts are always kept, the
+    // times are only measured when the graphics module is built with RENDER_PROFILE.
+    typedef struct render_command_stats
+    {
+        u32 Recorded;
+        u32 Translated;  // sorted lists drop redundant commands
+        u64 RecordNs;
+        u64 TranslateNs;
+    } render_command_stats;
+    
+    // Binds made while translating command lists during one frame. Elided binds
+    // were dropped because the same state was already bound.
+    typedef struct render_stats
+    {
+        u32 PipelineBinds;
+        u32 PipelineBindsElided;
+        u32 DescriptorSetBinds;
+        u32 DescriptorSetBindsElided;
+        u32 VertexBufferBinds;
+        u32 VertexBufferBindsElided;
+        u32 IndexBufferBinds;
+        u32 IndexBufferBindsElided;
+        u32 Draws;                // draws of replayed static lists are not counted
+        u32 Instances;            // objects drawn, above Draws when draws were instanced
+        u32 IndirectDraws;        // draw commands read from indirect buffers, counted once per call in Draws
+        u32 StaticListsRecorded;
+        u32 StaticListsReplayed;
+        
+        // Time spent translating command lists, summed over the render workers.
+        // Divide by Draws for the cost of a draw.
+        u64 TranslateNs;
+        render_command_stats Commands[CmdType_Count];
+    } render_stats;
+    
     typedef struct descriptor_write_info
     {
         // Buffer information
@@ -249,6 +337,10 @@ extern "C"
 #define END_FRAME(fn) EXTERN_GRAPHICS_API void fn(end_frame_cmd *EndFrameInfo)
     typedef void (GRAPHICS_CALL *PFN_end_frame)(end_frame_cmd *EndFrameInfo);
     
+    // Stats of the last frame that was ended
+#define GET_RENDER_STATS(fn) EXTERN_GRAPHICS_API void fn(render_stats *Stats)
+    typedef void (GRAPHICS_CALL *PFN_get_render_stats)(render_stats *Stats);
+    
 #define WAIT_FOR_LAST_FRAME(fn) EXTERN_GRAPHICS_API void fn()
     typedef void (GRAPHICS_CALL *PFN_wait_for_last_frame)();
     
@@ -258,6 +350,11 @@ extern "C"
 #define FREE_COMMAND_POOL(fn) EXTERN_GRAPHICS_API void fn(command_pool *CommandPool)
     typedef void (GRAPHICS_CALL *PFN_free_command_pool)(command_pool *CommandPool);
     
+    // Recycles the memory of every command list allocated from the pool, the lists
+    // are empty afterwards. Call once per frame after the lists have been executed.
+#define RESET_COMMAND_POOL(fn) EXTERN_GRAPHICS_API void fn(command_pool CommandPool)
+    typedef void (GRAPHICS_CALL *PFN_reset_command_pool)(command_pool CommandPool);
+    
 #define CREATE_COMMAND_LIST(fn) EXTERN_GRAPHICS_API void fn(command_list_create_info *CreateInfo)
     typedef void (GRAPHICS_CALL *PFN_create_command_list)(command_list_create_info *CreateInfo);
     
@@ -362,6 +459,18 @@ extern "C"
 #define CMD_SET_CAMERA(fn) EXTERN_GRAPHICS_API void fn(command_list CommandList, mat4 Projection, mat4 View)
     typedef void (GRAPHICS_CALL *PFN_cmd_set_camera)(command_list CommandList, mat4 Projection, mat4 View);
     
+    // Draws recorded after this go into Pass (0-15). Passes are drawn in order, only
+    // used by sorted command lists.
+#define CMD_SET_SORT_PASS(fn) EXTERN_GRAPHICS_API void fn(command_list CommandList, u32 Pass)
+    typedef void (GRAPHICS_CALL *PFN_cmd_set_sort_pass)(command_list CommandList, u32 Pass);
+    
+    // Object data for the draws recorded after it, sent as is. Depending on the
+    // shader this is the model matrix or a precomputed model-view-projection.
+    // Pushed as a constant on pipelines created with HasPushObjectData, written
+    // like cmd_set_object_world_data otherwise.
+#define CMD_PUSH_OBJECT_DATA(fn) EXTERN_GRAPHICS_API void fn(command_list CommandList, mat4 Matrix)
+    typedef void (GRAPHICS_CALL *PFN_cmd_push_object_data)(command_list CommandList, mat4 Matrix);
+    
     // TODO(Dustin): Bind Descriptor
     
 #define CMD_BIND_DESCRIPTOR_SET(fn) EXTERN_GRAPHICS_API void fn(command_list CommandList, descriptor_set Set)
@@ -12,6 +12,18 @@ file_global const char *GlobalDeviceExtensions[] = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
 
+// Enabled when the device supports them
+file_global u32 GlobalOptionalDeviceExtensionsCount = 1;
+file_global const char *GlobalOptionalDeviceExtensions[] = {
+    VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME
+};
+
+// The required extensions followed by the supported optional ones, filled in
+// when the logical device is created
+file_global u32 GlobalEnabledDeviceExtensionsCount = 0;
+file_global const char *GlobalEnabledDeviceExtensions[(sizeof(GlobalDeviceExtensions) +
+                                                       sizeof(GlobalOptionalDeviceExtensions)) / sizeof(const char*)];
+
 
 #ifdef NDEBUG
 file_global const bool GlobalEnabledValidationLayers = false;
@@ -293,14 +305,8 @@ bool vulkan_core::Init()
     CreateLogicalDevice();
     
     // Load all Device related functions
-    const char *device_extensions[1];
-    
-    const char *khr_swapchain_name = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
-    
-    device_extensions[0] = khr_swapchain_name;
-    
 #if 1
-    if (!vk::LoadDeviceLevelEntryPoints(Device, device_extensions, 1))
+    if (!vk::LoadDeviceLevelEntryPoints(Device, GlobalEnabledDeviceExtensions, GlobalEnabledDeviceExtensionsCount))
         return false;
 #endif
     
@@ -385,6 +391,8 @@ void vulkan_core::Shutdown()
         vk::vkDestroySemaphore(Device, SyncObjects.ImageAvailable[i], nullptr);
         vk::vkDestroyFence(Device,     SyncObjects.InFlightFences[i], nullptr);
     }
+    pfree(SyncObjects.ImagesInFlight);
+    SyncObjects.ImagesInFlight = NULL;
     
     
     // Free the swapchain
@@ -689,21 +697,59 @@ void vulkan_core::CreateLogicalDevice()
         queueCreateInfos[i++] = queueCreateInfo;
     }
     
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vk::vkGetPhysicalDeviceFeatures(PhysicalDevice, &supportedFeatures);
+    
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.fillModeNonSolid  = VK_TRUE;
     deviceFeatures.geometryShader    = VK_TRUE;
     deviceFeatures.wideLines         = VK_TRUE;
     
+    // Optional, indirect draws fall back to fewer draws per call without them
+    deviceFeatures.multiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    HasMultiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+    HasDrawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     createInfo.pQueueCreateInfos = queueCreateInfos;
     createInfo.queueCreateInfoCount = (u32)uniqueQueueFamilies.size();
     createInfo.pEnabledFeatures = &deviceFeatures;
     
-    // enable the swap chain
-    createInfo.enabledExtensionCount   = GlobalDeviceExtensionsCount;
-    createInfo.ppEnabledExtensionNames = GlobalDeviceExtensions;
+    // enable the swap chain, and the optional extensions the device has
+    GlobalEnabledDeviceExtensionsCount = 0;
+    for (u32 i = 0; i < GlobalDeviceExtensionsCount; ++i)
+        GlobalEnabledDeviceExtensions[GlobalEnabledDeviceExtensionsCount++] = GlobalDeviceExtensions[i];
+    
+    {
+        u32 extensionCount;
+        vk::vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &extensionCount, nullptr);
+        
+        VkExtensionProperties *availableExtensions = palloc<VkExtensionProperties>(extensionCount);
+        vk::vkEnumerateDeviceExtensionProperties(PhysicalDevice, nullptr, &extensionCount, availableExtensions);
+        
+        for (u32 i = 0; i < GlobalOptionalDeviceExtensionsCount; ++i)
+        {
+            for (u32 j = 0; j < extensionCount; ++j)
+            {
+                if (strcmp(GlobalOptionalDeviceExtensions[i], availableExtensions[j].extensionName) == 0)
+                {
+                    GlobalEnabledDeviceExtensions[GlobalEnabledDeviceExtensionsCount++] = GlobalOptionalDeviceExtensions[i];
+                    
+                    if (strcmp(GlobalOptionalDeviceExtensions[i], VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+                        HasDrawIndirectCount = true;
+                    break;
+                }
+            }
+        }
+        
+        pfree(availableExtensions);
+    }
+    
+    createInfo.enabledExtensionCount   = GlobalEnabledDeviceExtensionsCount;
+    createInfo.ppEnabledExtensionNames = GlobalEnabledDeviceExtensions;
     
     // enable validation layers
     if (GlobalEnabledValidationLayers) {
@@ -926,6 +972,10 @@ void vulkan_core::CreateSyncObjects(sync_object_parameters &sync_objects)
         VK_CHECK_RESULT(vk::vkCreateFence(Device, &fenceInfo, nullptr, &sync_objects.InFlightFences[i]),
                         "Failed to create synchronization objects for a frame!");
     }
+    
+    sync_objects.ImagesInFlight = palloc<VkFence>(SwapChain.ImagesCount);
+    for (u32 i = 0; i < SwapChain.ImagesCount; ++i)
+        sync_objects.ImagesInFlight[i] = VK_NULL_HANDLE;
 }
 
 VkImageView vulkan_core::CreateImageView(VkImageViewCreateInfo create_info)
@@ -972,6 +1022,20 @@ VkResult vulkan_core::BeginFrame(u32 &next_image_idx)
                                                     VK_NULL_HANDLE,
                                                     &next_image_idx);
     
+    // The command buffers and per-image buffers of the image are rewritten once it
+    // is acquired, so wait for the frame that last rendered to it as well
+    if (khr_result == VK_SUCCESS || khr_result == VK_SUBOPTIMAL_KHR)
+    {
+        if (SyncObjects.ImagesInFlight[next_image_idx] != VK_NULL_HANDLE)
+        {
+            vk::vkWaitForFences(Device, 1,
+                                &SyncObjects.ImagesInFlight[next_image_idx],
+                                VK_TRUE, UINT64_MAX);
+        }
+        
+        SyncObjects.ImagesInFlight[next_image_idx] = SyncObjects.InFlightFences[SyncObjects.CurrentFrame];
+    }
+    
     return khr_result;
 }
 
@@ -1089,6 +1153,35 @@ void vulkan_core::EndCommandBuffer(VkCommandBuffer command_buffer)
                     "Failed to record command buffer!");
 }
 
+void vulkan_core::BeginSecondaryCommandBuffer(VkCommandBuffer command_buffer,
+                                              VkRenderPass    render_pass,
+                                              u32             subpass,
+                                              VkFramebuffer   framebuffer,
+                                              bool            one_time_submit)
+{
+    VkCommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass  = render_pass;
+    inheritanceInfo.subpass     = subpass;
+    inheritanceInfo.framebuffer = framebuffer;
+    
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    if (one_time_submit) beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    
+    VK_CHECK_RESULT(vk::vkBeginCommandBuffer(command_buffer, &beginInfo),
+                    "Failed to begin recording secondary command buffer!");
+}
+
+void vulkan_core::ExecuteCommands(VkCommandBuffer  command_buffer,
+                                  u32              secondary_buffer_count,
+                                  VkCommandBuffer *secondary_buffers)
+{
+    vk::vkCmdExecuteCommands(command_buffer, secondary_buffer_count, secondary_buffers);
+}
+
 
 VkRenderPass vulkan_core::CreateRenderPass(VkAttachmentDescription *attachments, 
                                            u32                      attachments_count,
@@ -1124,7 +1217,8 @@ void vulkan_core::BeginRenderPass(VkCommandBuffer command_buffer,
                                   VkClearValue    *clear_values,
                                   u32             clear_values_count,
                                   VkFramebuffer   framebuffer,
-                                  VkRenderPass    render_pass) 
+                                  VkRenderPass    render_pass,
+                                  VkSubpassContents contents) 
 {
     VkRenderPassBeginInfo renderPassInfo = {};
     renderPassInfo.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1135,7 +1229,7 @@ void vulkan_core::BeginRenderPass(VkCommandBuffer command_buffer,
     renderPassInfo.clearValueCount   = clear_values_count;
     renderPassInfo.pClearValues      = clear_values;
     
-    vk::vkCmdBeginRenderPass(command_buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vk::vkCmdBeginRenderPass(command_buffer, &renderPassInfo, contents);
 }
 
 void vulkan_core::EndRenderPass(VkCommandBuffer command_buffer) 
@@ -1189,6 +1283,12 @@ void vulkan_core::DestroyCommandPool(VkCommandPool command_pool)
     vk::vkDestroyCommandPool(Device, command_pool, nullptr);
 }
 
+void vulkan_core::ResetCommandPool(VkCommandPool command_pool)
+{
+    VK_CHECK_RESULT(vk::vkResetCommandPool(Device, command_pool, 0),
+                    "Failed to reset command pool!");
+}
+
 
 VkFormat vulkan_core::FindDepthFormat()
 {
@@ -1485,11 +1585,13 @@ void vulkan_core::DestroyVmaBuffer(VkBuffer buffer, VmaAllocation allocation)
 void vulkan_core::CopyBuffer(VkCommandPool command_pool,
                              VkBuffer      src_buffer,
                              VkBuffer      dst_buffer,
-                             VkDeviceSize  size) 
+                             VkDeviceSize  size,
+                             VkDeviceSize  dst_offset) 
 {
     VkCommandBuffer command_buffer = BeginSingleTimeCommands(command_pool);
     
     VkBufferCopy copy_region = {};
+    copy_region.dstOffset = dst_offset;
     copy_region.size = size;
     vk::vkCmdCopyBuffer(command_buffer, src_buffer, dst_buffer, 1, &copy_region);
     
@@ -1647,6 +1749,41 @@ void vulkan_core::DrawIndexed(VkCommandBuffer command_buffer,
                          first_instance);
 }
 
+void vulkan_core::DrawIndirect(VkCommandBuffer command_buffer,
+                               VkBuffer        buffer,
+                               VkDeviceSize    offset,
+                               u32             draw_count,
+                               u32             stride)
+{
+    vk::vkCmdDrawIndirect(command_buffer, buffer, offset, draw_count, stride);
+}
+
+void vulkan_core::DrawIndexedIndirect(VkCommandBuffer command_buffer,
+                                      VkBuffer        buffer,
+                                      VkDeviceSize    offset,
+                                      u32             draw_count,
+                                      u32             stride)
+{
+    vk::vkCmdDrawIndexedIndirect(command_buffer, buffer, offset, draw_count, stride);
+}
+
+void vulkan_core::DrawIndexedIndirectCount(VkCommandBuffer command_buffer,
+                                           VkBuffer        buffer,
+                                           VkDeviceSize    offset,
+                                           VkBuffer        count_buffer,
+                                           VkDeviceSize    count_offset,
+                                           u32             max_draw_count,
+                                           u32             stride)
+{
+    vk::vkCmdDrawIndexedIndirectCountKHR(command_buffer,
+                                         buffer,
+                                         offset,
+                                         count_buffer,
+                                         count_offset,
+                                         max_draw_count,
+                                         stride);
+}
+
 VkDescriptorSetLayout vulkan_core::CreateDescriptorSetLayout(VkDescriptorSetLayoutBinding *bindings, u32 bindings_count) 
 {
     VkDescriptorSetLayoutCreateInfo layoutInfo = {};
@@ -132,8 +132,61 @@ struct sync_object_parameters
     VkFence     InFlightFences[MAX_FRAMES];
     size_t      CurrentFrame = 0;
     
+    // Fence of the frame that last rendered to each swapchain image, VK_NULL_HANDLE
+    // until the image is first used. With more images than frames in flight an
+    // image can be acquired while the frame that used it is still executing.
+    VkFence    *ImagesInFlight;
+    
 };
 
+#if defined(MAPLE_NULL_VULKAN)
+
+// The null backend (maple_vk_null.cpp) implements vulkan_core without a device:
+// handles are fake, buffers are plain host memory and commands only bump a
+// counter. Used to run and profile the cpu side of the renderer headless.
+#define VK_NULL_CALLS(X)                                                        \
+X(Init) X(Shutdown) X(Idle)                                                     \
+X(CreateVmaBuffer) X(CreateVmaBufferWithStaging) X(DestroyVmaBuffer)            \
+X(CopyBuffer) X(VmaMap) X(VmaUnmap) X(VmaFlushAllocation) X(Map) X(Unmap)       \
+X(BindVertexBuffers) X(BindIndexBuffer)                                         \
+X(CreateImageView) X(DestroyImageView) X(CreateImageSampler)                    \
+X(DestroyImageSampler) X(CreateVmaImage) X(DestroyVmaImage)                     \
+X(TransitionImageLayout) X(CopyBufferToImage)                                   \
+X(CreateCommandPool) X(DestroyCommandPool) X(ResetCommandPool)                  \
+X(CreateCommandBuffers) X(DestroyCommandBuffers)                                \
+X(BeginCommandBuffer) X(EndCommandBuffer) X(BeginSecondaryCommandBuffer)        \
+X(ExecuteCommands) X(BeginSingleTimeCommands) X(EndSingleTimeCommands)          \
+X(CreateRenderPass) X(DestroyRenderPass) X(BeginRenderPass) X(EndRenderPass)    \
+X(CreateFramebuffer) X(DestroyFramebuffer)                                      \
+X(BeginFrame) X(EndFrame) X(SetViewport) X(SetScissor)                          \
+X(CreateShaderModule) X(DestroyShaderModule)                                    \
+X(CreatePipelineCache) X(DestroyPipelineCache)                                  \
+X(CreatePipeline) X(DestroyPipeline)                                            \
+X(CreatePipelineLayout) X(DestroyPipelineLayout) X(BindPipeline)                \
+X(Draw) X(DrawIndexed) X(DrawIndirect) X(DrawIndexedIndirect)                  \
+X(DrawIndexedIndirectCount)                                                     \
+X(CreateDescriptorSetLayout) X(DestroyDescriptorSetLayout)                      \
+X(CreateDescriptorPool) X(DestroyDescriptorPool) X(ResetDescriptorPool)         \
+X(CreateDescriptorSets) X(DestroyDescriptorSets) X(UpdateDescriptorSets)        \
+X(BindDescriptorSets) X(PushConstants)
+
+#define VK_NULL_CALL_ENUM(Name) VkCall_##Name,
+typedef enum vk_call
+{
+    VK_NULL_CALLS(VK_NULL_CALL_ENUM)
+    
+    VkCall_Count,
+} vk_call;
+#undef VK_NULL_CALL_ENUM
+
+// Number of times a vulkan_core function was called since the last reset.
+// Safe to read while other threads are recording.
+u64 vk_null_call_count(vk_call Call);
+void vk_null_reset_call_counts();
+const char* vk_null_call_name(vk_call Call);
+
+#endif // MAPLE_NULL_VULKAN
+
 struct vulkan_core
 {
     VkInstance             Instance;
@@ -154,6 +207,14 @@ struct vulkan_core
     // MSAA
     VkSampleCountFlagBits  MsaaSamples = VK_SAMPLE_COUNT_1_BIT;
     
+    // Indirect drawing, enabled when the device supports it. Without
+    // MultiDrawIndirect every indirect call reads a single draw, without
+    // DrawIndirectFirstInstance the firstInstance of indirect draws has to be 0.
+    bool                   HasMultiDrawIndirect         = false;
+    bool                   HasDrawIndirectFirstInstance = false;
+    // VK_KHR_draw_indirect_count
+    bool                   HasDrawIndirectCount         = false;
+    
     //~ Setup
     
     bool Init();
@@ -190,7 +251,8 @@ struct vulkan_core
     void CopyBuffer(VkCommandPool command_pool,
                     VkBuffer      src_buffer,
                     VkBuffer      dst_buffer,
-                    VkDeviceSize  size);
+                    VkDeviceSize  size,
+                    VkDeviceSize  dst_offset = 0);
     
     void VmaMap(void **mapped_memory, VmaAllocation allocation);
     void VmaUnmap(VmaAllocation allocation);
@@ -243,6 +305,8 @@ struct vulkan_core
     
     VkCommandPool CreateCommandPool(VkCommandPoolCreateFlags flags);
     void DestroyCommandPool(VkCommandPool command_pool);
+    // Resets every command buffer allocated from the pool
+    void ResetCommandPool(VkCommandPool command_pool);
     
     void CreateCommandBuffers(VkCommandPool        command_pool,
                               VkCommandBufferLevel level,
@@ -256,6 +320,17 @@ struct vulkan_core
     void BeginCommandBuffer(VkCommandBuffer command_buffer);
     void EndCommandBuffer(VkCommandBuffer command_buffer);
     
+    // Begins a secondary command buffer that continues the given subpass of a
+    // render pass. Buffers that are submitted more than once must not be one time submit.
+    void BeginSecondaryCommandBuffer(VkCommandBuffer command_buffer,
+                                     VkRenderPass    render_pass,
+                                     u32             subpass,
+                                     VkFramebuffer   framebuffer,
+                                     bool            one_time_submit = true);
+    void ExecuteCommands(VkCommandBuffer  command_buffer,
+                         u32              secondary_buffer_count,
+                         VkCommandBuffer *secondary_buffers);
+    
     VkCommandBuffer BeginSingleTimeCommands(VkCommandPool command_pool);
     void EndSingleTimeCommands(VkCommandBuffer commandBuffer, VkCommandPool command_pool);
     
@@ -272,7 +347,8 @@ struct vulkan_core
                          VkClearValue    *clear_values,
                          u32              clear_values_count,
                          VkFramebuffer    framebuffer,
-                         VkRenderPass     render_pass);
+                         VkRenderPass     render_pass,
+                         VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
     void EndRenderPass(VkCommandBuffer command_buffer);
     
     //~ Framebuffer 
@@ -338,6 +414,30 @@ struct vulkan_core
                      u32             vertex_offset,
                      u32             first_instance);
     
+    // Reads draw_count VkDrawIndirectCommands from buffer, stride bytes apart
+    void DrawIndirect(VkCommandBuffer command_buffer,
+                      VkBuffer        buffer,
+                      VkDeviceSize    offset,
+                      u32             draw_count,
+                      u32             stride);
+    
+    // Reads draw_count VkDrawIndexedIndirectCommands from buffer, stride bytes apart
+    void DrawIndexedIndirect(VkCommandBuffer command_buffer,
+                             VkBuffer        buffer,
+                             VkDeviceSize    offset,
+                             u32             draw_count,
+                             u32             stride);
+    
+    // Like DrawIndexedIndirect, but the draw count is read from count_buffer and
+    // clamped to max_draw_count. Only valid when HasDrawIndirectCount is set.
+    void DrawIndexedIndirectCount(VkCommandBuffer command_buffer,
+                                  VkBuffer        buffer,
+                                  VkDeviceSize    offset,
+                                  VkBuffer        count_buffer,
+                                  VkDeviceSize    count_offset,
+                                  u32             max_draw_count,
+                                  u32             stride);
+    
     //~ Create Descpriptor Sets
     
     VkDescriptorSetLayout CreateDescriptorSetLayout(VkDescriptorSetLayoutBinding *bindings, u32 bindings_count);
@@ -0,0 +1,697 @@
+
+//~ Null Vulkan backend
+// Stand-in for maple_vk.cpp when building with MAPLE_NULL_VULKAN. Nothing talks
+// to a driver: every call is counted, objects get unique fake handles and
+// buffers are backed by host memory so uniform and upload buffers can still be
+// written through their mapped pointers.
+
+#define VK_NULL_SWAPCHAIN_IMAGES   3
+#define VK_NULL_SWAPCHAIN_WIDTH    1920
+#define VK_NULL_SWAPCHAIN_HEIGHT   1080
+#define VK_NULL_UNIFORM_ALIGNMENT  256
+
+// Backs a VmaAllocation
+typedef struct vk_null_allocation
+{
+    void         *Memory;
+    VkDeviceSize  Size;
+} vk_null_allocation;
+
+file_global std::atomic<u64> VkNullCallCounts[VkCall_Count];
+file_global std::atomic<u64> VkNullNextHandle(1);
+file_global u32              VkNullNextImage;
+
+#define VK_NULL_CALL_NAME(Name) #Name,
+file_global const char *VkNullCallNames[] = {
+    VK_NULL_CALLS(VK_NULL_CALL_NAME)
+};
+#undef VK_NULL_CALL_NAME
+
+#define vk_null_record(Name) VkNullCallCounts[VkCall_##Name].fetch_add(1, std::memory_order_relaxed)
+
+u64 vk_null_call_count(vk_call Call)
+{
+    return VkNullCallCounts[Call].load(std::memory_order_relaxed);
+}
+
+void vk_null_reset_call_counts()
+{
+    for (u32 Call = 0; Call < VkCall_Count; ++Call)
+    {
+        VkNullCallCounts[Call].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* vk_null_call_name(vk_call Call)
+{
+    return (Call < VkCall_Count) ? VkNullCallNames[Call] : "Unknown";
+}
+
+// Handles are never dereferenced, they only have to be unique and non-null
+template<typename T>
+T vk_null_handle()
+{
+    return (T)(uptr)VkNullNextHandle.fetch_add(1, std::memory_order_relaxed);
+}
+
+file_internal VmaAllocation vk_null_allocate(VkDeviceSize Size)
+{
+    // NOTE(Dustin): Vertex and image data can be far larger than the graphics
+    // heap, so the backing memory comes from the crt.
+    vk_null_allocation *Allocation = (vk_null_allocation*)malloc(sizeof(vk_null_allocation));
+    Allocation->Memory = (Size) ? calloc(1, Size) : NULL;
+    Allocation->Size   = Size;
+    return (VmaAllocation)Allocation;
+}
+
+file_internal void vk_null_release(VmaAllocation Allocation)
+{
+    vk_null_allocation *NullAllocation = (vk_null_allocation*)Allocation;
+    if (NullAllocation)
+    {
+        free(NullAllocation->Memory);
+        free(NullAllocation);
+    }
+}
+
+#ifndef VK_USE_PLATFORM_WIN32_KHR
+// graphics_win32.cpp is not part of headless builds
+void PlatformFatalError(char *Fmt, ...)
+{
+    va_list Args;
+    va_start(Args, Fmt);
+    vfprintf(stderr, Fmt, Args);
+    va_end(Args);
+    
+    exit(1);
+}
+#endif
+
+//~ Setup
+
+bool vulkan_core::Init()
+{
+    vk_null_record(Init);
+    
+    Instance            = vk_null_handle<VkInstance>();
+    PhysicalDevice      = vk_null_handle<VkPhysicalDevice>();
+    Device              = vk_null_handle<VkDevice>();
+    PresentationSurface = vk_null_handle<VkSurfaceKHR>();
+    
+    GraphicsQueue = { vk_null_handle<VkQueue>(), 0 };
+    PresentQueue  = GraphicsQueue;
+    
+    SwapChain.Handle      = vk_null_handle<VkSwapchainKHR>();
+    SwapChain.Format      = VK_FORMAT_B8G8R8A8_UNORM;
+    SwapChain.Extent      = { VK_NULL_SWAPCHAIN_WIDTH, VK_NULL_SWAPCHAIN_HEIGHT };
+    SwapChain.ImagesCount = VK_NULL_SWAPCHAIN_IMAGES;
+    SwapChain.Images      = palloc<image_parameters>(SwapChain.ImagesCount);
+    for (u32 i = 0; i < SwapChain.ImagesCount; ++i)
+    {
+        SwapChain.Images[i] = {};
+        SwapChain.Images[i].Handle = vk_null_handle<VkImage>();
+        SwapChain.Images[i].View   = vk_null_handle<VkImageView>();
+    }
+    
+    for (int i = 0; i < sync_object_parameters::MAX_FRAMES; ++i)
+    {
+        SyncObjects.ImageAvailable[i] = vk_null_handle<VkSemaphore>();
+        SyncObjects.RenderFinished[i] = vk_null_handle<VkSemaphore>();
+        SyncObjects.InFlightFences[i] = vk_null_handle<VkFence>();
+    }
+    SyncObjects.CurrentFrame   = 0;
+    SyncObjects.ImagesInFlight = NULL; // nothing executes, BeginFrame never waits
+    
+    VulkanAllocator = vk_null_handle<VmaAllocator>();
+    VkNullNextImage = 0;
+    
+    // Behaves like a desktop device, so the indirect paths are recorded in full
+    HasMultiDrawIndirect         = true;
+    HasDrawIndirectFirstInstance = true;
+    HasDrawIndirectCount         = true;
+    
+    return true;
+}
+
+void vulkan_core::Shutdown()
+{
+    vk_null_record(Shutdown);
+    
+    pfree(SwapChain.Images);
+    SwapChain.ImagesCount = 0;
+}
+
+//~ Device Info
+
+image_parameters* vulkan_core::GetSwapChainImages()
+{
+    return SwapChain.Images;
+}
+
+u32 vulkan_core::GetSwapChainImageCount() {
+    return SwapChain.ImagesCount;
+}
+
+VkFormat vulkan_core::GetSwapChainImageFormat() {
+    return SwapChain.Format;
+}
+
+VkExtent2D vulkan_core::GetSwapChainExtent() {
+    return SwapChain.Extent;
+}
+
+VkSampleCountFlagBits vulkan_core::GetMaxUsableSampleCount() {
+    return VK_SAMPLE_COUNT_1_BIT;
+}
+
+VkFormat vulkan_core::FindDepthFormat()
+{
+    return VK_FORMAT_D32_SFLOAT;
+}
+
+u64 vulkan_core::GetMinUniformMemoryOffsetAlignment()
+{
+    return VK_NULL_UNIFORM_ALIGNMENT;
+}
+
+void vulkan_core::Idle()
+{
+    vk_null_record(Idle);
+}
+
+//~ Buffers
+
+void vulkan_core::CreateVmaBuffer(VkBufferCreateInfo      buffer_create_info,
+                                  VmaAllocationCreateInfo /*vma_create_info*/,
+                                  VkBuffer                &buffer,
+                                  VmaAllocation           &allocation,
+                                  VmaAllocationInfo       &allocation_info)
+{
+    vk_null_record(CreateVmaBuffer);
+    
+    buffer     = vk_null_handle<VkBuffer>();
+    allocation = vk_null_allocate(buffer_create_info.size);
+    
+    // Every buffer is host visible and persistently mapped
+    allocation_info = {};
+    allocation_info.size        = buffer_create_info.size;
+    allocation_info.pMappedData = ((vk_null_allocation*)allocation)->Memory;
+}
+
+void vulkan_core::CreateVmaBufferWithStaging(VkBufferCreateInfo      buffer_create_info,
+                                             VmaAllocationCreateInfo /*vma_create_info*/,
+                                             VkCommandPool           /*CommandPool*/,
+                                             VkBuffer                &buffer,
+                                             VmaAllocation           &allocation,
+                                             void                    *data,
+                                             VkDeviceSize            size)
+{
+    vk_null_record(CreateVmaBufferWithStaging);
+    
+    buffer     = vk_null_handle<VkBuffer>();
+    allocation = vk_null_allocate(buffer_create_info.size);
+    
+    vk_null_allocation *NullAllocation = (vk_null_allocation*)allocation;
+    if (size > 0 && data && size <= NullAllocation->Size)
+    {
+        memcpy(NullAllocation->Memory, data, size);
+    }
+}
+
+void vulkan_core::DestroyVmaBuffer(VkBuffer /*buffer*/, VmaAllocation allocation)
+{
+    vk_null_record(DestroyVmaBuffer);
+    vk_null_release(allocation);
+}
+
+void vulkan_core::CopyBuffer(VkCommandPool /*command_pool*/,
+                             VkBuffer      /*src_buffer*/,
+                             VkBuffer      /*dst_buffer*/,
+                             VkDeviceSize  /*size*/,
+                             VkDeviceSize  /*dst_offset*/)
+{
+    // NOTE(Dustin): Only handles are known here, so the contents are not copied
+    vk_null_record(CopyBuffer);
+}
+
+void vulkan_core::VmaMap(void **mapped_memory, VmaAllocation allocation)
+{
+    vk_null_record(VmaMap);
+    *mapped_memory = ((vk_null_allocation*)allocation)->Memory;
+}
+
+void vulkan_core::VmaUnmap(VmaAllocation /*allocation*/)
+{
+    vk_null_record(VmaUnmap);
+}
+
+void vulkan_core::VmaFlushAllocation(VmaAllocation /*Allocation*/, VkDeviceSize /*Offset*/, VkDeviceSize /*Size*/)
+{
+    vk_null_record(VmaFlushAllocation);
+}
+
+void vulkan_core::Map(void             **mapped_memory,
+                      VkDeviceMemory   /*allocation*/,
+                      VkDeviceSize     /*offset*/,
+                      VkDeviceSize     /*size*/,
+                      VkMemoryMapFlags /*flags*/)
+{
+    vk_null_record(Map);
+    
+    // Raw device memory is never handed out by the null backend
+    Platform->mprinte("Map is not supported by the null vulkan backend!\n");
+    *mapped_memory = NULL;
+}
+
+void vulkan_core::Unmap(VkDeviceMemory /*allocation*/)
+{
+    vk_null_record(Unmap);
+}
+
+void vulkan_core::BindVertexBuffers(VkCommandBuffer /*command_buffer*/,
+                                    u32             /*first_binding*/,
+                                    u32             /*binding_count*/,
+                                    VkBuffer        */*buffers*/,
+                                    VkDeviceSize    */*offsets*/)
+{
+    vk_null_record(BindVertexBuffers);
+}
+
+void vulkan_core::BindIndexBuffer(VkCommandBuffer /*command_buffer*/,
+                                  VkBuffer        /*buffer*/,
+                                  VkDeviceSize    /*offset*/,
+                                  VkIndexType     /*index_type*/)
+{
+    vk_null_record(BindIndexBuffer);
+}
+
+//~ Image functions
+
+VkImageView vulkan_core::CreateImageView(VkImageViewCreateInfo /*create_info*/)
+{
+    vk_null_record(CreateImageView);
+    return vk_null_handle<VkImageView>();
+}
+
+void vulkan_core::DestroyImageView(VkImageView /*image_view*/)
+{
+    vk_null_record(DestroyImageView);
+}
+
+VkSampler vulkan_core::CreateImageSampler(VkSamplerCreateInfo /*sampler_info*/)
+{
+    vk_null_record(CreateImageSampler);
+    return vk_null_handle<VkSampler>();
+}
+
+void vulkan_core::DestroyImageSampler(VkSampler /*sampler*/)
+{
+    vk_null_record(DestroyImageSampler);
+}
+
+void vulkan_core::CreateVmaImage(VkImageCreateInfo       /*image_create_info*/,
+                                 VmaAllocationCreateInfo /*vma_create_info*/,
+                                 VkImage                 &image,
+                                 VmaAllocation           &allocation,
+                                 VmaAllocationInfo       &allocation_info)
+{
+    vk_null_record(CreateVmaImage);
+    
+    // Images are never mapped, so they do not get any memory
+    image           = vk_null_handle<VkImage>();
+    allocation      = vk_null_allocate(0);
+    allocation_info = {};
+}
+
+void vulkan_core::DestroyVmaImage(VkImage       /*image*/,
+                                  VmaAllocation allocation)
+{
+    vk_null_record(DestroyVmaImage);
+    vk_null_release(allocation);
+}
+
+void vulkan_core::TransitionImageLayout(VkCommandPool /*command_pool*/,
+                                        VkImage /*image*/, VkFormat /*format*/,
+                                        VkImageLayout /*oldLayout*/, VkImageLayout /*newLayout*/,
+                                        u32 /*mip_levels*/)
+{
+    vk_null_record(TransitionImageLayout);
+}
+
+void vulkan_core::CopyBufferToImage(VkCommandPool /*command_pool*/,
+                                    VkBuffer /*buffer*/,
+                                    VkImage /*image*/,
+                                    u32 /*width*/, u32 /*height*/)
+{
+    vk_null_record(CopyBufferToImage);
+}
+
+//~ Command Buffer
+
+VkCommandPool vulkan_core::CreateCommandPool(VkCommandPoolCreateFlags /*flags*/)
+{
+    vk_null_record(CreateCommandPool);
+    return vk_null_handle<VkCommandPool>();
+}
+
+void vulkan_core::DestroyCommandPool(VkCommandPool /*command_pool*/)
+{
+    vk_null_record(DestroyCommandPool);
+}
+
+void vulkan_core::ResetCommandPool(VkCommandPool /*command_pool*/)
+{
+    vk_null_record(ResetCommandPool);
+}
+
+void vulkan_core::CreateCommandBuffers(VkCommandPool        /*command_pool*/,
+                                       VkCommandBufferLevel /*level*/,
+                                       uint32_t             command_buffer_count,
+                                       VkCommandBuffer      *buffers)
+{
+    vk_null_record(CreateCommandBuffers);
+    for (u32 i = 0; i < command_buffer_count; ++i)
+    {
+        buffers[i] = vk_null_handle<VkCommandBuffer>();
+    }
+}
+
+void vulkan_core::DestroyCommandBuffers(VkCommandPool   /*command_pool*/,
+                                        u32             /*command_buffer_count*/,
+                                        VkCommandBuffer */*buffers*/)
+{
+    vk_null_record(DestroyCommandBuffers);
+}
+
+void vulkan_core::BeginCommandBuffer(VkCommandBuffer /*command_buffer*/)
+{
+    vk_null_record(BeginCommandBuffer);
+}
+
+void vulkan_core::EndCommandBuffer(VkCommandBuffer /*command_buffer*/)
+{
+    vk_null_record(EndCommandBuffer);
+}
+
+void vulkan_core::BeginSecondaryCommandBuffer(VkCommandBuffer /*command_buffer*/,
+                                              VkRenderPass    /*render_pass*/,
+                                              u32             /*subpass*/,
+                                              VkFramebuffer   /*framebuffer*/,
+                                              bool            /*one_time_submit*/)
+{
+    vk_null_record(BeginSecondaryCommandBuffer);
+}
+
+void vulkan_core::ExecuteCommands(VkCommandBuffer  /*command_buffer*/,
+                                  u32              /*secondary_buffer_count*/,
+                                  VkCommandBuffer */*secondary_buffers*/)
+{
+    vk_null_record(ExecuteCommands);
+}
+
+VkCommandBuffer vulkan_core::BeginSingleTimeCommands(VkCommandPool /*command_pool*/)
+{
+    vk_null_record(BeginSingleTimeCommands);
+    return vk_null_handle<VkCommandBuffer>();
+}
+
+void vulkan_core::EndSingleTimeCommands(VkCommandBuffer /*commandBuffer*/, VkCommandPool /*command_pool*/)
+{
+    vk_null_record(EndSingleTimeCommands);
+}
+
+//~ Render Pass
+
+VkRenderPass vulkan_core::CreateRenderPass(VkAttachmentDescription */*attachments*/,
+                                           u32                      /*attachments_count*/,
+                                           VkSubpassDescription    */*subpasses*/,
+                                           u32                      /*subpass_count*/,
+                                           VkSubpassDependency     */*dependencies*/,
+                                           u32                      /*dependency_count*/)
+{
+    vk_null_record(CreateRenderPass);
+    return vk_null_handle<VkRenderPass>();
+}
+
+void vulkan_core::DestroyRenderPass(VkRenderPass /*render_pass*/)
+{
+    vk_null_record(DestroyRenderPass);
+}
+
+void vulkan_core::BeginRenderPass(VkCommandBuffer   /*command_buffer*/,
+                                  VkClearValue     */*clear_values*/,
+                                  u32               /*clear_values_count*/,
+                                  VkFramebuffer     /*framebuffer*/,
+                                  VkRenderPass      /*render_pass*/,
+                                  VkSubpassContents /*contents*/)
+{
+    vk_null_record(BeginRenderPass);
+}
+
+void vulkan_core::EndRenderPass(VkCommandBuffer /*command_buffer*/)
+{
+    vk_null_record(EndRenderPass);
+}
+
+//~ Framebuffer
+
+VkFramebuffer vulkan_core::CreateFramebuffer(VkImageView */*image_views*/,
+                                             u32          /*image_views_count*/,
+                                             u32          /*image_index*/,
+                                             VkRenderPass /*render_pass*/)
+{
+    vk_null_record(CreateFramebuffer);
+    return vk_null_handle<VkFramebuffer>();
+}
+
+void vulkan_core::DestroyFramebuffer(VkFramebuffer /*framebuffer*/)
+{
+    vk_null_record(DestroyFramebuffer);
+}
+
+//~ Frame Setup
+
+// Never out of date, the images are handed out round robin
+VkResult vulkan_core::BeginFrame(u32 &next_image_idx)
+{
+    vk_null_record(BeginFrame);
+    
+    next_image_idx  = VkNullNextImage;
+    VkNullNextImage = (VkNullNextImage + 1) % SwapChain.ImagesCount;
+    
+    return VK_SUCCESS;
+}
+
+void vulkan_core::EndFrame(u32             /*current_image_index*/,
+                           VkCommandBuffer */*command_buffers*/,
+                           u32             /*command_buffer_count*/)
+{
+    vk_null_record(EndFrame);
+    
+    SyncObjects.CurrentFrame = (SyncObjects.CurrentFrame + 1) % sync_object_parameters::MAX_FRAMES;
+}
+
+void vulkan_core::SetViewport(VkCommandBuffer /*command_buffer*/,
+                              u32             /*first_viewport*/,
+                              u32             /*viewport_count*/,
+                              VkViewport      */*viewports*/)
+{
+    vk_null_record(SetViewport);
+}
+
+void vulkan_core::SetScissor(VkCommandBuffer /*command_buffer*/,
+                             u32             /*first_scissor*/,
+                             u32             /*scissor_count*/,
+                             VkRect2D        */*scissors*/)
+{
+    vk_null_record(SetScissor);
+}
+
+//~ Pipeline
+
+VkShaderModule vulkan_core::CreateShaderModule(const u32 */*code*/, size_t /*size*/)
+{
+    vk_null_record(CreateShaderModule);
+    return vk_null_handle<VkShaderModule>();
+}
+
+void vulkan_core::DestroyShaderModule(VkShaderModule /*module*/)
+{
+    vk_null_record(DestroyShaderModule);
+}
+
+void vulkan_core::CreatePipelineCache(VkPipelineCache *PipelineCache)
+{
+    vk_null_record(CreatePipelineCache);
+    *PipelineCache = vk_null_handle<VkPipelineCache>();
+}
+
+void vulkan_core::DestroyPipelineCache(VkPipelineCache /*PipelineCache*/)
+{
+    vk_null_record(DestroyPipelineCache);
+}
+
+VkPipeline vulkan_core::CreatePipeline(VkGraphicsPipelineCreateInfo /*pipeline_info*/)
+{
+    vk_null_record(CreatePipeline);
+    return vk_null_handle<VkPipeline>();
+}
+
+VkPipeline vulkan_core::CreatePipeline(VkGraphicsPipelineCreateInfo /*pipeline_info*/, VkPipelineCache /*PipelineCache*/)
+{
+    vk_null_record(CreatePipeline);
+    return vk_null_handle<VkPipeline>();
+}
+
+void vulkan_core::DestroyPipeline(VkPipeline /*pipeline*/)
+{
+    vk_null_record(DestroyPipeline);
+}
+
+VkPipelineLayout vulkan_core::CreatePipelineLayout(VkPipelineLayoutCreateInfo /*layout_info*/)
+{
+    vk_null_record(CreatePipelineLayout);
+    return vk_null_handle<VkPipelineLayout>();
+}
+
+void vulkan_core::DestroyPipelineLayout(VkPipelineLayout /*pipeline_layout*/)
+{
+    vk_null_record(DestroyPipelineLayout);
+}
+
+void vulkan_core::BindPipeline(VkCommandBuffer /*command_buffer*/, VkPipeline /*pipeline*/)
+{
+    vk_null_record(BindPipeline);
+}
+
+//~ Drawing
+
+void vulkan_core::Draw(VkCommandBuffer /*command_buffer*/,
+                       u32             /*vertex_count*/,
+                       u32             /*instance_count*/,
+                       u32             /*first_vertex*/,
+                       u32             /*first_instance*/)
+{
+    vk_null_record(Draw);
+}
+
+void vulkan_core::DrawIndexed(VkCommandBuffer /*command_buffer*/,
+                              u32             /*index_count*/,
+                              u32             /*instance_count*/,
+                              u32             /*first_index*/,
+                              u32             /*vertex_offset*/,
+                              u32             /*first_instance*/)
+{
+    vk_null_record(DrawIndexed);
+}
+
+void vulkan_core::DrawIndirect(VkCommandBuffer /*command_buffer*/,
+                               VkBuffer        /*buffer*/,
+                               VkDeviceSize    /*offset*/,
+                               u32             /*draw_count*/,
+                               u32             /*stride*/)
+{
+    vk_null_record(DrawIndirect);
+}
+
+void vulkan_core::DrawIndexedIndirect(VkCommandBuffer /*command_buffer*/,
+                                      VkBuffer        /*buffer*/,
+                                      VkDeviceSize    /*offset*/,
+                                      u32             /*draw_count*/,
+                                      u32             /*stride*/)
+{
+    vk_null_record(DrawIndexedIndirect);
+}
+
+void vulkan_core::DrawIndexedIndirectCount(VkCommandBuffer /*command_buffer*/,
+                                           VkBuffer        /*buffer*/,
+                                           VkDeviceSize    /*offset*/,
+                                           VkBuffer        /*count_buffer*/,
+                                           VkDeviceSize    /*count_offset*/,
+                                           u32             /*max_draw_count*/,
+                                           u32             /*stride*/)
+{
+    vk_null_record(DrawIndexedIndirectCount);
+}
+
+//~ Descriptor Sets
+
+VkDescriptorSetLayout vulkan_core::CreateDescriptorSetLayout(VkDescriptorSetLayoutBinding */*bindings*/, u32 /*bindings_count*/)
+{
+    vk_null_record(CreateDescriptorSetLayout);
+    return vk_null_handle<VkDescriptorSetLayout>();
+}
+
+void vulkan_core::DestroyDescriptorSetLayout(VkDescriptorSetLayout /*layout*/)
+{
+    vk_null_record(DestroyDescriptorSetLayout);
+}
+
+VkDescriptorPool vulkan_core::CreateDescriptorPool(VkDescriptorPoolSize       */*pool_sizes*/,
+                                                   u32                         /*pool_size_count*/,
+                                                   u32                         /*max_sets*/,
+                                                   VkDescriptorPoolCreateFlags /*flags*/)
+{
+    vk_null_record(CreateDescriptorPool);
+    return vk_null_handle<VkDescriptorPool>();
+}
+
+void vulkan_core::DestroyDescriptorPool(VkDescriptorPool /*descriptor_pool*/)
+{
+    vk_null_record(DestroyDescriptorPool);
+}
+
+void vulkan_core::ResetDescriptorPool(VkDescriptorPool /*descriptor_pool*/)
+{
+    vk_null_record(ResetDescriptorPool);
+}
+
+void vulkan_core::CreateDescriptorSets(VkDescriptorSet            *descriptor_sets,
+                                       VkDescriptorSetAllocateInfo allocInfo)
+{
+    vk_null_record(CreateDescriptorSets);
+    for (u32 i = 0; i < allocInfo.descriptorSetCount; ++i)
+    {
+        descriptor_sets[i] = vk_null_handle<VkDescriptorSet>();
+    }
+}
+
+void vulkan_core::DestroyDescriptorSets(VkDescriptorPool /*descriptor_pool*/,
+                                        VkDescriptorSet */*descriptor_sets*/,
+                                        u32              /*descriptor_count*/)
+{
+    vk_null_record(DestroyDescriptorSets);
+}
+
+void vulkan_core::UpdateDescriptorSets(VkWriteDescriptorSet */*descriptor_set_writes*/,
+                                       u32                   /*write_count*/,
+                                       u32                   /*copy_count*/,
+                                       VkCopyDescriptorSet*  /*pstop*/)
+{
+    vk_null_record(UpdateDescriptorSets);
+}
+
+void vulkan_core::BindDescriptorSets(VkCommandBuffer  /*command_buffer*/,
+                                     VkPipelineLayout /*layout*/,
+                                     u32              /*first_set*/,
+                                     u32              /*descriptor_set_count*/,
+                                     VkDescriptorSet  */*descriptor_sets*/,
+                                     u32              /*dynamic_offset_count*/,
+                                     u32              */*dynamic_offsets*/)
+{
+    vk_null_record(BindDescriptorSets);
+}
+
+//~ Push Constants
+
+void vulkan_core::PushConstants(VkCommandBuffer    /*CommandBuffer*/,
+                                VkPipelineLayout   /*Layout*/,
+                                VkShaderStageFlags /*StageFlags*/,
+                                u32                /*Offset*/,
+                                u32                /*Size*/,
+                                const void*        /*pValues*/)
+{
+    vk_null_record(PushConstants);
+}
+
+#undef vk_null_record
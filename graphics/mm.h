@@ -4,34 +4,42 @@
 template<typename T>
 T* palloc(memory *Allocator, u32 NumElements = 1)
 {
-    return (T*)memory_alloc(Allocator, sizeof(T) * NumElements);
+    return (T*)memory_alloc_aligned_tagged(Allocator, sizeof(T) * NumElements, alignof(T), MemoryTag_Graphics);
 }
 
 template<typename T>
 T* palloc(u32 NumElements = 1)
 {
-    return (T*)memory_alloc(Core->Memory, sizeof(T) * NumElements);
+    return (T*)memory_alloc_aligned_tagged(Core->Memory, sizeof(T) * NumElements, alignof(T), MemoryTag_Graphics);
 }
 
 template<typename T>
 void pfree(memory *Allocator, T *Ptr)
 {
-    memory_release(Allocator, (void*)Ptr);
+    memory_release_aligned(Allocator, (void*)Ptr);
 }
 
 
 template<typename T>
 void pfree(T *Ptr)
 {
-    memory_release(Core->Memory, (void*)Ptr);
+    memory_release_aligned(Core->Memory, (void*)Ptr);
 }
 
-#if 0
+// Transient allocation from the frame arena. The memory is valid until the end
+// of the next frame and must not be freed.
 template<typename T>
-T* halloc(tag_block_t Allocator, u64 Size)
+T* talloc(u32 NumElements = 1)
 {
-    return (T*)TaggedHeapBlockAlloc(Allocator, sizeof(T) * Size);
+    return (T*)frame_arena_alloc(Platform->FrameArena, sizeof(T) * NumElements);
+}
+
+// Allocation from a tagged heap block. The memory lives until the block's tag is
+// freed with tagged_heap_free_tag.
+template<typename T>
+T* halloc(tag_block_t Allocator, u32 NumElements = 1)
+{
+    return (T*)tagged_heap_block_alloc(Allocator, sizeof(T) * NumElements);
 }
-#endif
 
 #endif //MAPLE_MM_H
\ No newline at end of file
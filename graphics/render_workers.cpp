@@ -0,0 +1,241 @@
+
+typedef struct render_worker_frame
+{
+    VkCommandPool   CommandPool;
+    VkCommandBuffer CommandBuffers[RENDER_WORKER_MAX_COMMAND_BUFFERS];
+    u32             CommandBufferCount; // allocated from the pool so far
+    u32             CommandBuffersUsed; // recorded this frame
+} render_worker_frame;
+
+typedef struct render_worker
+{
+    render_worker_frame Frames[sync_object_parameters::MAX_FRAMES];
+    translate_context   Context;
+} render_worker;
+
+typedef struct render_workers
+{
+    render_worker    Workers[RENDER_WORKER_MAX_THREADS]; // 0 is the main thread
+    u32              WorkerCount;
+    u32              FrameIndex;
+    
+    // The current job. Only written while no worker is busy.
+    command_list    *Lists;
+    u32              ListCount;
+    VkCommandBuffer *Output;     // one entry per list, VK_NULL_HANDLE for empty lists
+    std::atomic<u32> NextList;
+    
+    std::mutex              Lock;
+    std::condition_variable WorkReady;
+    std::condition_variable WorkDone;
+    u32                     Generation; // bumped for every job
+    u32                     Busy;       // threads working on the current job
+    bool                    IsRunning;
+    
+    std::thread             Threads[RENDER_WORKER_MAX_THREADS];
+} render_workers;
+
+file_global render_workers RenderWorkers;
+
+file_internal VkCommandBuffer render_worker_record(render_worker *Worker, command_list CommandList)
+{
+    mp_command_list_sync_epoch(CommandList);
+    if (!CommandList->CommandCount)
+    {
+        mp_command_list_rewind(CommandList);
+        return VK_NULL_HANDLE;
+    }
+    
+    if (CommandList->IsStatic && CommandList->IsCacheable)
+    {
+        return mp_command_list_record_static(&Worker->Context, CommandList);
+    }
+    
+    render_worker_frame *Frame = Worker->Frames + RenderWorkers.FrameIndex;
+    if (Frame->CommandBuffersUsed == RENDER_WORKER_MAX_COMMAND_BUFFERS)
+    {
+        Platform->mprinte("A render worker ran out of secondary command buffers! Dropping a command list.\n");
+        mp_command_list_rewind(CommandList);
+        return VK_NULL_HANDLE;
+    }
+    
+    if (Frame->CommandBuffersUsed == Frame->CommandBufferCount)
+    {
+        Core->VkCore.CreateCommandBuffers(Frame->CommandPool, VK_COMMAND_BUFFER_LEVEL_SECONDARY, 1,
+                                          Frame->CommandBuffers + Frame->CommandBufferCount);
+        Frame->CommandBufferCount++;
+    }
+    
+    VkCommandBuffer CommandBuffer = Frame->CommandBuffers[Frame->CommandBuffersUsed++];
+    mp_translate_context_begin_secondary(&Worker->Context, CommandBuffer, true);
+    
+    mp_command_list_translate(&Worker->Context, CommandList);
+    
+    Core->VkCore.EndCommandBuffer(CommandBuffer);
+    
+    return CommandBuffer;
+}
+
+// Takes lists until there are none left
+file_internal void render_worker_run(render_worker *Worker)
+{
+    u32 ListIdx;
+    while ((ListIdx = RenderWorkers.NextList.fetch_add(1)) < RenderWorkers.ListCount)
+    {
+        RenderWorkers.Output[ListIdx] = render_worker_record(Worker, RenderWorkers.Lists[ListIdx]);
+    }
+}
+
+file_internal void render_worker_main(u32 WorkerIdx)
+{
+    render_worker *Worker = RenderWorkers.Workers + WorkerIdx;
+    u32 Generation = 0;
+    
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> Lock(RenderWorkers.Lock);
+            while (RenderWorkers.IsRunning && RenderWorkers.Generation == Generation)
+            {
+                RenderWorkers.WorkReady.wait(Lock);
+            }
+            
+            if (!RenderWorkers.IsRunning) return;
+            
+            Generation = RenderWorkers.Generation;
+            RenderWorkers.Busy++;
+        }
+        
+        render_worker_run(Worker);
+        
+        {
+            std::unique_lock<std::mutex> Lock(RenderWorkers.Lock);
+            if (--RenderWorkers.Busy == 0) RenderWorkers.WorkDone.notify_all();
+        }
+    }
+}
+
+void render_workers_init()
+{
+    u32 ThreadCount = std::thread::hardware_concurrency();
+    if (ThreadCount == 0) ThreadCount = 1;
+    if (ThreadCount > RENDER_WORKER_MAX_THREADS) ThreadCount = RENDER_WORKER_MAX_THREADS;
+    
+    RenderWorkers.WorkerCount = ThreadCount;
+    RenderWorkers.FrameIndex  = 0;
+    RenderWorkers.Generation  = 0;
+    RenderWorkers.Busy        = 0;
+    RenderWorkers.IsRunning   = true;
+    
+    for (u32 WorkerIdx = 0; WorkerIdx < RenderWorkers.WorkerCount; ++WorkerIdx)
+    {
+        render_worker *Worker = RenderWorkers.Workers + WorkerIdx;
+        *Worker = {};
+        Worker->Context.CameraApplied = true;
+        
+        // The pools are only ever reset as a whole
+        for (u32 FrameIdx = 0; FrameIdx < sync_object_parameters::MAX_FRAMES; ++FrameIdx)
+        {
+            Worker->Frames[FrameIdx].CommandPool = Core->VkCore.CreateCommandPool(VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+        }
+        
+        if (WorkerIdx > 0)
+        {
+            RenderWorkers.Threads[WorkerIdx] = std::thread(render_worker_main, WorkerIdx);
+        }
+    }
+}
+
+void render_workers_free()
+{
+    {
+        std::unique_lock<std::mutex> Lock(RenderWorkers.Lock);
+        RenderWorkers.IsRunning = false;
+    }
+    RenderWorkers.WorkReady.notify_all();
+    
+    for (u32 WorkerIdx = 1; WorkerIdx < RenderWorkers.WorkerCount; ++WorkerIdx)
+    {
+        RenderWorkers.Threads[WorkerIdx].join();
+    }
+    
+    // NOTE(Dustin): Destroying a pool frees its command buffers
+    for (u32 WorkerIdx = 0; WorkerIdx < RenderWorkers.WorkerCount; ++WorkerIdx)
+    {
+        render_worker *Worker = RenderWorkers.Workers + WorkerIdx;
+        for (u32 FrameIdx = 0; FrameIdx < sync_object_parameters::MAX_FRAMES; ++FrameIdx)
+        {
+            Core->VkCore.DestroyCommandPool(Worker->Frames[FrameIdx].CommandPool);
+        }
+        *Worker = {};
+    }
+    
+    RenderWorkers.WorkerCount = 0;
+}
+
+void render_workers_begin_frame(u32 FrameIndex)
+{
+    RenderWorkers.FrameIndex = FrameIndex;
+    
+    for (u32 WorkerIdx = 0; WorkerIdx < RenderWorkers.WorkerCount; ++WorkerIdx)
+    {
+        render_worker_frame *Frame = RenderWorkers.Workers[WorkerIdx].Frames + FrameIndex;
+        if (Frame->CommandBuffersUsed)
+        {
+            Core->VkCore.ResetCommandPool(Frame->CommandPool);
+            Frame->CommandBuffersUsed = 0;
+        }
+    }
+}
+
+u32 render_workers_translate(command_list *Lists, u32 ListCount, VkCommandBuffer *CommandBuffers)
+{
+    if (ListCount == 0) return 0;
+    
+    VkCommandBuffer *Output = palloc<VkCommandBuffer>(ListCount);
+    
+    // The camera is global state that the workers read, so it is set here rather
+    // than by whichever worker translates the list that records it
+    for (u32 ListIdx = 0; ListIdx < ListCount; ++ListIdx)
+    {
+        mp_command_list_apply_camera(Lists[ListIdx]);
+    }
+    
+    {
+        // A worker that woke up late for the previous job may still be looking at it
+        std::unique_lock<std::mutex> Lock(RenderWorkers.Lock);
+        while (RenderWorkers.Busy) RenderWorkers.WorkDone.wait(Lock);
+        
+        RenderWorkers.Lists     = Lists;
+        RenderWorkers.ListCount = ListCount;
+        RenderWorkers.Output    = Output;
+        RenderWorkers.NextList.store(0);
+        RenderWorkers.Generation++;
+    }
+    
+    // Not worth waking anyone for a single list
+    if (ListCount > 1) RenderWorkers.WorkReady.notify_all();
+    
+    render_worker_run(RenderWorkers.Workers);
+    
+    {
+        std::unique_lock<std::mutex> Lock(RenderWorkers.Lock);
+        while (RenderWorkers.Busy) RenderWorkers.WorkDone.wait(Lock);
+    }
+    
+    u32 Count = 0;
+    for (u32 ListIdx = 0; ListIdx < ListCount; ++ListIdx)
+    {
+        if (Output[ListIdx]) CommandBuffers[Count++] = Output[ListIdx];
+    }
+    pfree(Output);
+    
+    for (u32 WorkerIdx = 0; WorkerIdx < RenderWorkers.WorkerCount; ++WorkerIdx)
+    {
+        translate_context *Context = &RenderWorkers.Workers[WorkerIdx].Context;
+        render_stats_add(&Core->Renderer->FrameStats, &Context->Stats);
+        Context->Stats = {};
+    }
+    
+    return Count;
+}
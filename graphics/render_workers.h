@@ -0,0 +1,25 @@
+#ifndef GRAPHICS_RENDER_WORKERS_H
+#define GRAPHICS_RENDER_WORKERS_H
+
+// Command lists handed to end_frame are translated in parallel. Every worker
+// records into secondary command buffers allocated from its own command pool,
+// one pool per frame in flight, and the pool is reset as a whole once the frame
+// it was used for has finished on the gpu. The main thread works on the lists
+// as well, so there is always at least one worker.
+#define RENDER_WORKER_MAX_THREADS          8
+// Secondary command buffers a single worker can record in a frame
+#define RENDER_WORKER_MAX_COMMAND_BUFFERS  64
+
+void render_workers_init();
+void render_workers_free();
+
+// FrameIndex is the frame in flight, see sync_object_parameters
+void render_workers_begin_frame(u32 FrameIndex);
+
+// Translates every list into its own secondary command buffer and writes the
+// buffers to CommandBuffers in list order. Lists without commands are skipped.
+// Returns the number of buffers written. Must be called inside a render pass
+// begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+u32 render_workers_translate(command_list *Lists, u32 ListCount, VkCommandBuffer *CommandBuffers);
+
+#endif //GRAPHICS_RENDER_WORKERS_H
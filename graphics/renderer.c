@@ -157,15 +157,15 @@ void renderer_init(renderer *Renderer)
         
         VkDescriptorPoolSize DescriptorPoolSizes[SizeCount];
         
-        DescriptorPoolSizes[0] = {0};
+        DescriptorPoolSizes[0] = {};
         DescriptorPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         DescriptorPoolSizes[0].descriptorCount = SwapChainImageCount;
         
-        DescriptorPoolSizes[1] = {0};
+        DescriptorPoolSizes[1] = {};
         DescriptorPoolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         DescriptorPoolSizes[1].descriptorCount = SwapChainImageCount;
         
-        DescriptorPoolSizes[2] = {0};
+        DescriptorPoolSizes[2] = {};
         DescriptorPoolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         DescriptorPoolSizes[2].descriptorCount = SwapChainImageCount;
         
@@ -176,6 +176,10 @@ void renderer_init(renderer *Renderer)
     }
     global_shader_data_init(&Renderer->GlobalShaderData);
     object_data_buffer_init(&Renderer->ObjectDataBuffer);
+    transient_ring_init();
+    geometry_heap_init();
+    
+    render_workers_init();
     
     Renderer->CurrentImageIndex = 0;
 }
@@ -184,6 +188,10 @@ void renderer_free(renderer *Renderer)
 {
     Core->VkCore.Idle();
     
+    render_workers_free();
+    
+    geometry_heap_free();
+    transient_ring_free();
     object_data_buffer_free(&Renderer->ObjectDataBuffer);
     global_shader_data_free(&Renderer->GlobalShaderData);
     Core->VkCore.DestroyDescriptorPool(Renderer->DescriptorPool);
@@ -224,20 +232,21 @@ u32 renderer_begin_frame()
         Core->Renderer->CurrentImageIndex = Result;
         Core->Renderer->ActiveCommandBuffer  = Core->Renderer->CommandBuffers + Result;
         Core->VkCore.BeginCommandBuffer(*Core->Renderer->ActiveCommandBuffer);
+        
+        // Nothing is bound on a freshly begun command buffer
+        Core->Renderer->PrimaryContext = {};
+        Core->Renderer->PrimaryContext.CommandBuffer = *Core->Renderer->ActiveCommandBuffer;
+        Core->Renderer->IsRenderPassActive = false;
+        
+        // BeginFrame waited for this frame's fence, so the command buffers the
+        // workers recorded for it last time and its transient memory are no
+        // longer in use
+        render_workers_begin_frame(Core->VkCore.SyncObjects.CurrentFrame);
+        transient_ring_begin_frame(Core->VkCore.SyncObjects.CurrentFrame);
     }
     
     // Setup render state
     {
-        VkCommandBuffer *ActiveCommandBuffer = Core->Renderer->ActiveCommandBuffer;
-        VkFramebuffer Framebuffer = Core->Renderer->Framebuffers[Result];
-        
-        VkClearColorValue ClearValue = { 0.67f, 0.85f, 0.90f, 1.0f };
-        
-        VkClearValue clear_values[2] = {};
-        clear_values[0].color        = ClearValue;
-        clear_values[1].depthStencil = { 1.0f, 0 };
-        Core->VkCore.BeginRenderPass(*ActiveCommandBuffer, clear_values, 2, Framebuffer, Core->Renderer->PrimaryRenderPass);
-        
         //render_set_viewport_info *ViewportInfo = talloc<render_set_viewport_info>(1);
         VkExtent2D Extent = Core->VkCore.GetSwapChainExtent();
         
@@ -247,7 +256,7 @@ u32 renderer_begin_frame()
         VkRect2D Scissor = {};
         Scissor.offset   = {0, 0};
         Scissor.extent   = Extent;
-        Core->VkCore.SetScissor(*ActiveCommandBuffer, 0, 1, &Scissor);
+        Core->Renderer->ActiveScissor = Scissor;
         
         VkViewport Viewport = {};
         Viewport.x          = 0;
@@ -256,16 +265,81 @@ u32 renderer_begin_frame()
         Viewport.height     = Height;
         Viewport.minDepth   = 0.0f;
         Viewport.maxDepth   = 1.0f;
-        Core->VkCore.SetViewport(*ActiveCommandBuffer, 0, 1, &Viewport);
+        Core->Renderer->ActiveViewport = Viewport;
     }
     
     return Result; 
 }
 
+// Begins the render pass on the primary command buffer if it has not been begun
+// yet this frame. With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass
+// can only be filled with vkCmdExecuteCommands, and every secondary command
+// buffer sets its own viewport and scissor.
+void renderer_begin_render_pass(VkSubpassContents Contents)
+{
+    if (Core->Renderer->IsRenderPassActive) return;
+    
+    VkCommandBuffer *ActiveCommandBuffer = Core->Renderer->ActiveCommandBuffer;
+    VkFramebuffer Framebuffer = Core->Renderer->Framebuffers[Core->Renderer->CurrentImageIndex];
+    
+    VkClearColorValue ClearValue = { 0.67f, 0.85f, 0.90f, 1.0f };
+    
+    VkClearValue clear_values[2] = {};
+    clear_values[0].color        = ClearValue;
+    clear_values[1].depthStencil = { 1.0f, 0 };
+    Core->VkCore.BeginRenderPass(*ActiveCommandBuffer, clear_values, 2, Framebuffer, 
+                                 Core->Renderer->PrimaryRenderPass, Contents);
+    
+    if (Contents == VK_SUBPASS_CONTENTS_INLINE)
+    {
+        Core->VkCore.SetScissor(*ActiveCommandBuffer, 0, 1, &Core->Renderer->ActiveScissor);
+        Core->VkCore.SetViewport(*ActiveCommandBuffer, 0, 1, &Core->Renderer->ActiveViewport);
+    }
+    
+    Core->Renderer->IsRenderPassActive = true;
+    Core->Renderer->RenderPassContents = Contents;
+}
+
+void render_stats_add(render_stats *Dst, render_stats *Src)
+{
+    Dst->PipelineBinds            += Src->PipelineBinds;
+    Dst->PipelineBindsElided      += Src->PipelineBindsElided;
+    Dst->DescriptorSetBinds       += Src->DescriptorSetBinds;
+    Dst->DescriptorSetBindsElided += Src->DescriptorSetBindsElided;
+    Dst->VertexBufferBinds        += Src->VertexBufferBinds;
+    Dst->VertexBufferBindsElided  += Src->VertexBufferBindsElided;
+    Dst->IndexBufferBinds         += Src->IndexBufferBinds;
+    Dst->IndexBufferBindsElided   += Src->IndexBufferBindsElided;
+    Dst->Draws                    += Src->Draws;
+    Dst->Instances                += Src->Instances;
+    Dst->IndirectDraws            += Src->IndirectDraws;
+    Dst->StaticListsRecorded      += Src->StaticListsRecorded;
+    Dst->StaticListsReplayed      += Src->StaticListsReplayed;
+    Dst->TranslateNs              += Src->TranslateNs;
+    
+    for (u32 Type = 0; Type < CmdType_Count; ++Type)
+    {
+        Dst->Commands[Type].Recorded    += Src->Commands[Type].Recorded;
+        Dst->Commands[Type].Translated  += Src->Commands[Type].Translated;
+        Dst->Commands[Type].RecordNs    += Src->Commands[Type].RecordNs;
+        Dst->Commands[Type].TranslateNs += Src->Commands[Type].TranslateNs;
+    }
+}
+
+u64 renderer_clock_ns()
+{
+    auto Now = std::chrono::steady_clock::now().time_since_epoch();
+    return (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(Now).count();
+}
+
 void renderer_end_frame()
 {
+    // Nothing was recorded this frame, the pass still has to clear the image
+    renderer_begin_render_pass(VK_SUBPASS_CONTENTS_INLINE);
+    
     Core->VkCore.EndRenderPass(*Core->Renderer->ActiveCommandBuffer);
     Core->VkCore.EndCommandBuffer(*Core->Renderer->ActiveCommandBuffer);
+    transient_ring_flush();
     Core->VkCore.EndFrame(Core->Renderer->CurrentImageIndex, 
                           Core->Renderer->ActiveCommandBuffer, 1);
     
@@ -284,14 +358,19 @@ void renderer_end_frame()
 #endif
     
     Core->Renderer->ActiveCommandBuffer = NULL;
-    object_data_buffer_end_frame(&Core->Renderer->ObjectDataBuffer);
+    Core->Renderer->IsRenderPassActive  = false;
+    
+    render_stats_add(&Core->Renderer->FrameStats, &Core->Renderer->PrimaryContext.Stats);
+    Core->Renderer->LastFrameStats = Core->Renderer->FrameStats;
+    Core->Renderer->FrameStats     = {};
+    
+    // Transient allocations made during the frame before this one are no longer in use
+    frame_arena_reset(Platform->FrameArena);
 }
 
 
 void object_data_buffer_init(object_data_buffer *ObjectDataBuffer)
 {
-    u32 SwapChainImageCount = Core->VkCore.GetSwapChainImageCount();
-    
     // Create the Descriptor Layout
     VkDescriptorSetLayoutBinding Bindings[1]= {};
     Bindings[0].binding            = 0;
@@ -302,45 +381,23 @@ void object_data_buffer_init(object_data_buffer *ObjectDataBuffer)
     
     ObjectDataBuffer->DescriptorLayout = Core->VkCore.CreateDescriptorSetLayout(Bindings, 1);
     
-    // Create the Descriptor Sets
-    ObjectDataBuffer->DescriptorSets = (VkDescriptorSet*)memory_alloc(Core->Memory, 
-                                                                      sizeof(VkDescriptorSet) * SwapChainImageCount);
-    ObjectDataBuffer->DescriptorSetsCount = SwapChainImageCount;
-    
-    VkDescriptorSetLayout *Layouts = (VkDescriptorSetLayout*)memory_alloc(Core->Memory, 
-                                                                          sizeof(VkDescriptorSetLayout) * SwapChainImageCount);
-    for (u32 LayoutIdx = 0; LayoutIdx < SwapChainImageCount; ++LayoutIdx)
-        Layouts[LayoutIdx] = ObjectDataBuffer->DescriptorLayout;
-    
-    VkDescriptorSetAllocateInfo AllocInfo = {};
-    AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    AllocInfo.descriptorPool     = Core->Renderer->DescriptorPool;
-    AllocInfo.descriptorSetCount = SwapChainImageCount;
-    AllocInfo.pSetLayouts        = Layouts;
-    
-    Core->VkCore.CreateDescriptorSets(ObjectDataBuffer->DescriptorSets,
-                                      AllocInfo);
-    
-    memory_release(Core->Memory, Layouts);
-    
-    // HACK(Dustin): HARDCODING THE SIZE OF THE BUFFER. PROBABLY WANT
-    // TO ALLOW FOR THE PLATFORM TO SET THIS.
-    
-    u32 NumObjectsPerFrame = 20;
-    u32 SizePerObject = sizeof(object_data);
-    mp_dynamic_uniform_buffer_init(&ObjectDataBuffer->Buffer, NumObjectsPerFrame * SizePerObject);
-    
-    for (u32 i = 0; i < SwapChainImageCount; ++i) 
+    Bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    ObjectDataBuffer->InstanceLayout = Core->VkCore.CreateDescriptorSetLayout(Bindings, 1);
+}
+
+void object_data_buffer_write_sets(VkDescriptorSet *DescriptorSets, mp_dynamic_uniform_buffer *Buffer)
+{
+    for (u32 i = 0; i < Buffer->HandleCount; ++i) 
     {
         VkWriteDescriptorSet DescriptorWrites[1] = {};
         
         VkDescriptorBufferInfo FrameBufferInfo = {};
-        FrameBufferInfo.buffer                 = ObjectDataBuffer->Buffer.Handles[i].Handle;
+        FrameBufferInfo.buffer                 = Buffer->Handles[i].Handle;
         FrameBufferInfo.offset                 = 0;
         FrameBufferInfo.range                  = VK_WHOLE_SIZE;
         
         DescriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        DescriptorWrites[0].dstSet           = ObjectDataBuffer->DescriptorSets[i];
+        DescriptorWrites[0].dstSet           = DescriptorSets[i];
         DescriptorWrites[0].dstBinding       = 0;
         DescriptorWrites[0].dstArrayElement  = 0;
         DescriptorWrites[0].descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
@@ -356,21 +413,13 @@ void object_data_buffer_init(object_data_buffer *ObjectDataBuffer)
 void object_data_buffer_free(object_data_buffer *ObjectData)
 {
     Core->VkCore.DestroyDescriptorSetLayout(ObjectData->DescriptorLayout);
-    memory_release(Core->Memory, ObjectData->DescriptorSets);
-    ObjectData->DescriptorSetsCount = 0;
-    
-    mp_dynamic_uniform_buffer_free(&ObjectData->Buffer);
+    Core->VkCore.DestroyDescriptorSetLayout(ObjectData->InstanceLayout);
 }
 
 void object_data_buffer_begin_frame(object_data_buffer *ObjectDataBuffer)
 {
 }
 
-void object_data_buffer_end_frame(object_data_buffer *ObjectData)
-{
-    mp_dynamic_uniform_buffer_reset(&ObjectData->Buffer);
-}
-
 void object_data_buffer_update(object_data_buffer *ObjectData)
 {
 }
@@ -396,8 +445,7 @@ void global_shader_data_init(global_shader_data *ShaderData)
                                                                 sizeof(VkDescriptorSet) * SwapChainImageCount);
     ShaderData->DescriptorSetsCount = SwapChainImageCount;
     
-    VkDescriptorSetLayout *Layouts = (VkDescriptorSetLayout*)memory_alloc(Core->Memory, 
-                                                                          sizeof(VkDescriptorSetLayout) * SwapChainImageCount);
+    VkDescriptorSetLayout *Layouts = talloc<VkDescriptorSetLayout>(SwapChainImageCount);
     for (u32 LayoutIdx = 0; LayoutIdx < SwapChainImageCount; ++LayoutIdx)
         Layouts[LayoutIdx] = ShaderData->DescriptorLayout;
     
@@ -410,8 +458,6 @@ void global_shader_data_init(global_shader_data *ShaderData)
     Core->VkCore.CreateDescriptorSets(ShaderData->DescriptorSets,
                                       AllocInfo);
     
-    memory_release(Core->Memory, Layouts);
-    
     mp_uniform_buffer_init(&ShaderData->Buffer, sizeof(camera_data));
     
     for (u32 i = 0; i < SwapChainImageCount; ++i) 
@@ -8,14 +8,14 @@ typedef struct object_data
     quaternion Rotation;
 } object_data;
 
+// The per frame object data lives in the transient ring, see transient_ring.h.
+// Static command lists keep their own buffer that uses the same layout.
 typedef struct object_data_buffer
 {
     VkDescriptorSetLayout     DescriptorLayout;
-    
-    VkDescriptorSet          *DescriptorSets;
-    u32                       DescriptorSetsCount;
-    
-    mp_dynamic_uniform_buffer Buffer;
+    // Set 1 of instanced pipelines. A storage buffer of model matrices that the
+    // vertex shader indexes with gl_InstanceIndex.
+    VkDescriptorSetLayout     InstanceLayout;
 } object_data_buffer;
 
 typedef struct camera_data
@@ -34,6 +34,88 @@ typedef struct global_shader_data
     mp_uniform_buffer Buffer;
 } global_shader_data;
 
+#define MAX_BOUND_DESCRIPTOR_SETS 8
+
+// State bound on the active command buffer, so the command list translator can
+// drop binds that would not change anything. Cleared at the start of a frame.
+typedef struct bound_state
+{
+    VkPipeline       Pipeline;
+    VkPipelineLayout Layout;
+    VkDescriptorSet  DescriptorSets[MAX_BOUND_DESCRIPTOR_SETS];
+    u32              DynamicOffsets[MAX_BOUND_DESCRIPTOR_SETS];
+    VkBuffer         VertexBuffer;
+    VkBuffer         IndexBuffer;
+    VkIndexType      IndexType;
+} bound_state;
+
+// Longest run of draws merged into one instanced draw
+#define MAX_INSTANCES_PER_DRAW 256
+
+// Draws of the same render component on an instanced pipeline are collected here
+// and emitted as a single instanced draw once the run ends.
+typedef struct instance_batch
+{
+    render_component RenderComponent;
+    u32              Count;
+    mat4             Models[MAX_INSTANCES_PER_DRAW];
+} instance_batch;
+
+// Most objects covered by one indirect call
+#define MAX_INDIRECT_DRAWS 4096
+
+// Draws on indirect pipelines are collected here. Draws that read the same vertex
+// and index buffers form a run, and once the run ends its models and draw arguments
+// are written to the transient ring and the whole run is emitted with one indirect
+// call. Repeated draws of the same geometry share a single draw command.
+typedef struct indirect_batch
+{
+    VkBuffer                     VertexBuffer;
+    VkBuffer                     IndexBuffer;
+    VkIndexType                  IndexType;
+    bool                         IsIndexed;
+    
+    u32                          Count;        // models, one per draw
+    u32                          CommandCount;
+    mat4                         Models[MAX_INDIRECT_DRAWS];
+    // firstInstance is relative to the run's first model until the run is emitted.
+    // Non-indexed draws keep their vertex count in indexCount and their first
+    // vertex in vertexOffset.
+    VkDrawIndexedIndirectCommand Commands[MAX_INDIRECT_DRAWS];
+} indirect_batch;
+
+// Everything the command list translator tracks while recording into a single
+// command buffer. The renderer has one for the primary command buffer and every
+// render worker has its own, so lists can be translated on several threads.
+typedef struct translate_context
+{
+    VkCommandBuffer     CommandBuffer;
+    struct mp_pipeline *ActivePipeline;
+    bound_state         BoundState;
+    render_stats        Stats;        // merged into the frame stats at end_frame
+    
+    // Where object data commands write to. NULL for the transient ring, set to
+    // the list's own buffer while a static command list is recorded.
+    mp_dynamic_uniform_buffer *ObjectData;
+    VkDescriptorSet           *ObjectDataSets;
+    // Same for the models and indirect commands of instanced draws
+    struct mp_instance_buffer *InstanceBuffer;
+    
+    // Model matrices of the list being translated, composed before its first
+    // command is translated
+    mat4                      *Models;
+    
+    // Instanced and indirect pipelines only. The model of the last object data
+    // command, a draw before any object data uses a zero matrix.
+    mat4                       InstanceModel;
+    instance_batch             Instances;
+    indirect_batch             Indirect;
+    
+    // Set on the render workers' contexts, the camera commands of their lists
+    // were applied before the lists were handed out (see render_workers_translate)
+    bool                       CameraApplied;
+} translate_context;
+
 typedef struct renderer
 {
     //~ Render Settings
@@ -61,8 +143,18 @@ typedef struct renderer
     // Pre-Frame info
     u32                 CurrentImageIndex;
     VkCommandBuffer    *ActiveCommandBuffer;
-    struct mp_pipeline *ActivePipeline;
+    translate_context   PrimaryContext;
     camera_data         ActiveCamera;
+    VkViewport          ActiveViewport;
+    VkRect2D            ActiveScissor;
+    
+    // The render pass is begun by the first thing that records into it, so
+    // end_frame can still choose to fill it with secondary command buffers.
+    bool                IsRenderPassActive;
+    VkSubpassContents   RenderPassContents;
+    
+    render_stats        FrameStats;
+    render_stats        LastFrameStats;
     
     // For now, contains the View/Projection matrix
     // updated via "cmd_set_camera" function
@@ -77,12 +169,17 @@ void renderer_init(renderer *Renderer);
 void renderer_free(renderer *Renderer);
 u32 renderer_begin_frame();
 void renderer_end_frame();
+void renderer_begin_render_pass(VkSubpassContents Contents);
+void render_stats_add(render_stats *Dst, render_stats *Src);
+// Monotonic, used for the render stats timings
+u64 renderer_clock_ns();
 
 void object_data_buffer_init(object_data_buffer *ObjectData);
 void object_data_buffer_free(object_data_buffer *ObjectData);
 void object_data_buffer_begin_frame(object_data_buffer *ObjectData);
-void object_data_buffer_end_frame(object_data_buffer *ObjectData);
 void object_data_buffer_update(object_data_buffer *ObjectData);
+// Points one descriptor set per swapchain image at the matching buffer
+void object_data_buffer_write_sets(VkDescriptorSet *DescriptorSets, mp_dynamic_uniform_buffer *Buffer);
 
 void global_shader_data_init(global_shader_data *ShaderData);
 void global_shader_data_free(global_shader_data *ShaderData);
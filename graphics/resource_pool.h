@@ -0,0 +1,145 @@
+#ifndef GRAPHICS_RESOURCE_POOL_H
+#define GRAPHICS_RESOURCE_POOL_H
+
+// Fixed size pools for the gpu resources handed out through the graphics api.
+// The records of one resource type are stored contiguously and referenced
+// through 32 bit handles:
+//
+// | Generation (12) | Type (4) | Index + 1 (16) |
+//
+// A slot keeps the handle it was last handed out with, so a lookup is a single
+// compare that rejects released handles, handles of a recycled slot and handles
+// of a different resource type. 0 is never a valid handle.
+#define RESOURCE_HANDLE_INDEX_BITS      16
+#define RESOURCE_HANDLE_TYPE_BITS       4
+#define RESOURCE_HANDLE_GENERATION_BITS 12
+#define RESOURCE_POOL_MAX_CAPACITY      ((1 << RESOURCE_HANDLE_INDEX_BITS) - 1)
+
+typedef enum resource_type
+{
+    ResourceType_Invalid,
+    ResourceType_Pipeline,
+    ResourceType_RenderComponent,
+    ResourceType_UploadBuffer,
+    ResourceType_Image,
+    ResourceType_DescriptorLayout,
+    ResourceType_DescriptorSet,
+    
+    ResourceType_Count,
+} resource_type;
+
+typedef struct resource_slot
+{
+    u32 Handle;     // 0 while the slot is free
+    u16 Generation;
+    u16 Pad;
+    u32 NextFree;   // index + 1 of the next free slot
+} resource_slot;
+
+template<typename T>
+struct resource_pool
+{
+    T             *Resources;
+    resource_slot *Slots;
+    
+    u32            Capacity;
+    u32            SlotsTouched;
+    u32            FreeSlots;  // index + 1 of the first free slot
+    u32            Count;      // live resources
+    resource_type  Type;
+};
+
+template<typename T>
+void resource_pool_init(resource_pool<T> *Pool, resource_type Type, u32 Capacity)
+{
+    if (Capacity > RESOURCE_POOL_MAX_CAPACITY) Capacity = RESOURCE_POOL_MAX_CAPACITY;
+    
+    Pool->Resources    = palloc<T>(Capacity);
+    Pool->Slots        = palloc<resource_slot>(Capacity);
+    Pool->Capacity     = Capacity;
+    Pool->SlotsTouched = 0;
+    Pool->FreeSlots    = 0;
+    Pool->Count        = 0;
+    Pool->Type         = Type;
+}
+
+template<typename T>
+void resource_pool_free(resource_pool<T> *Pool)
+{
+    if (Pool->Count)
+    {
+        Platform->mprinte("Freeing a resource pool (type %d), but %d resources are still alive!\n", Pool->Type, Pool->Count);
+    }
+    
+    pfree(Pool->Resources);
+    pfree(Pool->Slots);
+    *Pool = {};
+}
+
+// Returns 0 when the pool is full. The record is zeroed.
+template<typename T>
+u32 resource_pool_alloc(resource_pool<T> *Pool, T **Resource)
+{
+    u32 Index;
+    if (Pool->FreeSlots)
+    {
+        Index = Pool->FreeSlots - 1;
+        Pool->FreeSlots = Pool->Slots[Index].NextFree;
+    }
+    else if (Pool->SlotsTouched < Pool->Capacity)
+    {
+        Index = Pool->SlotsTouched++;
+        Pool->Slots[Index].Generation = 0;
+    }
+    else
+    {
+        Platform->mprinte("Unable to create resource (type %d): all %d slots are in use!\n", Pool->Type, Pool->Capacity);
+        *Resource = NULL;
+        return 0;
+    }
+    
+    resource_slot *Slot = Pool->Slots + Index;
+    u32 Generation = Slot->Generation & ((1 << RESOURCE_HANDLE_GENERATION_BITS) - 1);
+    
+    Slot->Handle   = (Generation << (RESOURCE_HANDLE_INDEX_BITS + RESOURCE_HANDLE_TYPE_BITS)) |
+        ((u32)Pool->Type << RESOURCE_HANDLE_INDEX_BITS) | (Index + 1);
+    Slot->NextFree = 0;
+    
+    Pool->Count++;
+    
+    *Resource = Pool->Resources + Index;
+    memset(*Resource, 0, sizeof(T));
+    
+    return Slot->Handle;
+}
+
+// Returns NULL for 0, released, stale or mistyped handles
+template<typename T>
+T* resource_pool_get(resource_pool<T> *Pool, u32 Handle)
+{
+    u32 Index = (Handle & RESOURCE_POOL_MAX_CAPACITY) - 1;
+    if (Index < Pool->SlotsTouched && Pool->Slots[Index].Handle == Handle)
+    {
+        return Pool->Resources + Index;
+    }
+    
+    return NULL;
+}
+
+template<typename T>
+void resource_pool_release(resource_pool<T> *Pool, u32 Handle)
+{
+    if (!resource_pool_get(Pool, Handle)) return;
+    
+    u32 Index = (Handle & RESOURCE_POOL_MAX_CAPACITY) - 1;
+    
+    resource_slot *Slot = Pool->Slots + Index;
+    Slot->Handle     = 0;
+    Slot->Generation = Slot->Generation + 1;
+    Slot->NextFree   = Pool->FreeSlots;
+    Pool->FreeSlots  = Index + 1;
+    
+    Pool->Count--;
+}
+
+#endif //GRAPHICS_RESOURCE_POOL_H
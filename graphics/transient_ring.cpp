@@ -0,0 +1,252 @@
+
+typedef struct transient_page
+{
+    buffer_parameters Buffer;
+    VkDescriptorSet   ObjectDataSet;
+    VkDescriptorSet   InstanceDataSet;
+    std::atomic<u32>  Used;
+} transient_page;
+
+typedef struct transient_frame
+{
+    transient_page   *Pages[TRANSIENT_RING_MAX_PAGES];
+    u32               PageCount;   // created so far, only grows
+    std::atomic<u32>  CurrentPage; // being allocated from
+} transient_frame;
+
+typedef struct transient_ring
+{
+    transient_frame  Frames[sync_object_parameters::MAX_FRAMES];
+    u32              FrameIndex;
+    u32              UniformAlignment;
+    
+    // One object data and one instance data set per page
+    VkDescriptorPool DescriptorPool;
+    
+    // Taken when a frame moves on to its next page
+    std::mutex       Lock;
+} transient_ring;
+
+file_global transient_ring TransientRing;
+
+file_internal transient_page* transient_ring_create_page()
+{
+    transient_page *Page = palloc<transient_page>();
+    Page->Used.store(0);
+    
+    VkBufferCreateInfo create_info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    create_info.size  = TRANSIENT_RING_PAGE_SIZE;
+    create_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+    
+    VmaAllocationCreateInfo alloc_info = {};
+    alloc_info.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    alloc_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    
+    Core->VkCore.CreateVmaBuffer(create_info,
+                                 alloc_info,
+                                 Page->Buffer.Handle,
+                                 Page->Buffer.Memory,
+                                 Page->Buffer.AllocationInfo);
+    Page->Buffer.Size = TRANSIENT_RING_PAGE_SIZE;
+    
+    VkDescriptorSetLayout Layouts[2] = {
+        Core->Renderer->ObjectDataBuffer.DescriptorLayout,
+        Core->Renderer->ObjectDataBuffer.InstanceLayout,
+    };
+    VkDescriptorSet Sets[2];
+    
+    VkDescriptorSetAllocateInfo AllocInfo = {};
+    AllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    AllocInfo.descriptorPool     = TransientRing.DescriptorPool;
+    AllocInfo.descriptorSetCount = 2;
+    AllocInfo.pSetLayouts        = Layouts;
+    
+    Core->VkCore.CreateDescriptorSets(Sets, AllocInfo);
+    Page->ObjectDataSet   = Sets[0];
+    Page->InstanceDataSet = Sets[1];
+    
+    // NOTE(Dustin): The range is a single object, the dynamic offset selects it.
+    // The whole page would be larger than the uniform buffer range limit.
+    VkDescriptorBufferInfo BufferInfos[2] = {};
+    BufferInfos[0].buffer = Page->Buffer.Handle;
+    BufferInfos[0].offset = 0;
+    BufferInfos[0].range  = sizeof(mat4);
+    
+    BufferInfos[1].buffer = Page->Buffer.Handle;
+    BufferInfos[1].offset = 0;
+    BufferInfos[1].range  = VK_WHOLE_SIZE;
+    
+    VkWriteDescriptorSet DescriptorWrites[2] = {};
+    DescriptorWrites[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    DescriptorWrites[0].dstSet          = Page->ObjectDataSet;
+    DescriptorWrites[0].dstBinding      = 0;
+    DescriptorWrites[0].dstArrayElement = 0;
+    DescriptorWrites[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    DescriptorWrites[0].descriptorCount = 1;
+    DescriptorWrites[0].pBufferInfo     = &BufferInfos[0];
+    
+    DescriptorWrites[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    DescriptorWrites[1].dstSet          = Page->InstanceDataSet;
+    DescriptorWrites[1].dstBinding      = 0;
+    DescriptorWrites[1].dstArrayElement = 0;
+    DescriptorWrites[1].descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    DescriptorWrites[1].descriptorCount = 1;
+    DescriptorWrites[1].pBufferInfo     = &BufferInfos[1];
+    
+    Core->VkCore.UpdateDescriptorSets(DescriptorWrites, 2);
+    
+    return Page;
+}
+
+file_internal void transient_ring_free_page(transient_page *Page)
+{
+    // NOTE(Dustin): The descriptor set is freed with the pool
+    Core->VkCore.DestroyVmaBuffer(Page->Buffer.Handle, Page->Buffer.Memory);
+    pfree(Page);
+}
+
+// Moves the frame past a page that is full. Returns false when the frame can not
+// grow any further.
+file_internal bool transient_ring_next_page(transient_frame *Frame, u32 FullPage)
+{
+    std::unique_lock<std::mutex> Lock(TransientRing.Lock);
+    
+    // Another thread ran out of space at the same time and already moved on
+    if (Frame->CurrentPage.load(std::memory_order_acquire) != FullPage) return true;
+    
+    u32 NextPage = FullPage + 1;
+    if (NextPage == Frame->PageCount)
+    {
+        if (Frame->PageCount == TRANSIENT_RING_MAX_PAGES)
+        {
+            Platform->mprinte("The transient ring is out of pages (%d pages of %d bytes)!\n",
+                              TRANSIENT_RING_MAX_PAGES, TRANSIENT_RING_PAGE_SIZE);
+            return false;
+        }
+        
+        Frame->Pages[Frame->PageCount++] = transient_ring_create_page();
+    }
+    
+    // Publishes the new page along with the index
+    Frame->CurrentPage.store(NextPage, std::memory_order_release);
+    return true;
+}
+
+void transient_ring_init()
+{
+    TransientRing.FrameIndex       = 0;
+    TransientRing.UniformAlignment = (u32)Core->VkCore.GetMinUniformMemoryOffsetAlignment();
+    
+    u32 MaxPages = sync_object_parameters::MAX_FRAMES * TRANSIENT_RING_MAX_PAGES;
+    
+    VkDescriptorPoolSize PoolSizes[2] = {};
+    PoolSizes[0].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    PoolSizes[0].descriptorCount = MaxPages;
+    PoolSizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    PoolSizes[1].descriptorCount = MaxPages;
+    TransientRing.DescriptorPool = Core->VkCore.CreateDescriptorPool(PoolSizes, 2, MaxPages * 2, 0);
+    
+    // Every frame starts out with a single page
+    for (u32 FrameIdx = 0; FrameIdx < sync_object_parameters::MAX_FRAMES; ++FrameIdx)
+    {
+        transient_frame *Frame = TransientRing.Frames + FrameIdx;
+        Frame->Pages[0]  = transient_ring_create_page();
+        Frame->PageCount = 1;
+        Frame->CurrentPage.store(0);
+    }
+}
+
+void transient_ring_free()
+{
+    for (u32 FrameIdx = 0; FrameIdx < sync_object_parameters::MAX_FRAMES; ++FrameIdx)
+    {
+        transient_frame *Frame = TransientRing.Frames + FrameIdx;
+        for (u32 PageIdx = 0; PageIdx < Frame->PageCount; ++PageIdx)
+        {
+            transient_ring_free_page(Frame->Pages[PageIdx]);
+            Frame->Pages[PageIdx] = NULL;
+        }
+        
+        Frame->PageCount = 0;
+        Frame->CurrentPage.store(0);
+    }
+    
+    Core->VkCore.DestroyDescriptorPool(TransientRing.DescriptorPool);
+    TransientRing.DescriptorPool = VK_NULL_HANDLE;
+}
+
+void transient_ring_begin_frame(u32 FrameIndex)
+{
+    TransientRing.FrameIndex = FrameIndex;
+    
+    transient_frame *Frame = TransientRing.Frames + FrameIndex;
+    for (u32 PageIdx = 0; PageIdx < Frame->PageCount; ++PageIdx)
+    {
+        Frame->Pages[PageIdx]->Used.store(0, std::memory_order_relaxed);
+    }
+    Frame->CurrentPage.store(0, std::memory_order_release);
+}
+
+void transient_ring_flush()
+{
+    transient_frame *Frame = TransientRing.Frames + TransientRing.FrameIndex;
+    
+    u32 LastPage = Frame->CurrentPage.load(std::memory_order_acquire);
+    for (u32 PageIdx = 0; PageIdx <= LastPage; ++PageIdx)
+    {
+        transient_page *Page = Frame->Pages[PageIdx];
+        
+        u32 Used = Page->Used.load(std::memory_order_relaxed);
+        if (Used > TRANSIENT_RING_PAGE_SIZE) Used = TRANSIENT_RING_PAGE_SIZE;
+        
+        if (Used) Core->VkCore.VmaFlushAllocation(Page->Buffer.Memory, 0, Used);
+    }
+}
+
+transient_alloc transient_ring_alloc(u32 Size, u32 Alignment)
+{
+    transient_alloc Result = {};
+    
+    if (Size > TRANSIENT_RING_PAGE_SIZE)
+    {
+        Platform->mprinte("Transient allocation of %d bytes is larger than a page!\n", Size);
+        return Result;
+    }
+    
+    transient_frame *Frame = TransientRing.Frames + TransientRing.FrameIndex;
+    for (;;)
+    {
+        u32 PageIdx = Frame->CurrentPage.load(std::memory_order_acquire);
+        transient_page *Page = Frame->Pages[PageIdx];
+        
+        u32 Used = Page->Used.load(std::memory_order_relaxed);
+        u32 Offset, End;
+        do
+        {
+            Offset = memory_align(Used, Alignment);
+            End    = Offset + Size;
+            if (End > TRANSIENT_RING_PAGE_SIZE) break;
+        } while (!Page->Used.compare_exchange_weak(Used, End, std::memory_order_relaxed));
+        
+        if (End <= TRANSIENT_RING_PAGE_SIZE)
+        {
+            Result.Ptr             = (char*)Page->Buffer.AllocationInfo.pMappedData + Offset;
+            Result.Buffer          = Page->Buffer.Handle;
+            Result.Offset          = Offset;
+            Result.ObjectDataSet   = Page->ObjectDataSet;
+            Result.InstanceDataSet = Page->InstanceDataSet;
+            return Result;
+        }
+        
+        if (!transient_ring_next_page(Frame, PageIdx)) return Result;
+    }
+}
+
+transient_alloc transient_ring_alloc_uniform(void *Data, u32 Size)
+{
+    transient_alloc Result = transient_ring_alloc(Size, TransientRing.UniformAlignment);
+    if (Result.Ptr) memcpy(Result.Ptr, Data, Size);
+    
+    return Result;
+}
@@ -0,0 +1,45 @@
+#ifndef GRAPHICS_TRANSIENT_RING_H
+#define GRAPHICS_TRANSIENT_RING_H
+
+// Scratch gpu memory for data that only lives for one frame (object data,
+// dynamic vertices and indices, indirect draw arguments, ...). Every frame in flight owns a chain of
+// persistently mapped CPU_TO_GPU pages that is bump allocated from while the
+// frame is recorded. The chain is rewound once the frame's fence has signaled,
+// see transient_ring_begin_frame. A full page moves the frame on to its next
+// page, and a page is only created when the frame has none left, so every frame
+// settles at its high water mark instead of running out of space.
+//
+// Allocations may come from several render workers at once.
+#define TRANSIENT_RING_PAGE_SIZE  _MB(4)
+#define TRANSIENT_RING_MAX_PAGES  64   // per frame in flight
+
+// Valid until the frame it was made in has finished on the gpu
+typedef struct transient_alloc
+{
+    void            *Ptr;           // NULL when the allocation failed
+    VkBuffer         Buffer;
+    u32              Offset;        // into Buffer
+    
+    // Exposes the page as the dynamic object data uniform buffer (set 1), bind
+    // it with Offset as the dynamic offset
+    VkDescriptorSet  ObjectDataSet;
+    // Exposes the whole page as the instance data storage buffer (set 1 of
+    // instanced pipelines)
+    VkDescriptorSet  InstanceDataSet;
+} transient_alloc;
+
+// The object data and instance data descriptor layouts have to exist already
+void transient_ring_init();
+void transient_ring_free();
+
+// FrameIndex is the frame in flight, see sync_object_parameters. Must be called
+// after the frame's fence was waited on.
+void transient_ring_begin_frame(u32 FrameIndex);
+// Makes the frame's writes visible to the gpu, call before submitting
+void transient_ring_flush();
+
+transient_alloc transient_ring_alloc(u32 Size, u32 Alignment);
+// Copies Data to a fresh allocation aligned for use as a dynamic uniform buffer
+transient_alloc transient_ring_alloc_uniform(void *Data, u32 Size);
+
+#endif //GRAPHICS_TRANSIENT_RING_H
@@ -21,6 +21,9 @@
 //~ Memory Management
 
 #include "mm/memory.h"
+#include "mm/frame_arena.h"
+#include "mm/tagged_heap.h"
+#include "mm/compact_heap.h"
 
 //~ Util stuff
 
@@ -62,4 +65,7 @@
 //-------------------------------------------------------------------------------------------------------------------//
 
 #include "mm/memory.c"
+#include "mm/frame_arena.c"
+#include "mm/tagged_heap.c"
+#include "mm/compact_heap.c"
 #include "platform/platform_entry.c"
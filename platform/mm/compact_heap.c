@@ -0,0 +1,261 @@
+
+// Every block starts with a header, the object follows it. Holes left by released
+// objects keep their header with a Handle of 0.
+typedef struct compact_block
+{
+    u64            Size;     // including the header
+    compact_handle Handle;
+    u32            Reserved;
+} compact_block;
+
+#define COMPACT_BLOCK_HEADER_SIZE sizeof(compact_block)
+#define COMPACT_MIN_BLOCK_SIZE    (COMPACT_BLOCK_HEADER_SIZE + COMPACT_HEAP_ALIGNMENT)
+
+#define compact_handle_index(h)      (((h) & COMPACT_HEAP_MAX_HANDLES) - 1)
+#define compact_handle_generation(h) ((h) >> COMPACT_HEAP_INDEX_BITS)
+#define compact_generation_mask      ((1u << (32 - COMPACT_HEAP_INDEX_BITS)) - 1)
+
+void compact_heap_init(compact_heap *Heap, u64 Size, void *Ptr, u32 MaxHandles, pfn_compact_heap_clock Clock)
+{
+    if (MaxHandles > COMPACT_HEAP_MAX_HANDLES) MaxHandles = COMPACT_HEAP_MAX_HANDLES;
+    u64 TableSize = memory_align((u64)MaxHandles * sizeof(compact_heap_slot), COMPACT_HEAP_ALIGNMENT);
+    
+    memset(Heap, 0, sizeof(compact_heap));
+    Heap->Clock = Clock;
+    
+    if (!Ptr || TableSize >= Size)
+    {
+        return;
+    }
+    
+    Heap->Slots     = (compact_heap_slot*)Ptr;
+    Heap->SlotCount = MaxHandles;
+    
+    Heap->Start     = (char*)Ptr + TableSize;
+    Heap->Size      = (Size - TableSize) & ~((u64)COMPACT_HEAP_ALIGNMENT - 1);
+    Heap->Brkp      = Heap->Start;
+    Heap->Compacted = Heap->Start;
+}
+
+void compact_heap_free(compact_heap *Heap)
+{
+    if (Heap->UsedMemory)
+    {
+        printf("Freeing the Compact Heap, but %lld bytes are still in use.\n", Heap->UsedMemory);
+    }
+    
+    memset(Heap, 0, sizeof(compact_heap));
+}
+
+file_internal compact_heap_slot* compact_heap_slot_from_handle(compact_heap *Heap, compact_handle Handle)
+{
+    if (!Handle) return NULL;
+    
+    u32 Index = compact_handle_index(Handle);
+    if (Index >= Heap->SlotsTouched) return NULL;
+    
+    compact_heap_slot *Slot = Heap->Slots + Index;
+    if (!Slot->Ptr || (Slot->Generation & compact_generation_mask) != compact_handle_generation(Handle))
+    {
+        return NULL;
+    }
+    
+    return Slot;
+}
+
+// First fit over the holes above the compacted prefix. Neighbouring holes are
+// merged on the way, and a run of holes that reaches the break pointer is handed
+// back to it.
+file_internal compact_block* compact_heap_find_hole(compact_heap *Heap, u64 Size)
+{
+    char *Ptr = Heap->Compacted;
+    while (Ptr < Heap->Brkp)
+    {
+        compact_block *Block = (compact_block*)Ptr;
+        if (!Block->Handle)
+        {
+            char *Next = Ptr + Block->Size;
+            while (Next < Heap->Brkp && !((compact_block*)Next)->Handle)
+            {
+                Block->Size += ((compact_block*)Next)->Size;
+                Next = Ptr + Block->Size;
+            }
+            
+            if (Next >= Heap->Brkp)
+            {
+                Heap->Brkp = Ptr;
+                return NULL;
+            }
+            
+            if (Block->Size >= Size)
+            {
+                if (Block->Size - Size >= COMPACT_MIN_BLOCK_SIZE)
+                {
+                    compact_block *Rest = (compact_block*)(Ptr + Size);
+                    Rest->Size   = Block->Size - Size;
+                    Rest->Handle = 0;
+                    
+                    Block->Size = Size;
+                }
+                
+                return Block;
+            }
+        }
+        
+        Ptr += Block->Size;
+    }
+    
+    return NULL;
+}
+
+compact_handle compact_heap_alloc(compact_heap *Heap, u64 Size)
+{
+    if (!Heap->Start || Size == 0) return 0;
+    
+    if (!Heap->FreeSlots && Heap->SlotsTouched == Heap->SlotCount)
+    {
+        // TODO(Dustin): Log
+        printf("Unable to allocate from the Compact Heap: all %d handles are in use!\n", Heap->SlotCount);
+        return 0;
+    }
+    
+    u64 BlockSize = memory_align(Size + COMPACT_BLOCK_HEADER_SIZE, COMPACT_HEAP_ALIGNMENT);
+    char *End     = Heap->Start + Heap->Size;
+    
+    // Bump allocate while there is room and leave the holes to the defragmenter,
+    // only search the holes once the heap is full
+    compact_block *Block = NULL;
+    if (Heap->Brkp + BlockSize > End)
+    {
+        Block = compact_heap_find_hole(Heap, BlockSize);
+    }
+    
+    if (!Block)
+    {
+        if (Heap->Brkp + BlockSize > End)
+        {
+            // TODO(Dustin): Log
+            printf("Unable to allocate %lld bytes from the Compact Heap: not enough memory!\n", Size);
+            return 0;
+        }
+        
+        Block = (compact_block*)Heap->Brkp;
+        Block->Size = BlockSize;
+        Heap->Brkp += BlockSize;
+    }
+    
+    u32 Index;
+    if (Heap->FreeSlots)
+    {
+        Index = Heap->FreeSlots - 1;
+        Heap->FreeSlots = Heap->Slots[Index].NextFree;
+    }
+    else
+    {
+        Index = Heap->SlotsTouched++;
+        Heap->Slots[Index].Generation = 0;
+    }
+    
+    compact_heap_slot *Slot = Heap->Slots + Index;
+    Slot->Ptr      = (char*)Block + COMPACT_BLOCK_HEADER_SIZE;
+    Slot->NextFree = 0;
+    
+    compact_handle Handle = ((Slot->Generation & compact_generation_mask) << COMPACT_HEAP_INDEX_BITS) | (Index + 1);
+    Block->Handle = Handle;
+    
+    Heap->UsedMemory += Block->Size;
+    
+    return Handle;
+}
+
+void compact_heap_release(compact_heap *Heap, compact_handle Handle)
+{
+    compact_heap_slot *Slot = compact_heap_slot_from_handle(Heap, Handle);
+    if (!Slot) return;
+    
+    compact_block *Block = (compact_block*)((char*)Slot->Ptr - COMPACT_BLOCK_HEADER_SIZE);
+    Block->Handle = 0;
+    Heap->UsedMemory -= Block->Size;
+    
+    if ((char*)Block + Block->Size == Heap->Brkp)
+    {
+        Heap->Brkp = (char*)Block;
+    }
+    
+    if ((char*)Block < Heap->Compacted)
+    {
+        Heap->Compacted = (char*)Block;
+    }
+    
+    Slot->Ptr        = NULL;
+    Slot->Generation = Slot->Generation + 1;
+    Slot->NextFree   = Heap->FreeSlots;
+    Heap->FreeSlots  = compact_handle_index(Handle) + 1;
+}
+
+void* compact_heap_get(compact_heap *Heap, compact_handle Handle)
+{
+    compact_heap_slot *Slot = compact_heap_slot_from_handle(Heap, Handle);
+    return (Slot) ? Slot->Ptr : NULL;
+}
+
+u64 compact_heap_defragment(compact_heap *Heap, u64 Deadline)
+{
+    u64 Moved = 0;
+    
+    // Slide live blocks from Src down to Dst. Everything below Dst is packed,
+    // everything between Dst and Src is free.
+    char *Dst = Heap->Compacted;
+    char *Src = Dst;
+    
+    while (Src < Heap->Brkp)
+    {
+        compact_block *Block = (compact_block*)Src;
+        u64 BlockSize = Block->Size;
+        
+        if (Block->Handle)
+        {
+            if (Src != Dst)
+            {
+                if (Deadline != ~0ULL && Heap->Clock() >= Deadline)
+                {
+                    break;
+                }
+                
+                compact_handle Handle = Block->Handle;
+                memmove(Dst, Src, BlockSize);
+                Heap->Slots[compact_handle_index(Handle)].Ptr = Dst + COMPACT_BLOCK_HEADER_SIZE;
+                
+                Moved += BlockSize;
+            }
+            
+            Dst += BlockSize;
+        }
+        
+        Src += BlockSize;
+    }
+    
+    if (Src >= Heap->Brkp)
+    {
+        // Reached the end, all the free space is now in one piece after the break pointer
+        Heap->Brkp = Dst;
+    }
+    else if (Src != Dst)
+    {
+        // Out of time, the space that was freed up so far becomes a single hole
+        compact_block *Hole = (compact_block*)Dst;
+        Hole->Size   = Src - Dst;
+        Hole->Handle = 0;
+    }
+    
+    Heap->Compacted   = Dst;
+    Heap->BytesMoved += Moved;
+    
+    return Moved;
+}
+
+#undef compact_generation_mask
+#undef compact_handle_generation
+#undef compact_handle_index
+#undef COMPACT_MIN_BLOCK_SIZE
+#undef COMPACT_BLOCK_HEADER_SIZE
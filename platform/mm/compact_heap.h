@@ -0,0 +1,64 @@
+#ifndef ENGINE_MM_COMPACT_HEAP_H
+#define ENGINE_MM_COMPACT_HEAP_H
+
+// Relocatable heap for long lived data that churns (strings, asset metadata,
+// descriptor arrays, ...). Objects are referenced through handles instead of
+// pointers, so compact_heap_defragment can slide live objects down over the
+// holes left by released ones. Defragmenting is incremental: each call moves
+// objects until a deadline and picks up where it left off on the next call, so
+// it can run for a small slice of every frame.
+//
+// NOTE(Dustin): Pointers returned by compact_heap_get are only valid until the
+// next call to compact_heap_defragment. The heap is not thread safe.
+#define COMPACT_HEAP_ALIGNMENT  16
+#define COMPACT_HEAP_INDEX_BITS 20
+#define COMPACT_HEAP_MAX_HANDLES ((1 << COMPACT_HEAP_INDEX_BITS) - 1)
+
+// Low COMPACT_HEAP_INDEX_BITS bits are the slot index + 1, the rest is the slot's
+// generation so stale handles are detected. 0 is never a valid handle.
+typedef u32 compact_handle;
+
+// Returns the current time, the defragmenter stops once it passes the deadline
+typedef u64 (*pfn_compact_heap_clock)(void);
+
+typedef struct compact_heap_slot
+{
+    void *Ptr;        // NULL when the slot is free
+    u32   Generation;
+    u32   NextFree;   // index + 1 of the next free slot
+} compact_heap_slot;
+
+typedef struct compact_heap
+{
+    u64   Size;
+    char *Start;      // first block, the slot table is stored in front of it
+    char *Brkp;
+    
+    // Everything below Compacted is densely packed. Holes only exist above it.
+    char *Compacted;
+    
+    compact_heap_slot *Slots;
+    u32                SlotCount;
+    u32                SlotsTouched;
+    u32                FreeSlots;  // index + 1 of the first free slot
+    
+    u64   UsedMemory;     // bytes in live blocks, including block headers
+    u64   BytesMoved;     // total moved by the defragmenter
+    
+    pfn_compact_heap_clock Clock;
+} compact_heap;
+
+// MaxHandles slots are carved from the front of the memory
+void compact_heap_init(compact_heap *Heap, u64 Size, void *Ptr, u32 MaxHandles, pfn_compact_heap_clock Clock);
+void compact_heap_free(compact_heap *Heap);
+
+compact_handle compact_heap_alloc(compact_heap *Heap, u64 Size);
+void compact_heap_release(compact_heap *Heap, compact_handle Handle);
+// Returns NULL for released or stale handles
+void* compact_heap_get(compact_heap *Heap, compact_handle Handle);
+
+// Moves live blocks over holes until Deadline (in Clock units) has passed. Pass
+// ~0ULL to compact the whole heap. Returns the number of bytes moved.
+u64 compact_heap_defragment(compact_heap *Heap, u64 Deadline);
+
+#endif //ENGINE_MM_COMPACT_HEAP_H
@@ -0,0 +1,63 @@
+
+void frame_arena_init(frame_arena *Arena, u64 SizePerFrame, void *Ptr)
+{
+    assert(SizePerFrame % FRAME_ARENA_ALIGNMENT == 0);
+    
+    Arena->SizePerFrame = (Ptr) ? SizePerFrame : 0;
+    Arena->Start        = Ptr;
+    Arena->FrameIndex   = 0;
+    Arena->Offset       = 0;
+    Arena->HighWater    = 0;
+    
+    for (u32 FrameIdx = 0; FrameIdx < FRAME_ARENA_FRAME_COUNT; ++FrameIdx)
+    {
+        Arena->Regions[FrameIdx] = (Ptr) ? (char*)Ptr + FrameIdx * SizePerFrame : NULL;
+    }
+}
+
+void frame_arena_free(frame_arena *Arena)
+{
+    Arena->SizePerFrame = 0;
+    Arena->Start        = NULL;
+    Arena->FrameIndex   = 0;
+    Arena->Offset       = 0;
+    Arena->HighWater    = 0;
+    
+    for (u32 FrameIdx = 0; FrameIdx < FRAME_ARENA_FRAME_COUNT; ++FrameIdx)
+    {
+        Arena->Regions[FrameIdx] = NULL;
+    }
+}
+
+void* frame_arena_alloc(frame_arena *Arena, u64 Size)
+{
+    if (Size == 0) return NULL;
+    
+    void *Result = NULL;
+    
+    u64 Offset = memory_align(Arena->Offset, FRAME_ARENA_ALIGNMENT);
+    if (Offset + Size <= Arena->SizePerFrame)
+    {
+        Result = Arena->Regions[Arena->FrameIndex] + Offset;
+        Arena->Offset = Offset + Size;
+        
+        if (Arena->Offset > Arena->HighWater)
+        {
+            Arena->HighWater = Arena->Offset;
+        }
+    }
+    else
+    {
+        // TODO(Dustin): Log
+        printf("Frame arena is out of memory! Requested %lld bytes with %lld bytes left.\n",
+               Size, Arena->SizePerFrame - Arena->Offset);
+    }
+    
+    return Result;
+}
+
+void frame_arena_reset(frame_arena *Arena)
+{
+    Arena->FrameIndex = (Arena->FrameIndex + 1) % FRAME_ARENA_FRAME_COUNT;
+    Arena->Offset     = 0;
+}
@@ -0,0 +1,31 @@
+#ifndef ENGINE_MM_FRAME_ARENA_H
+#define ENGINE_MM_FRAME_ARENA_H
+
+// Bump allocator for per-frame transient memory. The arena is split into one region
+// per frame in flight. Allocations are made from the current region and are never
+// individually freed. frame_arena_reset moves to the next region and clears it, so
+// memory handed out during a frame stays valid until the end of the following frame.
+#define FRAME_ARENA_FRAME_COUNT 2
+#define FRAME_ARENA_ALIGNMENT   16
+
+typedef struct frame_arena
+{
+    u64   SizePerFrame;
+    void *Start;
+    
+    u32   FrameIndex;
+    char *Regions[FRAME_ARENA_FRAME_COUNT];
+    u64   Offset;
+    
+    // Largest Offset reached by any frame. Useful for tuning SizePerFrame.
+    u64   HighWater;
+} frame_arena;
+
+// Ptr must point to at least SizePerFrame * FRAME_ARENA_FRAME_COUNT bytes
+void frame_arena_init(frame_arena *Arena, u64 SizePerFrame, void *Ptr);
+void frame_arena_free(frame_arena *Arena);
+
+void* frame_arena_alloc(frame_arena *Arena, u64 Size);
+void frame_arena_reset(frame_arena *Arena);
+
+#endif //ENGINE_MM_FRAME_ARENA_H
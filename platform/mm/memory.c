@@ -3,30 +3,230 @@
 #define HEADER_SIZE      BLOCK_SIZE
 #define MIN_HEADER_SIZE  sizeof(void*)
 #define LIST_HEADER_SIZE 2*MIN_HEADER_SIZE
+#define FOOTER_SIZE      sizeof(u64)
+// A free block has to hold the list links and the footer
+#define MIN_BLOCK_SIZE   (LIST_HEADER_SIZE + FOOTER_SIZE)
 
 #define mem_align(n)            ((n) + BLOCK_SIZE - 1) & ~(BLOCK_SIZE - 1)
-#define header_adjusted_size(n) (MIN_HEADER_SIZE + (((n) >= LIST_HEADER_SIZE) ? (n) : LIST_HEADER_SIZE))
-#define header_to_mem(h)        (void*)((char*)(h) + MIN_HEADER_SIZE)
-#define mem_to_header(p)        (header_t)((char*)(p) - MIN_HEADER_SIZE)
+#define header_adjusted_size(n) (MIN_HEADER_SIZE + (((n) >= MIN_BLOCK_SIZE) ? (n) : MIN_BLOCK_SIZE))
+#define header_to_mem(h)        ((void*)((char*)(h) + MIN_HEADER_SIZE))
+#define mem_to_header(p)        ((header_t)((char*)(p) - MIN_HEADER_SIZE))
+#define header_next_phys(h)     (header_t)((char*)(h) + header_adjusted_size((h)->Size))
+// Only valid when the previous block is free (PrevUsed == 0). The footer of the
+// previous block sits right before this header.
+#define header_prev_phys(h)     (header_t)((char*)(h) - *((u64*)(h) - 1) - MIN_HEADER_SIZE)
+#define header_footer(h)        (u64*)((char*)header_to_mem(h) + (h)->Size - FOOTER_SIZE)
 
+#define SMALL_BLOCK_SIZE        (1ULL << MEMORY_FL_INDEX_SHIFT)
+
+// Committed granules past the break pointer before trailing pages are decommitted
+#define MEMORY_DECOMMIT_SLACK   4
+
+// Boundary tags: every block records whether the block physically before it is
+// in use. Free blocks additionally store their size in a footer (last 8 bytes of
+// the block), so a free left neighbour can be found from the header in O(1).
+//
+// Used blocks do not carry a footer, the space is returned to the user.
+//
+// Cache is the 1-based index of the thread cache that owns the block, 0 when the
+// block belongs to the shared heap. Tag is the memory_tag the block is accounted to.
+//
+// The fields are kept out of a shared bitfield on purpose. PrevUsed is written
+// under the heap lock when the neighbour before the block is allocated or freed,
+// while the owner of the block reads Size and Cache without the lock in
+// memory_release/memory_cache_release. As separate bytes those are different
+// memory locations, as bits of one word every PrevUsed write would be a
+// read-modify-write of the word the owner is reading.
 typedef struct header
 {
-    u64 Size:63;
-    u64 Used:1;
+    u32 Size; // heaps are limited to 4GB, see memory_init
+    u8  Tag;
+    u8  Cache;
+    u8  Used;
+    u8  PrevUsed;
     
     header_t Next;
     header_t Prev;
 } header;
 
-file_internal header_t memory_find_free_header(header_t* FreeList, u64 Size);
-file_internal void memory_free_list_add(header_t *FreeList, header_t Header);
-file_internal void memory_free_list_remove(header_t* FreeList, header_t HeaderToRemove);
-file_internal header_t memory_block_split(header_t* FreeList, header_t Header, u64 Size);
-file_internal void memory_block_coalesce(header_t LeftHeader, header_t RightHeader);
+//~ Bit scanning and atomic helpers. Cannot rely on the Platform functions since
+// this file is compiled into the platform layer and the dlls.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+// volatile reads have acquire semantics with msvc
+#define memory_atomic_load(Src)                 (*(Src))
+#define memory_atomic_exchange_32(Dst, Value)   _InterlockedExchange((volatile long*)(Dst), (Value))
+#define memory_atomic_exchange_ptr(Dst, Value)  _InterlockedExchangePointer((void* volatile*)(Dst), (Value))
+#define memory_atomic_cas_ptr(Dst, Value, Cmp)  _InterlockedCompareExchangePointer((void* volatile*)(Dst), (Value), (Cmp))
+#define memory_cpu_relax()                      _mm_pause()
+#define memory_timestamp()                      __rdtsc()
+
+file_internal u32 memory_ffs(u64 Value)
+{
+    unsigned long Index = 0;
+    _BitScanForward64(&Index, Value);
+    return (u32)Index;
+}
+
+file_internal u32 memory_fls(u64 Value)
+{
+    unsigned long Index = 0;
+    _BitScanReverse64(&Index, Value);
+    return (u32)Index;
+}
+
+#else
+
+#define memory_atomic_load(Src)                 __atomic_load_n((Src), __ATOMIC_ACQUIRE)
+#define memory_atomic_exchange_32(Dst, Value)   __atomic_exchange_n((Dst), (Value), __ATOMIC_ACQ_REL)
+#define memory_atomic_exchange_ptr(Dst, Value)  __atomic_exchange_n((Dst), (Value), __ATOMIC_ACQ_REL)
+#define memory_atomic_cas_ptr(Dst, Value, Cmp)  __sync_val_compare_and_swap((Dst), (Cmp), (Value))
+#define memory_cpu_relax()                      __builtin_ia32_pause()
+#define memory_timestamp()                      __builtin_ia32_rdtsc()
+
+file_internal u32 memory_ffs(u64 Value)
+{
+    return (u32)__builtin_ctzll(Value);
+}
+
+file_internal u32 memory_fls(u64 Value)
+{
+    return 63 - (u32)__builtin_clzll(Value);
+}
+
+#endif
+
+file_internal void memory_mapping_insert(u64 Size, u32 *Fl, u32 *Sl);
+file_internal void memory_mapping_search(u64 Size, u32 *Fl, u32 *Sl);
+file_internal header_t memory_find_free_header(memory *Memory, u64 Size);
+file_internal void memory_free_list_add(memory *Memory, header_t Header);
+file_internal void memory_free_list_remove(memory *Memory, header_t HeaderToRemove);
+file_internal header_t memory_block_split(memory *Memory, header_t Header, u64 Size);
+file_internal void memory_block_release(memory *Memory, header_t Header);
+file_internal void* memory_heap_alloc(memory *Memory, u64 Size, memory_tag Tag);
+file_internal void* memory_heap_alloc_aligned(memory *Memory, u64 Size, u64 Align, memory_tag Tag);
+file_internal void* memory_heap_realloc(memory *Memory, void *Ptr, u64 Size, u64 Align, memory_tag Tag);
+file_internal void memory_heap_release(memory *Memory, void *Ptr);
+file_internal void memory_cache_push_remote(memory_thread_cache *Cache, void *Ptr);
+
+//~ The shared heap is guarded by a spin lock. Thread caches only take it when
+// refilling or flushing a magazine.
+
+file_internal void memory_lock(memory *Memory)
+{
+    while (memory_atomic_exchange_32(&Memory->Lock, 1))
+    {
+        while (memory_atomic_load(&Memory->Lock)) memory_cpu_relax();
+    }
+}
+
+file_internal void memory_unlock(memory *Memory)
+{
+    memory_atomic_exchange_32(&Memory->Lock, 0);
+}
+
+//~ Allocation tracing
+
+file_internal void memory_trace_flush(memory_trace *Trace, bool Close)
+{
+    if (Trace->Count)
+    {
+        fwrite(Trace->Records, sizeof(memory_trace_record), Trace->Count, Trace->File);
+        Trace->Count = 0;
+    }
+    
+    if (Close)
+    {
+        fclose(Trace->File);
+        Trace->File = NULL;
+    }
+}
+
+bool memory_trace_begin(memory *Memory, memory_trace *Trace, const char *Filename)
+{
+    FILE *File = fopen(Filename, "wb");
+    if (!File)
+    {
+        printf("Unable to open the memory trace file \"%s\"!\n", Filename);
+        return false;
+    }
+    
+    memory_trace_file_header Header = {0};
+    Header.Magic      = MEMORY_TRACE_MAGIC;
+    Header.Version    = MEMORY_TRACE_VERSION;
+    Header.RecordSize = sizeof(memory_trace_record);
+    fwrite(&Header, sizeof(Header), 1, File);
+    
+    Trace->File  = File;
+    Trace->Flush = memory_trace_flush;
+    Trace->Count = 0;
+    
+    memory_lock(Memory);
+    Memory->Trace = Trace;
+    memory_unlock(Memory);
+    
+    return true;
+}
+
+void memory_trace_end(memory *Memory)
+{
+    memory_lock(Memory);
+    memory_trace *Trace = Memory->Trace;
+    Memory->Trace = NULL;
+    memory_unlock(Memory);
+    
+    if (Trace)
+    {
+        Trace->Flush(Trace, true);
+    }
+}
+
+#if defined(MEMORY_TRACE)
+
+// Heap lock must be held
+file_internal void memory_trace_append(memory *Memory, memory_trace_op Op, u32 Tag, u64 Size, void *Id, void *OldId)
+{
+    memory_trace *Trace = Memory->Trace;
+    if (!Trace) return;
+    
+    memory_trace_record *Record = Trace->Records + Trace->Count++;
+    Record->Timestamp = memory_timestamp();
+    Record->Id        = (u64)(uptr)Id;
+    Record->OldId     = (u64)(uptr)OldId;
+    Record->Size      = Size;
+    Record->Tag       = Tag;
+    Record->Op        = Op;
+    
+    if (Trace->Count == MEMORY_TRACE_BUFFER_COUNT)
+    {
+        Trace->Flush(Trace, false);
+    }
+}
+
+// For the thread cache paths that do not hold the heap lock
+file_internal void memory_trace_append_sync(memory *Memory, memory_trace_op Op, u32 Tag, u64 Size, void *Id, void *OldId)
+{
+    if (!memory_atomic_load(&Memory->Trace)) return;
+    
+    memory_lock(Memory);
+    memory_trace_append(Memory, Op, Tag, Size, Id, OldId);
+    memory_unlock(Memory);
+}
+
+#else
+
+#define memory_trace_append(...)
+#define memory_trace_append_sync(...)
+
+#endif
 
 void memory_init(memory *Memory, u64 Size, void *Ptr)
 {
     assert(Size % BLOCK_SIZE == 0);
+    // Block sizes are stored in 32 bits
+    assert(Size <= 0xFFFFFFFFULL - (BLOCK_SIZE - 1));
     Memory->Size = Size;
     
     if (!Ptr)
@@ -35,192 +235,280 @@ void memory_init(memory *Memory, u64 Size, void *Ptr)
     }
     else
     {
-        Memory->Start          = Ptr;
-        Memory->Brkp           = Memory->Start;
-        Memory->FreeList       = NULL;
+        Memory->Start             = Ptr;
+        Memory->Brkp              = Memory->Start;
+        Memory->Committed         = (char*)Memory->Start + Size;
+        Memory->Commit            = NULL;
+        Memory->Decommit          = NULL;
+        Memory->CommitGranularity = 0;
+        Memory->Trace             = NULL;
+        Memory->FlBitmap          = 0;
+        Memory->Lock           = 0;
         Memory->UsedMemory     = 0;
         Memory->NumAllocations = 0;
+        
+        memset(Memory->SlBitmap, 0, sizeof(Memory->SlBitmap));
+        memset(Memory->FreeLists, 0, sizeof(Memory->FreeLists));
+        memset(Memory->Caches, 0, sizeof(Memory->Caches));
+        memset(Memory->TagStats, 0, sizeof(Memory->TagStats));
+    }
+}
+
+void memory_init_reserved(memory *Memory, u64 Size, void *Ptr,
+                          pfn_memory_commit Commit, pfn_memory_decommit Decommit, u64 CommitGranularity)
+{
+    assert(CommitGranularity > 0 && CommitGranularity % BLOCK_SIZE == 0);
+    memory_init(Memory, Size, Ptr);
+    
+    if (Ptr)
+    {
+        Memory->Committed         = Memory->Start;
+        Memory->Commit            = Commit;
+        Memory->Decommit          = Decommit;
+        Memory->CommitGranularity = CommitGranularity;
     }
 }
 
 void memory_free(memory *Memory)
 {
+    if (Memory->Trace)
+    {
+        memory_trace_end(Memory);
+    }
+    
     if (Memory->UsedMemory != 0 || Memory->NumAllocations != 0)
     {
         printf("Freeing Free List allocator, but not all memory has been freed. There are still %lld allocations with %lld used memory.\n",
                Memory->NumAllocations, Memory->UsedMemory);
+        
+        for (u32 Tag = 0; Tag < MemoryTag_Count; ++Tag)
+        {
+            memory_tag_stats *Stats = Memory->TagStats + Tag;
+            if (Stats->LiveAllocations)
+            {
+                printf("    %s: %lld allocations with %lld bytes\n", memory_tag_name((memory_tag)Tag),
+                       Stats->LiveAllocations, Stats->LiveBytes);
+            }
+        }
     }
     
-    Memory->Start          = NULL;
-    Memory->Brkp           = NULL;
-    Memory->FreeList       = NULL;
+    Memory->Start             = NULL;
+    Memory->Brkp              = NULL;
+    Memory->Committed         = NULL;
+    Memory->Commit            = NULL;
+    Memory->Decommit          = NULL;
+    Memory->CommitGranularity = 0;
+    Memory->Trace             = NULL;
+    Memory->FlBitmap          = 0;
+    Memory->Lock           = 0;
     Memory->Size           = 0;
     Memory->UsedMemory     = 0;
     Memory->NumAllocations = 0;
+    
+    memset(Memory->SlBitmap, 0, sizeof(Memory->SlBitmap));
+    memset(Memory->FreeLists, 0, sizeof(Memory->FreeLists));
+    memset(Memory->Caches, 0, sizeof(Memory->Caches));
+    memset(Memory->TagStats, 0, sizeof(Memory->TagStats));
 }
 
-file_internal header_t memory_find_free_header(header_t* FreeList, u64 Size)
+// Maps a block size to the size class it is stored in. Sizes below SMALL_BLOCK_SIZE
+// are split linearly into the first level, everything else is split by the power of
+// two (first level) and then linearly within that power of two (second level).
+file_internal void memory_mapping_insert(u64 Size, u32 *Fl, u32 *Sl)
 {
-    header_t Iter = *FreeList;
-    
-    // Simple first-fit search
-    while (Iter != NULL)
+    if (Size < SMALL_BLOCK_SIZE)
     {
-        if (!Iter->Used && Size <= Iter->Size)
-        {
-            break;
-        }
-        
-        Iter = Iter->Next;
+        *Fl = 0;
+        *Sl = (u32)(Size / (SMALL_BLOCK_SIZE / MEMORY_SL_INDEX_COUNT));
     }
-    
-    if (Iter)
+    else
     {
-        memory_free_list_remove(FreeList, Iter);
+        u32 Log2 = memory_fls(Size);
+        *Sl = (u32)(Size >> (Log2 - MEMORY_SL_INDEX_COUNT_LOG2)) ^ (1 << MEMORY_SL_INDEX_COUNT_LOG2);
+        *Fl = Log2 - (MEMORY_FL_INDEX_SHIFT - 1);
     }
-    
-    return Iter;
 }
 
-file_internal void memory_block_coalesce(header_t LeftHeader, header_t RightHeader)
+// Same as memory_mapping_insert, but rounds the size up to the next size class so that
+// any block found in the resulting list is guarenteed to be large enough.
+file_internal void memory_mapping_search(u64 Size, u32 *Fl, u32 *Sl)
 {
-    if (!LeftHeader || !RightHeader)
-        return;
-    
-    // i arbitrarily decided that h1 will be the header
-    // that is kept.
-    if (LeftHeader < RightHeader)
+    if (Size >= SMALL_BLOCK_SIZE)
     {
-        LeftHeader->Next = RightHeader->Next;
-        if (RightHeader->Next) RightHeader->Next->Prev = LeftHeader;
+        u64 Round = (1ULL << (memory_fls(Size) - MEMORY_SL_INDEX_COUNT_LOG2)) - 1;
+        Size += Round;
     }
-    else
+    
+    memory_mapping_insert(Size, Fl, Sl);
+}
+
+file_internal header_t memory_find_free_header(memory *Memory, u64 Size)
+{
+    u32 Fl, Sl;
+    memory_mapping_search(Size, &Fl, &Sl);
+    
+    if (Fl >= MEMORY_FL_INDEX_COUNT)
+        return NULL;
+    
+    // First look for a non-empty list in the same first level class
+    u32 SlMap = Memory->SlBitmap[Fl] & (~0U << Sl);
+    if (!SlMap)
     {
-        LeftHeader->Prev = RightHeader->Prev;
-        if (RightHeader->Prev) RightHeader->Prev->Next = LeftHeader;
+        // None available, move up to the next non-empty first level class
+        u64 FlMap = (Fl + 1 < 64) ? Memory->FlBitmap & (~0ULL << (Fl + 1)) : 0;
+        if (!FlMap)
+            return NULL;
+        
+        Fl    = memory_ffs(FlMap);
+        SlMap = Memory->SlBitmap[Fl];
     }
     
-    // h1_sz + h2_sz will result in the TOTAL memory retrieved.
-    // in reality, the memory that can be used is dependent on its
-    // size. Looks something like:
-    // TOTAL MEMORY = HEADER 1 + H1_SZ + HEADER 2 + H2SZ
-    //
-    // However, [HEADER 1] will be reserved during a merge, so cannot
-    // be considered part of block size.
-    //
-    // Therefore, we can think of the new block size to be something like:
-    //     NEW BLOCK SIZE =  H1_SZ + HEADER 2 + H2SZ
-    //     NEW BLOCK SIZE =  H1_SZ + header_adjusted_size(header2)
-    LeftHeader->Size += header_adjusted_size(RightHeader->Size);
+    Sl = memory_ffs(SlMap);
+    
+    header_t Result = Memory->FreeLists[Fl][Sl];
+    memory_free_list_remove(Memory, Result);
+    
+    return Result;
 }
 
-file_internal void memory_free_list_add(header_t *FreeList, header_t Header)
+file_internal void memory_free_list_add(memory *Memory, header_t Header)
 {
-    Header->Next = NULL;
+    u32 Fl, Sl;
+    memory_mapping_insert(Header->Size, &Fl, &Sl);
+    
+    header_t Head = Memory->FreeLists[Fl][Sl];
+    
     Header->Prev = NULL;
+    Header->Next = Head;
+    if (Head) Head->Prev = Header;
+    
+    Memory->FreeLists[Fl][Sl] = Header;
+    Memory->FlBitmap    |= (1ULL << Fl);
+    Memory->SlBitmap[Fl] |= (1U << Sl);
+}
+
+file_internal void memory_free_list_remove(memory *Memory, header_t HeaderToRemove)
+{
+    u32 Fl, Sl;
+    memory_mapping_insert(HeaderToRemove->Size, &Fl, &Sl);
     
-    // init the list
-    if (!(*FreeList))
+    if (HeaderToRemove->Prev != NULL)
     {
-        *FreeList = Header;
-        (*FreeList)->Prev = NULL;
-        (*FreeList)->Next = NULL;
-        
-        return;
+        HeaderToRemove->Prev->Next = HeaderToRemove->Next;
     }
     
-    header_t Iter = *FreeList;
-    
-    // add to the front
-    if (Header < *FreeList)
+    if (HeaderToRemove->Next != NULL)
     {
-        Header->Next      = *FreeList;
-        (*FreeList)->Prev = Header;
-        *FreeList         = Header;
+        HeaderToRemove->Next->Prev = HeaderToRemove->Prev;
     }
-    else
+    
+    if (Memory->FreeLists[Fl][Sl] == HeaderToRemove)
     {
-        while (Iter->Next && Header > Iter->Next)
+        Memory->FreeLists[Fl][Sl] = HeaderToRemove->Next;
+        
+        // List is now empty, so clear the occupancy bits
+        if (!Memory->FreeLists[Fl][Sl])
         {
-            // NOTE(Dustin): I am not sure about the relevency of this branch...
-            // I think I was originally trying to detect a duplicate in the list.
-            if (Iter == Header || Iter->Next == Header)
+            Memory->SlBitmap[Fl] &= ~(1U << Sl);
+            if (!Memory->SlBitmap[Fl])
             {
-                return;
+                Memory->FlBitmap &= ~(1ULL << Fl);
             }
-            
-            Iter = Iter->Next;
-        }
-        
-        // insert the header into the list
-        Header->Prev = Iter;
-        Header->Next = Iter->Next;
-        
-        if (Iter->Next)
-        {
-            Iter->Next->Prev = Header;
         }
-        
-        Iter->Next = Header;
     }
     
-    // If the new node is besides already existing nodes, merge them together
-    Iter = Header;
+    HeaderToRemove->Prev = NULL;
+    HeaderToRemove->Next = NULL;
+}
+
+// Commits the pages below End, rounded up to the commit granularity. Returns
+// false if the pages could not be committed.
+file_internal bool memory_commit_to(memory *Memory, void *End)
+{
+    if ((char*)End <= (char*)Memory->Committed)
+        return true;
+    
+    char *Limit        = (char*)Memory->Start + Memory->Size;
+    u64 Granularity    = Memory->CommitGranularity;
+    u64 Offset         = (char*)End - (char*)Memory->Start;
+    char *NewCommitted = (char*)Memory->Start + ((Offset + Granularity - 1) / Granularity) * Granularity;
+    if (NewCommitted > Limit)
+        NewCommitted = Limit;
     
-    if (Iter->Next)
-    {
-        u64 Adj = header_adjusted_size(Iter->Size);
-        if (((char*)Iter + Adj) == (char*)Iter->Next)
-        {
-            memory_block_coalesce(Iter, Iter->Next);
-        }
-    }
+    if (!Memory->Commit(Memory->Committed, NewCommitted - (char*)Memory->Committed))
+        return false;
+    
+    Memory->Committed = NewCommitted;
+    return true;
+}
+
+// Called when the break pointer moves back. One granule past the break pointer
+// stays committed so an alloc/free pattern at the end of the heap does not
+// commit and decommit the same pages every time.
+file_internal void memory_decommit_trailing(memory *Memory)
+{
+    if (!Memory->Decommit)
+        return;
     
-    if (Iter->Prev)
+    u64 Granularity = Memory->CommitGranularity;
+    u64 Offset      = (char*)Memory->Brkp - (char*)Memory->Start;
+    char *Keep      = (char*)Memory->Start + ((Offset + Granularity - 1) / Granularity + 1) * Granularity;
+    
+    if ((char*)Memory->Committed > Keep + MEMORY_DECOMMIT_SLACK * Granularity)
     {
-        u64 Adj = header_adjusted_size(Iter->Prev->Size);
-        if (((char*)Iter - Adj) == (char*)Iter->Prev)
-        {
-            memory_block_coalesce(Iter->Prev, Iter);
-        }
+        Memory->Decommit(Keep, (char*)Memory->Committed - Keep);
+        Memory->Committed = Keep;
     }
 }
 
-
-file_internal void memory_free_list_remove(header_t* FreeList, header_t HeaderToRemove)
+// Marks a block as free, merges it with its free physical neighbours and places
+// the result in the matching size class. A free block that ends at the break
+// pointer is handed back to the heap instead, so the block right before Brkp is
+// always in use.
+file_internal void memory_block_release(memory *Memory, header_t Header)
 {
-    // Do not need to check FreeList because Alloc only calls memory_find_free_header
-    // if the FreeList exists
-    // if (!(*FreeList) || header == NULL) return;
+    Header->Used = 0;
     
-    if (*FreeList == HeaderToRemove)
+    if (!Header->PrevUsed)
     {
-        *FreeList = HeaderToRemove->Next;
-        if (*FreeList) (*FreeList)->Prev = NULL;
+        header_t Left = header_prev_phys(Header);
+        memory_free_list_remove(Memory, Left);
+        
+        // The header is absorbed into the data of the left block:
+        //     NEW BLOCK SIZE =  H1_SZ + HEADER 2 + H2SZ
+        Left->Size += MIN_HEADER_SIZE + Header->Size;
+        Header = Left;
     }
     
-    // Remove it from the free list
-    if (HeaderToRemove->Prev != NULL)
+    header_t Right = header_next_phys(Header);
+    if ((char*)Right < (char*)Memory->Brkp && !Right->Used)
     {
-        HeaderToRemove->Prev->Next = HeaderToRemove->Next;
+        memory_free_list_remove(Memory, Right);
+        
+        Header->Size += MIN_HEADER_SIZE + Right->Size;
+        Right = header_next_phys(Header);
     }
     
-    if (HeaderToRemove->Next != NULL)
+    if ((char*)Right >= (char*)Memory->Brkp)
     {
-        HeaderToRemove->Next->Prev = HeaderToRemove->Prev;
+        Memory->Brkp = Header;
+        memory_decommit_trailing(Memory);
+        return;
     }
     
-    HeaderToRemove->Prev = NULL;
-    HeaderToRemove->Next = NULL;
+    Right->PrevUsed = 0;
+    *header_footer(Header) = Header->Size;
+    
+    memory_free_list_add(Memory, Header);
 }
 
-file_internal header_t memory_block_split(header_t* FreeList, header_t Header, u64 Size)
+file_internal header_t memory_block_split(memory *Memory, header_t Header, u64 Size)
 {
     /*
       Determine if a header can be split
       Let's consider the minimum scenerio where size is 8bytes.
-      The Header Alignment uses 24bytes, so an 8byte request is
-      aligned to 24bytes.
+      The Header Alignment uses 32bytes (8b header, 16b links
+      and 8b footer), so an 8byte request is aligned to 32bytes.
     
       Since 8bytes is the minimum request size, that means after
       a split, there must be 8 bytes leftover. So a split can occur
@@ -229,17 +517,17 @@ file_internal header_t memory_block_split(header_t* FreeList, header_t Header, u
       header_size - header_adjusted_size(size) >= 8 bytes
     
       So the new block will have a total allocated size of at least
-      24 bytes. 16 bytes of this is usable. 8 bytes is reserved for
+      32 bytes. 24 bytes of this is usable. 8 bytes is reserved for
       header flags. So new block size will be:
     
       block_size = header_adjusted_size(size) - 8 bytes
       Before split:
       -----------------------------
-      | 8b |  x >= 16b            |
+      | 8b |  x >= 24b            |
       -----------------------------
       After split:
       ------------------------------------------
-      | 8b | size | 8b | leftover at least 16b |
+      | 8b | size | 8b | leftover at least 24b |
       ------------------------------------------
     
     */
@@ -253,6 +541,7 @@ file_internal header_t memory_block_split(header_t* FreeList, header_t Header, u
     
     u64 Leftover = HeaderDataSize - Size;
     // is there enough space for the split? Need: 8 byte core header + 16 bytes for the links
+    // + 8 bytes for the footer
     if (Leftover < header_adjusted_size(BLOCK_SIZE))
     {
         return Header;
@@ -263,51 +552,122 @@ file_internal header_t memory_block_split(header_t* FreeList, header_t Header, u
     header_t SplitHeader = (header_t)((char*)Header + ReqSize);
     // leftover represents the TOTAL space leftover. Need to account for
     // the reserved flags space, so subtract 8bytes
-    SplitHeader->Size = Leftover - BLOCK_SIZE;
-    SplitHeader->Used = 0;
+    SplitHeader->Size     = Leftover - BLOCK_SIZE;
+    SplitHeader->Cache    = 0;
+    SplitHeader->Used     = 0;
+    SplitHeader->PrevUsed = 1;
     
     // Add the split header to the free list for future use
-    memory_free_list_add(FreeList, SplitHeader);
+    memory_block_release(Memory, SplitHeader);
     
     return Header;
 }
 
-void* memory_alloc(memory *Memory, u64 Size)
+//~ Usage tracking
+
+file_internal u32 memory_histogram_bucket(u64 Size)
+{
+    if (Size < 64) return 0;
+    
+    u32 Bucket = memory_fls(Size) - 5;
+    return (Bucket < MEMORY_HISTOGRAM_BUCKET_COUNT) ? Bucket : MEMORY_HISTOGRAM_BUCKET_COUNT - 1;
+}
+
+file_internal void memory_track_alloc(memory *Memory, header_t Header)
+{
+    Memory->NumAllocations++;
+    Memory->UsedMemory += Header->Size;
+    
+    memory_tag_stats *Stats = Memory->TagStats + Header->Tag;
+    Stats->LiveBytes += Header->Size;
+    Stats->LiveAllocations++;
+    Stats->TotalAllocations++;
+    Stats->SizeHistogram[memory_histogram_bucket(Header->Size)]++;
+    
+    if (Stats->LiveBytes > Stats->PeakBytes)
+    {
+        Stats->PeakBytes = Stats->LiveBytes;
+    }
+}
+
+// Header->Size has changed in place from OldSize
+file_internal void memory_track_resize(memory *Memory, header_t Header, u64 OldSize)
+{
+    Memory->UsedMemory = Memory->UsedMemory - OldSize + Header->Size;
+    
+    memory_tag_stats *Stats = Memory->TagStats + Header->Tag;
+    Stats->LiveBytes = Stats->LiveBytes - OldSize + Header->Size;
+    
+    if (Stats->LiveBytes > Stats->PeakBytes)
+    {
+        Stats->PeakBytes = Stats->LiveBytes;
+    }
+}
+
+file_internal void memory_track_release(memory *Memory, header_t Header)
+{
+    if ((i64)Memory->UsedMemory - (i64)Header->Size < 0)
+    {
+        printf("Used memory has an underflow!\n");
+    }
+    
+    Memory->UsedMemory -= Header->Size;
+    Memory->NumAllocations--;
+    
+    memory_tag_stats *Stats = Memory->TagStats + Header->Tag;
+    Stats->LiveBytes -= Header->Size;
+    Stats->LiveAllocations--;
+}
+
+file_internal void* memory_heap_alloc(memory *Memory, u64 Size, memory_tag Tag)
 {
     if (Size == 0) return NULL;
     
     void *Result = NULL;
     
+    // Blocks smaller than the list links + footer still occupy the space for
+    // them, so treat them as if they had requested it.
     Size = mem_align(Size);
+    if (Size < MIN_BLOCK_SIZE) Size = MIN_BLOCK_SIZE;
     u64 AdjSize = header_adjusted_size(Size);
     
     // Search for an available header
     header_t Header = NULL;
-    if (Memory->FreeList && (Header = memory_find_free_header(&Memory->FreeList, Size)))
+    if (Memory->FlBitmap && (Header = memory_find_free_header(Memory, Size)))
     {
-        memory_block_split(&Memory->FreeList, Header, Size);
-        Header->Used = 1;
+        memory_block_split(Memory, Header, Size);
+        Header->Tag   = Tag;
+        Header->Cache = 0;
+        Header->Used  = 1;
         
-        Memory->NumAllocations++;
-        Memory->UsedMemory += Header->Size;
+        header_t Right = header_next_phys(Header);
+        if ((char*)Right < (char*)Memory->Brkp)
+        {
+            Right->PrevUsed = 1;
+        }
+        
+        memory_track_alloc(Memory, Header);
         
         Result = header_to_mem(Header);
     }
     else {
         // header was not found, request from the heap
-        if (((char*)Memory->Brkp + AdjSize) <= ((char*)Memory->Start + Memory->Size))
+        if (((char*)Memory->Brkp + AdjSize) <= ((char*)Memory->Start + Memory->Size) &&
+            memory_commit_to(Memory, (char*)Memory->Brkp + AdjSize))
         {
             char *NextAddr = (char*)Memory->Brkp;
             Memory->Brkp = (char*)Memory->Brkp + AdjSize;
             Header = (header_t)NextAddr;
             
-            Header->Size = Size;
-            Header->Used = 1;
-            Header->Next = NULL;
-            Header->Prev = NULL;
+            Header->Size     = Size;
+            Header->Tag      = Tag;
+            Header->Cache    = 0;
+            Header->Used     = 1;
+            Header->PrevUsed = 1; // the block before Brkp is never free
+            Header->Next     = NULL;
+            Header->Prev     = NULL;
             
-            Memory->NumAllocations++;
-            Memory->UsedMemory += Header->Size;
+            memory_track_alloc(Memory, Header);
             
             Result = header_to_mem(Header);
         }
@@ -320,7 +680,58 @@ void* memory_alloc(memory *Memory, u64 Size)
     return Result;
 }
 
-void* memory_realloc(memory *Memory, void *Ptr, u64 Size)
+// Over-aligned blocks are ordinary blocks that happen to start on an aligned
+// address, so they are released and resized like any other block. Enough is
+// allocated to cover the worst case offset plus a leading block, which is given
+// back to the free list together with the unused tail.
+file_internal void* memory_heap_alloc_aligned(memory *Memory, u64 Size, u64 Align, memory_tag Tag)
+{
+    if (Align <= BLOCK_SIZE) return memory_heap_alloc(Memory, Size, Tag);
+    if (Size == 0) return NULL;
+    
+    Size = mem_align(Size);
+    if (Size < MIN_BLOCK_SIZE) Size = MIN_BLOCK_SIZE;
+    
+    // Smallest block that can be split off in front of the aligned block
+    u64 MinGap = header_adjusted_size(BLOCK_SIZE);
+    
+    void *Ptr = memory_heap_alloc(Memory, Size + Align + MinGap, Tag);
+    if (!Ptr) return NULL;
+    
+    header_t Header = (header_t)mem_to_header(Ptr);
+    u64 OldSize = Header->Size;
+    
+    if ((uptr)Ptr % Align != 0)
+    {
+        char *Aligned = (char*)memory_align((uptr)Ptr + MinGap, (uptr)Align);
+        
+        header_t AlignedHeader = (header_t)mem_to_header(Aligned);
+        AlignedHeader->Size     = ((char*)Ptr + OldSize) - Aligned;
+        AlignedHeader->Tag      = Tag;
+        AlignedHeader->Cache    = 0;
+        AlignedHeader->Used     = 1;
+        AlignedHeader->PrevUsed = 1;
+        
+        // The leading block is released after the aligned header is in place,
+        // so it clears PrevUsed on it
+        Header->Size = (char*)AlignedHeader - (char*)Ptr;
+        memory_block_release(Memory, Header);
+        
+        Header = AlignedHeader;
+    }
+    
+    memory_block_split(Memory, Header, Size);
+    memory_track_resize(Memory, Header, OldSize);
+    
+    // Count the allocation under the size that was asked for
+    memory_tag_stats *Stats = Memory->TagStats + Tag;
+    Stats->SizeHistogram[memory_histogram_bucket(OldSize)]--;
+    Stats->SizeHistogram[memory_histogram_bucket(Header->Size)]++;
+    
+    return header_to_mem(Header);
+}
+
+file_internal void* memory_heap_realloc(memory *Memory, void *Ptr, u64 Size, u64 Align, memory_tag Tag)
 {
     header_t Header = (header_t)mem_to_header(Ptr);
     
@@ -329,7 +740,7 @@ void* memory_realloc(memory *Memory, void *Ptr, u64 Size)
     Size = mem_align(Size);
     if (!Ptr)
     {
-        Result = memory_alloc(Memory, Size);
+        Result = memory_heap_alloc_aligned(Memory, Size, Align, Tag);
     }
     else if (Header->Size == Size)
     {
@@ -337,13 +748,62 @@ void* memory_realloc(memory *Memory, void *Ptr, u64 Size)
     }
     else if (Size > Header->Size)
     {
-        // Size is greater than the allocation, so we
-        // have allocate a new block of memory, copy
+        // Size is greater than the allocation. First try
+        // to grow the block in place:
+        // 1. The block is the last one before the break
+        //    pointer, so the break pointer is moved.
+        // 2. The block after this one is free and large
+        //    enough, so it is absorbed and the leftover
+        //    is split back off.
+        // Otherwise, allocate a new block of memory, copy
         // the old block over, and finally free the old
         // block
-        Result = memory_alloc(Memory, Size);
-        memcpy(Result, Ptr, Size);
-        memory_release(Memory, Ptr);
+        u64 OldSize = Header->Size;
+        
+        header_t Right = header_next_phys(Header);
+        if ((char*)Right >= (char*)Memory->Brkp)
+        {
+            u64 Extra = header_adjusted_size(Size) - header_adjusted_size(OldSize);
+            if ((char*)Memory->Brkp + Extra <= (char*)Memory->Start + Memory->Size &&
+                memory_commit_to(Memory, (char*)Memory->Brkp + Extra))
+            {
+                Memory->Brkp = (char*)Memory->Brkp + Extra;
+                Header->Size = Size;
+                
+                Result = Ptr;
+            }
+        }
+        else if (!Right->Used && OldSize + MIN_HEADER_SIZE + Right->Size >= Size)
+        {
+            memory_free_list_remove(Memory, Right);
+            Header->Size += MIN_HEADER_SIZE + Right->Size;
+            
+            // Two free blocks are never next to each other, so the block after
+            // the absorbed one is in use
+            header_t Next = header_next_phys(Header);
+            if ((char*)Next < (char*)Memory->Brkp)
+            {
+                Next->PrevUsed = 1;
+            }
+            
+            memory_block_split(Memory, Header, Size);
+            
+            Result = Ptr;
+        }
+        
+        if (Result)
+        {
+            memory_track_resize(Memory, Header, OldSize);
+        }
+        else
+        {
+            Result = memory_heap_alloc_aligned(Memory, Size, Align, (memory_tag)Header->Tag);
+            if (Result)
+            {
+                memcpy(Result, Ptr, OldSize);
+                memory_heap_release(Memory, Ptr);
+            }
+        }
     }
     else
     {
@@ -351,7 +811,11 @@ void* memory_realloc(memory *Memory, void *Ptr, u64 Size)
         // we attempt to split the block, adjust
         // size, add new block back to the free list
         // and return adjusted block.
-        memory_block_split(&Memory->FreeList, Header, Size);
+        if (Size < MIN_BLOCK_SIZE) Size = MIN_BLOCK_SIZE;
+        
+        u64 OldSize = Header->Size;
+        memory_block_split(Memory, Header, Size);
+        memory_track_resize(Memory, Header, OldSize);
         
         Result = header_to_mem(Header);
     }
@@ -359,7 +823,7 @@ void* memory_realloc(memory *Memory, void *Ptr, u64 Size)
     return Result;
 }
 
-void memory_release(memory *Memory, void *Ptr)
+file_internal void memory_heap_release(memory *Memory, void *Ptr)
 {
     if (!Ptr) return;
     
@@ -370,31 +834,710 @@ void memory_release(memory *Memory, void *Ptr)
         return;
     }
     
-    Header->Used = 0;
+    memory_track_release(Memory, Header);
+    memory_block_release(Memory, Header);
+}
+
+void* memory_alloc(memory *Memory, u64 Size)
+{
+    return memory_alloc_tagged(Memory, Size, MemoryTag_Unknown);
+}
+
+void* memory_alloc_tagged(memory *Memory, u64 Size, memory_tag Tag)
+{
+    return memory_alloc_aligned_tagged(Memory, Size, BLOCK_SIZE, Tag);
+}
+
+void* memory_alloc_aligned(memory *Memory, u64 Size, u64 Align)
+{
+    return memory_alloc_aligned_tagged(Memory, Size, Align, MemoryTag_Unknown);
+}
+
+void* memory_alloc_aligned_tagged(memory *Memory, u64 Size, u64 Align, memory_tag Tag)
+{
+    assert((Align & (Align - 1)) == 0 && "Alignment must be a power of two!");
     
-    if ((i64)Memory->UsedMemory - (i64)Header->Size < 0)
+    memory_lock(Memory);
+    void *Result = memory_heap_alloc_aligned(Memory, Size, Align, Tag);
+    if (Result)
     {
-        printf("Used memory has an underflow!\n");
+        memory_trace_append(Memory, (Align > BLOCK_SIZE) ? MemoryTraceOp_AllocAligned : MemoryTraceOp_Alloc,
+                            Tag, Size, Result, (Align > BLOCK_SIZE) ? (void*)(uptr)Align : NULL);
     }
+    memory_unlock(Memory);
     
-    Memory->UsedMemory -= Header->Size;
-    Memory->NumAllocations--;
+    return Result;
+}
+
+void* memory_realloc(memory *Memory, void *Ptr, u64 Size)
+{
+    return memory_realloc_tagged(Memory, Ptr, Size, MemoryTag_Unknown);
+}
+
+file_internal void* memory_realloc_aligned_tagged(memory *Memory, void *Ptr, u64 Size, u64 Align, memory_tag Tag)
+{
+    void *Result = NULL;
+    
+    header_t Header = (header_t)mem_to_header(Ptr);
+    if (Ptr && Header->Cache)
+    {
+        // Block is owned by a thread cache. Move it to the heap and hand the old
+        // block back to its owner.
+        Result = memory_alloc_aligned_tagged(Memory, Size, Align, Tag);
+        if (Result)
+        {
+            memcpy(Result, Ptr, (Size < Header->Size) ? Size : Header->Size);
+            memory_release(Memory, Ptr);
+        }
+    }
+    else
+    {
+        memory_lock(Memory);
+        Result = memory_heap_realloc(Memory, Ptr, Size, Align, Tag);
+        if (Result)
+        {
+            memory_trace_append(Memory, MemoryTraceOp_Realloc, mem_to_header(Result)->Tag, Size, Result, Ptr);
+        }
+        memory_unlock(Memory);
+    }
+    
+    return Result;
+}
+
+void* memory_realloc_tagged(memory *Memory, void *Ptr, u64 Size, memory_tag Tag)
+{
+    return memory_realloc_aligned_tagged(Memory, Ptr, Size, BLOCK_SIZE, Tag);
+}
+
+void* memory_realloc_aligned(memory *Memory, void *Ptr, u64 Size, u64 Align)
+{
+    assert((Align & (Align - 1)) == 0 && "Alignment must be a power of two!");
+    return memory_realloc_aligned_tagged(Memory, Ptr, Size, Align, MemoryTag_Unknown);
+}
+
+void memory_release_aligned(memory *Memory, void *Ptr)
+{
+    memory_release(Memory, Ptr);
+}
+
+void memory_release(memory *Memory, void *Ptr)
+{
+    if (!Ptr) return;
+    
+    header_t Header = (header_t)mem_to_header(Ptr);
+    if (Header->Cache)
+    {
+        memory_trace_append_sync(Memory, MemoryTraceOp_Release, MemoryTag_ThreadCache, 0, Ptr, NULL);
+        memory_cache_push_remote(Memory->Caches[Header->Cache - 1], Ptr);
+    }
+    else
+    {
+        memory_lock(Memory);
+        memory_trace_append(Memory, MemoryTraceOp_Release, Header->Tag, 0, Ptr, NULL);
+        memory_heap_release(Memory, Ptr);
+        memory_unlock(Memory);
+    }
+}
+
+//~ Thread caches
+
+#define cache_class_size(c) (((c) + 1) * MEMORY_CACHE_CLASS_SIZE)
+
+// Returns a cached block to the shared heap. Heap lock must be held.
+file_internal void memory_cache_return_to_heap(memory *Memory, void *Ptr)
+{
+    header_t Header = mem_to_header(Ptr);
+    Header->Cache = 0;
+    
+    memory_heap_release(Memory, Ptr);
+}
+
+// Places a block owned by the cache in the magazine of the largest class it can
+// satisfy. Blocks that do not fit a magazine go back to the heap, so the heap lock
+// must be held.
+file_internal void memory_cache_put_locked(memory_thread_cache *Cache, void *Ptr)
+{
+    header_t Header = mem_to_header(Ptr);
+    
+    u64 Class = Header->Size / MEMORY_CACHE_CLASS_SIZE - 1;
+    if (Class < MEMORY_CACHE_CLASS_COUNT && Cache->MagazineCount[Class] < MEMORY_MAGAZINE_SIZE)
+    {
+        Cache->Magazines[Class][Cache->MagazineCount[Class]++] = Ptr;
+    }
+    else
+    {
+        memory_cache_return_to_heap(Cache->Memory, Ptr);
+    }
+}
+
+// Pushes a block onto the owner's return queue. Any number of threads can push,
+// only the owner pops (by taking the whole list at once), so a CAS loop is enough.
+file_internal void memory_cache_push_remote(memory_thread_cache *Cache, void *Ptr)
+{
+    void *Head;
+    do
+    {
+        Head = memory_atomic_load(&Cache->RemoteFrees);
+        *(void**)Ptr = Head;
+    } while (memory_atomic_cas_ptr(&Cache->RemoteFrees, Ptr, Head) != Head);
+}
+
+// Takes every block other threads returned to this cache. Heap lock must be held.
+file_internal void memory_cache_drain_remote(memory_thread_cache *Cache)
+{
+    void *Ptr = memory_atomic_exchange_ptr(&Cache->RemoteFrees, (void*)NULL);
+    while (Ptr)
+    {
+        void *Next = *(void**)Ptr;
+        memory_cache_put_locked(Cache, Ptr);
+        Ptr = Next;
+    }
+}
+
+file_internal void memory_cache_refill(memory_thread_cache *Cache, u32 Class)
+{
+    memory *Memory = Cache->Memory;
+    memory_lock(Memory);
+    
+    memory_cache_drain_remote(Cache);
+    
+    while (Cache->MagazineCount[Class] < MEMORY_MAGAZINE_SIZE / 2)
+    {
+        void *Ptr = memory_heap_alloc(Memory, cache_class_size(Class), MemoryTag_ThreadCache);
+        if (!Ptr) break;
+        
+        header_t Header = mem_to_header(Ptr);
+        Header->Cache = Cache->Index + 1;
+        
+        Cache->Magazines[Class][Cache->MagazineCount[Class]++] = Ptr;
+    }
+    
+    memory_unlock(Memory);
+}
+
+file_internal void memory_cache_flush(memory_thread_cache *Cache, u32 Class, u32 Count)
+{
+    memory *Memory = Cache->Memory;
+    memory_lock(Memory);
+    
+    while (Count-- && Cache->MagazineCount[Class])
+    {
+        memory_cache_return_to_heap(Memory, Cache->Magazines[Class][--Cache->MagazineCount[Class]]);
+    }
+    
+    memory_unlock(Memory);
+}
+
+memory_thread_cache* memory_thread_cache_create(memory *Memory)
+{
+    memory_thread_cache *Result = NULL;
+    
+    memory_lock(Memory);
+    
+    for (u32 CacheIdx = 0; CacheIdx < MEMORY_MAX_THREAD_CACHES; ++CacheIdx)
+    {
+        if (!Memory->Caches[CacheIdx])
+        {
+            Result = (memory_thread_cache*)memory_heap_alloc(Memory, sizeof(memory_thread_cache), MemoryTag_ThreadCache);
+            if (Result)
+            {
+                memset(Result, 0, sizeof(memory_thread_cache));
+                Result->Memory = Memory;
+                Result->Index  = CacheIdx;
+                
+                Memory->Caches[CacheIdx] = Result;
+            }
+            
+            break;
+        }
+    }
+    
+    memory_unlock(Memory);
+    
+    if (!Result)
+    {
+        // TODO(Dustin): Log
+        printf("Unable to create a thread cache! Are there more than %d threads?\n", MEMORY_MAX_THREAD_CACHES);
+    }
+    
+    return Result;
+}
+
+void memory_thread_cache_free(memory_thread_cache *Cache)
+{
+    memory *Memory = Cache->Memory;
+    memory_lock(Memory);
+    
+    memory_cache_drain_remote(Cache);
+    
+    for (u32 Class = 0; Class < MEMORY_CACHE_CLASS_COUNT; ++Class)
+    {
+        while (Cache->MagazineCount[Class])
+        {
+            memory_cache_return_to_heap(Memory, Cache->Magazines[Class][--Cache->MagazineCount[Class]]);
+        }
+    }
+    
+    Memory->Caches[Cache->Index] = NULL;
+    memory_heap_release(Memory, Cache);
+    
+    memory_unlock(Memory);
+}
+
+void* memory_cache_alloc(memory_thread_cache *Cache, u64 Size)
+{
+    if (Size == 0) return NULL;
+    
+    if (Size < MIN_BLOCK_SIZE) Size = MIN_BLOCK_SIZE;
+    Size = memory_align(Size, MEMORY_CACHE_CLASS_SIZE);
+    
+    // Too large to be cached, go straight to the heap
+    if (Size > cache_class_size(MEMORY_CACHE_CLASS_COUNT - 1))
+    {
+        return memory_alloc(Cache->Memory, Size);
+    }
+    
+    u32 Class = (u32)(Size / MEMORY_CACHE_CLASS_SIZE) - 1;
+    if (!Cache->MagazineCount[Class])
+    {
+        memory_cache_refill(Cache, Class);
+        if (!Cache->MagazineCount[Class]) return NULL;
+    }
+    
+    void *Result = Cache->Magazines[Class][--Cache->MagazineCount[Class]];
+    memory_trace_append_sync(Cache->Memory, MemoryTraceOp_Alloc, MemoryTag_ThreadCache, Size, Result, NULL);
+    
+    return Result;
+}
+
+void memory_cache_release(memory_thread_cache *Cache, void *Ptr)
+{
+    if (!Ptr) return;
+    
+    header_t Header = (header_t)mem_to_header(Ptr);
+    if (Header->Cache != Cache->Index + 1)
+    {
+        // Either a heap block or a block owned by another thread
+        memory_release(Cache->Memory, Ptr);
+        return;
+    }
+    
+    memory_trace_append_sync(Cache->Memory, MemoryTraceOp_Release, MemoryTag_ThreadCache, 0, Ptr, NULL);
+    
+    u64 Class = Header->Size / MEMORY_CACHE_CLASS_SIZE - 1;
+    if (Class >= MEMORY_CACHE_CLASS_COUNT)
+    {
+        memory_lock(Cache->Memory);
+        memory_cache_return_to_heap(Cache->Memory, Ptr);
+        memory_unlock(Cache->Memory);
+        return;
+    }
+    
+    if (Cache->MagazineCount[Class] == MEMORY_MAGAZINE_SIZE)
+    {
+        memory_cache_flush(Cache, (u32)Class, MEMORY_MAGAZINE_SIZE / 2);
+    }
+    
+    Cache->Magazines[Class][Cache->MagazineCount[Class]++] = Ptr;
+}
+
+//~ Statistics
+
+const char* memory_tag_name(memory_tag Tag)
+{
+    switch (Tag)
+    {
+        case MemoryTag_Unknown:     return "unknown";
+        case MemoryTag_Platform:    return "platform";
+        case MemoryTag_AssetSys:    return "assetsys";
+        case MemoryTag_String:      return "string";
+        case MemoryTag_DynArray:    return "dyn_array";
+        case MemoryTag_Graphics:    return "graphics";
+        case MemoryTag_CommandPool: return "command_pool";
+        case MemoryTag_Game:        return "game";
+        case MemoryTag_ThreadCache: return "thread_cache";
+        default:                    return "invalid";
+    }
+}
+
+void memory_get_stats(memory *Memory, memory_stats *Stats)
+{
+    memory_lock(Memory);
+    
+    Stats->HeapSize       = Memory->Size;
+    Stats->HeapTouched    = (char*)Memory->Brkp - (char*)Memory->Start;
+    Stats->HeapCommitted  = (char*)Memory->Committed - (char*)Memory->Start;
+    Stats->UsedMemory     = Memory->UsedMemory;
+    Stats->NumAllocations = Memory->NumAllocations;
+    
+    // The space after the break pointer is one big free block
+    Stats->FreeMemory       = Stats->HeapSize - Stats->HeapTouched;
+    Stats->LargestFreeBlock = Stats->FreeMemory;
+    Stats->FreeBlockCount   = (Stats->FreeMemory) ? 1 : 0;
+    
+    for (u32 Fl = 0; Fl < MEMORY_FL_INDEX_COUNT; ++Fl)
+    {
+        for (u32 Sl = 0; Sl < MEMORY_SL_INDEX_COUNT; ++Sl)
+        {
+            for (header_t Header = Memory->FreeLists[Fl][Sl]; Header; Header = Header->Next)
+            {
+                Stats->FreeMemory += Header->Size;
+                Stats->FreeBlockCount++;
+                
+                if (Header->Size > Stats->LargestFreeBlock)
+                {
+                    Stats->LargestFreeBlock = Header->Size;
+                }
+            }
+        }
+    }
+    
+    Stats->Fragmentation = (Stats->FreeMemory) ? 1.0f - (r32)((r64)Stats->LargestFreeBlock / (r64)Stats->FreeMemory) : 0.0f;
+    
+    memcpy(Stats->Tags, Memory->TagStats, sizeof(Stats->Tags));
+    
+    memory_unlock(Memory);
+}
+
+// snprintf that keeps counting once the buffer is full
+#define json_append(...)                                                             \
+    Offset += snprintf((Buffer && Offset < BufferSize) ? Buffer + Offset : NULL,     \
+                       (Buffer && Offset < BufferSize) ? BufferSize - Offset : 0,    \
+                       __VA_ARGS__)
+
+file_internal u64 memory_histogram_to_json(u64 *Histogram, char *Buffer, u64 BufferSize, u64 Offset)
+{
+    json_append("[");
+    for (u32 Bucket = 0; Bucket < MEMORY_HISTOGRAM_BUCKET_COUNT; ++Bucket)
+    {
+        json_append("%s%llu", (Bucket) ? ", " : "", (unsigned long long)Histogram[Bucket]);
+    }
+    json_append("]");
+    
+    return Offset;
+}
+
+u64 memory_stats_to_json(memory_stats *Stats, char *Buffer, u64 BufferSize)
+{
+    u64 Offset = 0;
+    
+    json_append("{\n");
+    json_append("    \"heap_size\": %llu,\n",          (unsigned long long)Stats->HeapSize);
+    json_append("    \"heap_touched\": %llu,\n",       (unsigned long long)Stats->HeapTouched);
+    json_append("    \"heap_committed\": %llu,\n",     (unsigned long long)Stats->HeapCommitted);
+    json_append("    \"used_memory\": %llu,\n",        (unsigned long long)Stats->UsedMemory);
+    json_append("    \"num_allocations\": %llu,\n",    (unsigned long long)Stats->NumAllocations);
+    json_append("    \"free_memory\": %llu,\n",        (unsigned long long)Stats->FreeMemory);
+    json_append("    \"free_block_count\": %llu,\n",   (unsigned long long)Stats->FreeBlockCount);
+    json_append("    \"largest_free_block\": %llu,\n", (unsigned long long)Stats->LargestFreeBlock);
+    json_append("    \"fragmentation\": %f,\n",        Stats->Fragmentation);
+    
+    // Lower bound, in bytes, of each histogram bucket
+    json_append("    \"histogram_buckets\": [0");
+    for (u32 Bucket = 1; Bucket < MEMORY_HISTOGRAM_BUCKET_COUNT; ++Bucket)
+    {
+        json_append(", %llu", 1ULL << (Bucket + 5));
+    }
+    json_append("],\n");
+    
+    json_append("    \"tags\": {\n");
+    for (u32 Tag = 0; Tag < MemoryTag_Count; ++Tag)
+    {
+        memory_tag_stats *TagStats = Stats->Tags + Tag;
+        
+        json_append("        \"%s\": {\n", memory_tag_name((memory_tag)Tag));
+        json_append("            \"live_bytes\": %llu,\n",        (unsigned long long)TagStats->LiveBytes);
+        json_append("            \"peak_bytes\": %llu,\n",        (unsigned long long)TagStats->PeakBytes);
+        json_append("            \"live_allocations\": %llu,\n",  (unsigned long long)TagStats->LiveAllocations);
+        json_append("            \"total_allocations\": %llu,\n", (unsigned long long)TagStats->TotalAllocations);
+        json_append("            \"size_histogram\": ");
+        Offset = memory_histogram_to_json(TagStats->SizeHistogram, Buffer, BufferSize, Offset);
+        json_append("\n        }%s\n", (Tag + 1 < MemoryTag_Count) ? "," : "");
+    }
+    json_append("    }\n");
+    json_append("}\n");
+    
+    return Offset;
+}
+
+//~ Trace replay
+
+// Open addressing table from the ids in a trace to the blocks returned during the
+// replay. Ids are block addresses, so 0 and 1 are free to mark empty and deleted
+// slots.
+#define REPLAY_EMPTY   0
+#define REPLAY_DELETED 1
+
+typedef struct memory_replay_entry
+{
+    u64   Id;
+    void *Ptr;
+    u64   Size;
+} memory_replay_entry;
+
+typedef struct memory_replay_table
+{
+    memory_replay_entry *Entries;
+    u32                  Shift;
+    u64                  Mask;
+} memory_replay_table;
+
+file_internal u64 memory_replay_slot(memory_replay_table *Table, u64 Id)
+{
+    return ((Id >> 3) * 11400714819323198485ULL) >> Table->Shift;
+}
+
+file_internal memory_replay_entry* memory_replay_find(memory_replay_table *Table, u64 Id)
+{
+    for (u64 Slot = memory_replay_slot(Table, Id);; Slot = (Slot + 1) & Table->Mask)
+    {
+        memory_replay_entry *Entry = Table->Entries + Slot;
+        if (Entry->Id == Id)           return Entry;
+        if (Entry->Id == REPLAY_EMPTY) return NULL;
+    }
+}
+
+file_internal void memory_replay_insert(memory_replay_table *Table, u64 Id, void *Ptr, u64 Size)
+{
+    u64 Slot = memory_replay_slot(Table, Id);
+    while (Table->Entries[Slot].Id > REPLAY_DELETED)
+    {
+        Slot = (Slot + 1) & Table->Mask;
+    }
+    
+    Table->Entries[Slot].Id   = Id;
+    Table->Entries[Slot].Ptr  = Ptr;
+    Table->Entries[Slot].Size = Size;
+}
+
+file_internal void* memory_replay_alloc(memory *Memory, u64 Size, u32 Tag)
+{
+    return (Memory) ? memory_alloc_tagged(Memory, Size, (memory_tag)Tag) : malloc(Size);
+}
+
+file_internal void* memory_replay_realloc(memory *Memory, void *Ptr, u64 Size, u32 Tag)
+{
+    return (Memory) ? memory_realloc_tagged(Memory, Ptr, Size, (memory_tag)Tag) : realloc(Ptr, Size);
+}
+
+file_internal void memory_replay_release(memory *Memory, void *Ptr)
+{
+    if (Memory) memory_release(Memory, Ptr);
+    else        free(Ptr);
+}
+
+bool memory_trace_replay(memory *Memory, const char *Filename, memory_replay_result *Result)
+{
+    memset(Result, 0, sizeof(memory_replay_result));
+    
+    FILE *File = fopen(Filename, "rb");
+    if (!File)
+    {
+        printf("Unable to open the memory trace \"%s\"!\n", Filename);
+        return false;
+    }
+    
+    fseek(File, 0, SEEK_END);
+    long FileSize = ftell(File);
+    fseek(File, 0, SEEK_SET);
+    
+    memory_trace_file_header Header = {0};
+    if (FileSize < (long)sizeof(Header) || fread(&Header, sizeof(Header), 1, File) != 1 ||
+        Header.Magic != MEMORY_TRACE_MAGIC || Header.Version != MEMORY_TRACE_VERSION ||
+        Header.RecordSize != sizeof(memory_trace_record))
+    {
+        printf("\"%s\" is not a memory trace!\n", Filename);
+        fclose(File);
+        return false;
+    }
+    
+    // NOTE(Dustin): The replay's own bookkeeping comes from malloc so it does not
+    // show up in the heap being measured.
+    u64 RecordCount = (u64)(FileSize - sizeof(Header)) / sizeof(memory_trace_record);
+    memory_trace_record *Records = (memory_trace_record*)malloc(RecordCount * sizeof(memory_trace_record) + 1);
+    RecordCount = fread(Records, sizeof(memory_trace_record), RecordCount, File);
+    fclose(File);
+    
+    // At most one entry per record, keep the table at most half full
+    memory_replay_table Table = {0};
+    u32 Log2 = 4;
+    while ((1ULL << Log2) < 2 * RecordCount) ++Log2;
+    Table.Shift   = 64 - Log2;
+    Table.Mask    = (1ULL << Log2) - 1;
+    Table.Entries = (memory_replay_entry*)calloc(1ULL << Log2, sizeof(memory_replay_entry));
+    
+    u64 LiveBytes = 0;
+    for (u64 i = 0; i < RecordCount; ++i)
+    {
+        memory_trace_record *Record = Records + i;
+        
+        switch (Record->Op)
+        {
+            case MemoryTraceOp_Alloc:
+            {
+                u64 Start = memory_timestamp();
+                void *Ptr = memory_replay_alloc(Memory, Record->Size, (u32)Record->Tag);
+                Result->Cycles += memory_timestamp() - Start;
+                
+                if (Ptr)
+                {
+                    memory_replay_insert(&Table, Record->Id, Ptr, Record->Size);
+                    LiveBytes += Record->Size;
+                }
+                else Result->Failures++;
+            } break;
+            
+            case MemoryTraceOp_AllocAligned:
+            {
+                // NOTE(Dustin): malloc has no aligned counterpart that realloc and
+                // free accept on every crt, so the block and the records that
+                // refer to it are skipped. OldId holds the alignment.
+                if (!Memory)
+                {
+                    Result->Skipped++;
+                    break;
+                }
+                
+                u64 Start = memory_timestamp();
+                void *Ptr = memory_alloc_aligned_tagged(Memory, Record->Size, Record->OldId, (memory_tag)Record->Tag);
+                Result->Cycles += memory_timestamp() - Start;
+                
+                if (Ptr)
+                {
+                    memory_replay_insert(&Table, Record->Id, Ptr, Record->Size);
+                    LiveBytes += Record->Size;
+                }
+                else Result->Failures++;
+            } break;
+            
+            case MemoryTraceOp_Realloc:
+            {
+                memory_replay_entry *Entry = NULL;
+                if (Record->OldId)
+                {
+                    Entry = memory_replay_find(&Table, Record->OldId);
+                    if (!Entry)
+                    {
+                        Result->Skipped++;
+                        break;
+                    }
+                }
+                
+                void *OldPtr = (Entry) ? Entry->Ptr : NULL;
+                
+                u64 Start = memory_timestamp();
+                void *Ptr = memory_replay_realloc(Memory, OldPtr, Record->Size, (u32)Record->Tag);
+                Result->Cycles += memory_timestamp() - Start;
+                
+                if (Ptr)
+                {
+                    if (Entry)
+                    {
+                        LiveBytes -= Entry->Size;
+                        Entry->Id = REPLAY_DELETED;
+                    }
+                    
+                    memory_replay_insert(&Table, Record->Id, Ptr, Record->Size);
+                    LiveBytes += Record->Size;
+                }
+                else Result->Failures++;
+            } break;
+            
+            case MemoryTraceOp_Release:
+            {
+                memory_replay_entry *Entry = memory_replay_find(&Table, Record->Id);
+                if (!Entry)
+                {
+                    Result->Skipped++;
+                    break;
+                }
+                
+                u64 Start = memory_timestamp();
+                memory_replay_release(Memory, Entry->Ptr);
+                Result->Cycles += memory_timestamp() - Start;
+                
+                LiveBytes -= Entry->Size;
+                Entry->Id = REPLAY_DELETED;
+            } break;
+            
+            default: break;
+        }
+        
+        Result->Operations++;
+        
+        if (LiveBytes > Result->PeakLiveBytes)
+        {
+            Result->PeakLiveBytes = LiveBytes;
+        }
+        
+        u64 Footprint = (Memory) ? (u64)((char*)Memory->Brkp - (char*)Memory->Start) : LiveBytes;
+        if (Footprint > Result->PeakFootprint)
+        {
+            Result->PeakFootprint = Footprint;
+        }
+        
+        if (Memory && (i & 4095) == 4095)
+        {
+            memory_stats Stats;
+            memory_get_stats(Memory, &Stats);
+            if (Stats.Fragmentation > Result->PeakFragmentation)
+            {
+                Result->PeakFragmentation = Stats.Fragmentation;
+            }
+        }
+    }
+    
+    if (Memory)
+    {
+        memory_stats Stats;
+        memory_get_stats(Memory, &Stats);
+        Result->Fragmentation = Stats.Fragmentation;
+        if (Stats.Fragmentation > Result->PeakFragmentation)
+        {
+            Result->PeakFragmentation = Stats.Fragmentation;
+        }
+    }
+    
+    // Release whatever the trace did not
+    for (u64 Slot = 0; Slot <= Table.Mask; ++Slot)
+    {
+        if (Table.Entries[Slot].Id > REPLAY_DELETED)
+        {
+            memory_replay_release(Memory, Table.Entries[Slot].Ptr);
+        }
+    }
     
-    // When there is an 8 byte allocation, the total allocated size ends up being
-    // 24 bytes, and only 8 bytes are reserved (16 bytes are for the Free List and are
-    // only needed when in the Free List). So if this block were to be allocated again,
-    // there are actually 16 bytes that are usable. This will adjust the header data size
-    // to reflect this extra usable space.
-    if (Header->Size < LIST_HEADER_SIZE)
-        Header->Size = LIST_HEADER_SIZE;
+    free(Table.Entries);
+    free(Records);
     
-    memory_free_list_add(&Memory->FreeList, Header);
+    return true;
 }
 
+#undef REPLAY_DELETED
+#undef REPLAY_EMPTY
+#undef json_append
+#undef cache_class_size
+#undef memory_timestamp
+#undef memory_cpu_relax
+#undef memory_atomic_cas_ptr
+#undef memory_atomic_exchange_ptr
+#undef memory_atomic_exchange_32
+#undef memory_atomic_load
+#if !defined(MEMORY_TRACE)
+#undef memory_trace_append_sync
+#undef memory_trace_append
+#endif
+#undef MEMORY_DECOMMIT_SLACK
+#undef SMALL_BLOCK_SIZE
+#undef header_footer
+#undef header_prev_phys
+#undef header_next_phys
 #undef mem_to_header
 #undef header_to_mem
 #undef header_adjusted_size
 #undef mem_align
+#undef MIN_BLOCK_SIZE
+#undef FOOTER_SIZE
 #undef LIST_HEADER_SIZE
 #undef MIN_LINK_SIZE
 #undef HEADER_SIZE
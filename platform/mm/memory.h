@@ -3,25 +3,227 @@
 
 typedef struct header* header_t;
 
+// Free blocks are kept in segregated size classes (TLSF style). The first level
+// splits sizes by power of two, the second level linearly subdivides each power
+// of two into MEMORY_SL_INDEX_COUNT lists. A pair of bitmaps tracks which lists
+// are non-empty, so finding a free block that fits is a couple of bit scans
+// instead of a walk over the free list. Blocks and heaps are at most 4GB, so the
+// first level stops at 2^31.
+#define MEMORY_ALIGN_LOG2          3
+#define MEMORY_SL_INDEX_COUNT_LOG2 3
+#define MEMORY_SL_INDEX_COUNT      (1 << MEMORY_SL_INDEX_COUNT_LOG2)
+#define MEMORY_FL_INDEX_SHIFT      (MEMORY_SL_INDEX_COUNT_LOG2 + MEMORY_ALIGN_LOG2)
+#define MEMORY_FL_INDEX_MAX        32
+#define MEMORY_FL_INDEX_COUNT      (MEMORY_FL_INDEX_MAX - MEMORY_FL_INDEX_SHIFT + 1)
+
+// Thread caches keep small blocks in per-thread magazines, one per size class.
+// Class N holds blocks of (N + 1) * MEMORY_CACHE_CLASS_SIZE bytes, so blocks up
+// to 256 bytes are cached.
+#define MEMORY_MAX_THREAD_CACHES   64
+#define MEMORY_CACHE_CLASS_SIZE    16
+#define MEMORY_CACHE_CLASS_COUNT   16
+#define MEMORY_MAGAZINE_SIZE       32
+
+// Every allocation is annotated with a tag so memory use can be broken down by
+// system. memory_alloc uses MemoryTag_Unknown.
+typedef enum memory_tag
+{
+    MemoryTag_Unknown,
+    MemoryTag_Platform,
+    MemoryTag_AssetSys,
+    MemoryTag_String,
+    MemoryTag_DynArray,
+    MemoryTag_Graphics,
+    MemoryTag_CommandPool,
+    MemoryTag_Game,
+    MemoryTag_ThreadCache, // blocks held in thread cache magazines
+
+    MemoryTag_Count,
+} memory_tag;
+
+// Allocation size histogram. Bucket 0 counts allocations below 64 bytes, bucket N
+// counts [2^(N+5), 2^(N+6)) bytes and the last bucket everything above that.
+#define MEMORY_HISTOGRAM_BUCKET_COUNT 16
+
+typedef struct memory_tag_stats
+{
+    u64 LiveBytes;
+    u64 PeakBytes;
+    u64 LiveAllocations;
+    u64 TotalAllocations;
+    u64 SizeHistogram[MEMORY_HISTOGRAM_BUCKET_COUNT];
+} memory_tag_stats;
+
+typedef struct memory_stats
+{
+    u64 HeapSize;
+    u64 HeapTouched;      // bytes between the start of the heap and the break pointer
+    u64 HeapCommitted;
+    u64 UsedMemory;
+    u64 NumAllocations;
+
+    // Free space includes the untouched space after the break pointer
+    u64 FreeMemory;
+    u64 FreeBlockCount;
+    u64 LargestFreeBlock;
+    r32 Fragmentation;    // 1 - LargestFreeBlock / FreeMemory
+
+    memory_tag_stats Tags[MemoryTag_Count];
+} memory_stats;
+
+typedef struct memory_thread_cache
+{
+    struct memory *Memory;
+    u32            Index;
+
+    // Blocks released by threads other than the owner. Lock free stack, the link
+    // is stored in the first 8 bytes of each block.
+    void * volatile RemoteFrees;
+
+    u32   MagazineCount[MEMORY_CACHE_CLASS_COUNT];
+    void *Magazines[MEMORY_CACHE_CLASS_COUNT][MEMORY_MAGAZINE_SIZE];
+} memory_thread_cache;
+
+// Allocation tracing. When built with MEMORY_TRACE, every alloc, realloc and
+// release on a heap with an active trace (see memory_trace_begin) is appended to
+// a binary trace file: a memory_trace_file_header followed by the records.
+typedef enum memory_trace_op
+{
+    MemoryTraceOp_Alloc,
+    MemoryTraceOp_Realloc,
+    MemoryTraceOp_Release,
+    MemoryTraceOp_AllocAligned,
+} memory_trace_op;
+
+#define MEMORY_TRACE_MAGIC        0x4352544D // "MTRC"
+#define MEMORY_TRACE_VERSION      1
+#define MEMORY_TRACE_BUFFER_COUNT 1024
+
+typedef struct memory_trace_file_header
+{
+    u32 Magic;
+    u32 Version;
+    u32 RecordSize;
+    u32 Reserved;
+} memory_trace_file_header;
+
+typedef struct memory_trace_record
+{
+    u64 Timestamp;  // cpu timestamp counter
+    u64 Id;         // address of the block, unique among live blocks
+    u64 OldId;      // realloc: address before the realloc, 0 for realloc(NULL). aligned alloc: the alignment
+    u64 Size : 48;  // requested size
+    u64 Tag  : 8;
+    u64 Op   : 8;
+} memory_trace_record;
+
+// Every module links its own C runtime, so the FILE is only touched through the
+// Flush callback of the module that started the trace.
+typedef struct memory_trace
+{
+    FILE *File;
+    void (*Flush)(struct memory_trace *Trace, bool Close);
+    u32   Count;
+    memory_trace_record Records[MEMORY_TRACE_BUFFER_COUNT];
+} memory_trace;
+
+typedef struct memory_replay_result
+{
+    u64 Operations;
+    u64 Failures;          // allocations that could not be satisfied
+    u64 Skipped;           // releases/reallocs of blocks allocated before the trace started,
+                           // and aligned allocations (and their releases) against malloc
+    u64 Cycles;            // timestamp counter ticks spent inside the allocator
+    u64 PeakFootprint;     // heap: furthest the break pointer got. malloc: peak live bytes
+    u64 PeakLiveBytes;
+    r32 Fragmentation;     // at the end of the trace, before remaining blocks are released
+    r32 PeakFragmentation; // sampled every few thousand operations
+} memory_replay_result;
+
+// Commit/decommit callbacks for a heap backed by a reserved address range, see
+// memory_init_reserved.
+typedef bool (*pfn_memory_commit)(void *Ptr, u64 Size);
+typedef void (*pfn_memory_decommit)(void *Ptr, u64 Size);
+
 typedef struct memory
 {
     u64   Size;
-    
+
     void *Start;
     void *Brkp;
-    
-    header_t FreeList;
-    
+
+    // Pages are committed in CommitGranularity steps as the break pointer advances,
+    // and trailing pages are decommitted when it moves back. For a fully committed
+    // heap Committed is Start + Size and the callbacks are NULL.
+    void               *Committed;
+    pfn_memory_commit   Commit;
+    pfn_memory_decommit Decommit;
+    u64                 CommitGranularity;
+
+    // NULL unless a trace is active
+    memory_trace *Trace;
+
+    // Segregated free lists + occupancy bitmaps
+    u64      FlBitmap;
+    u32      SlBitmap[MEMORY_FL_INDEX_COUNT];
+    header_t FreeLists[MEMORY_FL_INDEX_COUNT][MEMORY_SL_INDEX_COUNT];
+
+    // Guards everything above. Taken by memory_alloc/realloc/release and by
+    // thread caches when they refill or flush.
+    volatile i32         Lock;
+    memory_thread_cache *Caches[MEMORY_MAX_THREAD_CACHES];
+
     // Memory Usage tracking
     u64 NumAllocations;
     u64 UsedMemory;
+    memory_tag_stats TagStats[MemoryTag_Count];
 } memory;
 
 void memory_init(memory *Memory, u64 Size, void *Ptr);
+// Ptr is a reserved, uncommitted address range of Size bytes
+void memory_init_reserved(memory *Memory, u64 Size, void *Ptr,
+                          pfn_memory_commit Commit, pfn_memory_decommit Decommit, u64 CommitGranularity);
 void memory_free(memory *Memory);
 
 void* memory_alloc(memory *Memory, u64 Size);
 void* memory_realloc(memory *Memory, void *Ptr, u64 Size);
 void memory_release(memory *Memory, void *Ptr);
 
+void* memory_alloc_tagged(memory *Memory, u64 Size, memory_tag Tag);
+// Tag is only used when Ptr is NULL, otherwise the block keeps its tag
+void* memory_realloc_tagged(memory *Memory, void *Ptr, u64 Size, memory_tag Tag);
+
+// Align must be a power of two. Blocks are only guaranteed to be 8 byte aligned
+// otherwise. Aligned blocks can also be released with memory_release.
+void* memory_alloc_aligned(memory *Memory, u64 Size, u64 Align);
+void* memory_alloc_aligned_tagged(memory *Memory, u64 Size, u64 Align, memory_tag Tag);
+// Keeps the alignment if the block has to move
+void* memory_realloc_aligned(memory *Memory, void *Ptr, u64 Size, u64 Align);
+void memory_release_aligned(memory *Memory, void *Ptr);
+
+const char* memory_tag_name(memory_tag Tag);
+void memory_get_stats(memory *Memory, memory_stats *Stats);
+// Writes the stats as JSON. Returns the length of the full document (excluding the
+// null terminator) even if it did not fit in the buffer, same as snprintf.
+u64 memory_stats_to_json(memory_stats *Stats, char *Buffer, u64 BufferSize);
+
+// Starts recording to Filename, Trace must stay alive until memory_trace_end.
+// Nothing is recorded unless the engine is built with MEMORY_TRACE.
+bool memory_trace_begin(memory *Memory, memory_trace *Trace, const char *Filename);
+void memory_trace_end(memory *Memory);
+// Runs a trace against Memory, which should be an empty heap. When Memory is NULL
+// the trace runs against malloc/realloc/free instead, which skips aligned allocations.
+bool memory_trace_replay(memory *Memory, const char *Filename, memory_replay_result *Result);
+
+// Per-thread caches in front of the shared heap. A cache must only be used by
+// the thread that created it. Blocks allocated from a cache can be released from
+// any thread (with memory_release or another thread's cache); they are handed
+// back to the owning cache through its return queue. Destroy a cache only once
+// no other thread can still release its blocks.
+memory_thread_cache* memory_thread_cache_create(memory *Memory);
+void memory_thread_cache_free(memory_thread_cache *Cache);
+
+void* memory_cache_alloc(memory_thread_cache *Cache, u64 Size);
+void memory_cache_release(memory_thread_cache *Cache, void *Ptr);
+
 #endif //MEMORY_H
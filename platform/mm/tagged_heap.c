@@ -0,0 +1,146 @@
+
+// The first bytes of every block in use hold the link to the next block of the
+// same tag, allocations start after it.
+#define TAGGED_HEAP_BLOCK_HEADER_SIZE TAGGED_HEAP_ALIGNMENT
+
+void tagged_heap_init(tagged_heap *Heap, u64 Size, void *Ptr)
+{
+    Heap->Start         = (char*)Ptr;
+    Heap->BlockCount    = (Ptr) ? (u32)(Size / TAGGED_HEAP_BLOCK_SIZE) : 0;
+    Heap->Size          = Heap->BlockCount * TAGGED_HEAP_BLOCK_SIZE;
+    Heap->BlocksTouched = 0;
+    Heap->BlocksInUse   = 0;
+    Heap->FreeBlocks    = NULL;
+    
+    memset(Heap->Tags, 0, sizeof(Heap->Tags));
+    memset(Heap->TagBlocks, 0, sizeof(Heap->TagBlocks));
+}
+
+void tagged_heap_free(tagged_heap *Heap)
+{
+    if (Heap->BlocksInUse)
+    {
+        printf("Freeing the Tagged Heap, but there are still %d blocks in use.\n", Heap->BlocksInUse);
+    }
+    
+    Heap->Start         = NULL;
+    Heap->Size          = 0;
+    Heap->BlockCount    = 0;
+    Heap->BlocksTouched = 0;
+    Heap->BlocksInUse   = 0;
+    Heap->FreeBlocks    = NULL;
+    
+    memset(Heap->Tags, 0, sizeof(Heap->Tags));
+    memset(Heap->TagBlocks, 0, sizeof(Heap->TagBlocks));
+}
+
+tag_block tagged_heap_request_block(tagged_heap *Heap, u64 Tag)
+{
+    tag_block Result = {0};
+    
+    // Find the tag's chain, or an empty slot to start one
+    u32 TagIdx = TAGGED_HEAP_MAX_TAGS;
+    for (u32 Idx = 0; Idx < TAGGED_HEAP_MAX_TAGS; ++Idx)
+    {
+        if (Heap->TagBlocks[Idx] && Heap->Tags[Idx] == Tag)
+        {
+            TagIdx = Idx;
+            break;
+        }
+        else if (!Heap->TagBlocks[Idx] && TagIdx == TAGGED_HEAP_MAX_TAGS)
+        {
+            TagIdx = Idx;
+        }
+    }
+    
+    if (TagIdx == TAGGED_HEAP_MAX_TAGS)
+    {
+        // TODO(Dustin): Log
+        printf("Unable to request a block from the Tagged Heap: more than %d tags are in use!\n", TAGGED_HEAP_MAX_TAGS);
+        return Result;
+    }
+    
+    char *Block = NULL;
+    if (Heap->FreeBlocks)
+    {
+        Block = (char*)Heap->FreeBlocks;
+        Heap->FreeBlocks = *(void**)Block;
+    }
+    else if (Heap->BlocksTouched < Heap->BlockCount)
+    {
+        Block = Heap->Start + (u64)Heap->BlocksTouched++ * TAGGED_HEAP_BLOCK_SIZE;
+    }
+    else
+    {
+        // TODO(Dustin): Log
+        printf("Unable to request a block from the Tagged Heap: all %d blocks are in use!\n", Heap->BlockCount);
+        return Result;
+    }
+    
+    *(void**)Block          = Heap->TagBlocks[TagIdx];
+    Heap->TagBlocks[TagIdx] = Block;
+    Heap->Tags[TagIdx]      = Tag;
+    Heap->BlocksInUse++;
+    
+    Result.Heap  = Heap;
+    Result.Tag   = Tag;
+    Result.Start = Block + TAGGED_HEAP_BLOCK_HEADER_SIZE;
+    Result.Brkp  = Result.Start;
+    Result.End   = Block + TAGGED_HEAP_BLOCK_SIZE;
+    
+    return Result;
+}
+
+void* tagged_heap_block_alloc(tag_block_t Block, u64 Size)
+{
+    if (!Block->Heap || Size == 0) return NULL;
+    
+    if (Size > TAGGED_HEAP_BLOCK_SIZE - TAGGED_HEAP_BLOCK_HEADER_SIZE)
+    {
+        // TODO(Dustin): Log
+        printf("Requesting %lld bytes from the Tagged Heap, which is larger than a block!\n", Size);
+        return NULL;
+    }
+    
+    char *Result = (char*)memory_align((uptr)Block->Brkp, TAGGED_HEAP_ALIGNMENT);
+    if (Result + Size > Block->End)
+    {
+        // Block is full, continue in a new block with the same tag
+        tag_block NewBlock = tagged_heap_request_block(Block->Heap, Block->Tag);
+        if (!NewBlock.Heap) return NULL;
+        
+        *Block = NewBlock;
+        Result = Block->Brkp;
+    }
+    
+    Block->Brkp = Result + Size;
+    
+    return Result;
+}
+
+void tagged_heap_free_tag(tagged_heap *Heap, u64 Tag)
+{
+    for (u32 TagIdx = 0; TagIdx < TAGGED_HEAP_MAX_TAGS; ++TagIdx)
+    {
+        if (Heap->TagBlocks[TagIdx] && Heap->Tags[TagIdx] == Tag)
+        {
+            void *Block = Heap->TagBlocks[TagIdx];
+            while (Block)
+            {
+                void *Next = *(void**)Block;
+                
+                *(void**)Block   = Heap->FreeBlocks;
+                Heap->FreeBlocks = Block;
+                Heap->BlocksInUse--;
+                
+                Block = Next;
+            }
+            
+            Heap->TagBlocks[TagIdx] = NULL;
+            Heap->Tags[TagIdx]      = 0;
+            break;
+        }
+    }
+}
+
+#undef TAGGED_HEAP_BLOCK_HEADER_SIZE
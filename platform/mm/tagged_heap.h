@@ -0,0 +1,65 @@
+#ifndef ENGINE_MM_TAGGED_HEAP_H
+#define ENGINE_MM_TAGGED_HEAP_H
+
+// Block allocator for memory with a shared lifetime. The heap is split into large
+// blocks that are handed out to a tag (a level, an asset batch, ...). Allocations
+// inside a block are bump allocated and are never freed individually. Instead,
+// tagged_heap_free_tag returns every block owned by a tag at once.
+//
+// NOTE(Dustin): The heap is not thread safe. A tag_block must only be used by
+// one thread at a time.
+#define TAGGED_HEAP_BLOCK_SIZE  _2MB
+#define TAGGED_HEAP_MAX_TAGS    32
+#define TAGGED_HEAP_ALIGNMENT   16
+
+// Tags are plain ids, systems are free to add their own after TaggedHeapTag_User.
+typedef enum tagged_heap_tag
+{
+    TaggedHeapTag_Platform,
+    TaggedHeapTag_Level,
+    TaggedHeapTag_AssetBatch,
+    
+    TaggedHeapTag_User,
+} tagged_heap_tag;
+
+// A bump allocator on the block most recently handed to a tag. When the block is
+// full, tagged_heap_block_alloc requests another block with the same tag.
+typedef struct tag_block
+{
+    struct tagged_heap *Heap;
+    u64                 Tag;
+    
+    char *Start;
+    char *Brkp;
+    char *End;
+} tag_block;
+
+typedef tag_block* tag_block_t;
+
+typedef struct tagged_heap
+{
+    u64   Size;
+    char *Start;
+    
+    u32   BlockCount;
+    u32   BlocksTouched;  // blocks below this index have been handed out at least once
+    u32   BlocksInUse;
+    
+    // Released blocks, linked through the first bytes of each block
+    void *FreeBlocks;
+    
+    // Blocks owned by each tag, linked the same way
+    u64   Tags[TAGGED_HEAP_MAX_TAGS];
+    void *TagBlocks[TAGGED_HEAP_MAX_TAGS];
+} tagged_heap;
+
+void tagged_heap_init(tagged_heap *Heap, u64 Size, void *Ptr);
+void tagged_heap_free(tagged_heap *Heap);
+
+tag_block tagged_heap_request_block(tagged_heap *Heap, u64 Tag);
+void* tagged_heap_block_alloc(tag_block_t Block, u64 Size);
+// Returns every block owned by Tag to the heap. All tag_blocks for this tag are
+// invalid afterwards.
+void tagged_heap_free_tag(tagged_heap *Heap, u64 Tag);
+
+#endif //ENGINE_MM_TAGGED_HEAP_H
@@ -3,18 +3,54 @@ globals *Core;
 
 void globals_init(globals_create_info *CreateInfo)
 {
-    void *PlatformMemory = PlatformRequestMemory(CreateInfo->Memory.Size);
-    
     memory Memory = {0};
-    memory_init(&Memory, CreateInfo->Memory.Size, PlatformMemory);
+    void *PlatformMemory = NULL;
+    
+    if (CreateInfo->Memory.UseLargePages)
+    {
+        PlatformMemory = PlatformRequestLargePageMemory(CreateInfo->Memory.Size);
+        if (PlatformMemory)
+            memory_init(&Memory, CreateInfo->Memory.Size, PlatformMemory);
+        else
+            mprinte("Large pages are not available, falling back to regular pages for the heap.\n");
+    }
     
-    memory *pMemory = (memory*)memory_alloc(&Memory, sizeof(memory));
+    if (!PlatformMemory)
+    {
+        PlatformMemory = PlatformReserveMemory(CreateInfo->Memory.Size);
+        memory_init_reserved(&Memory, CreateInfo->Memory.Size, PlatformMemory,
+                             PlatformCommitMemory, PlatformDecommitMemory, CreateInfo->Memory.CommitSize);
+    }
+    
+    memory *pMemory = (memory*)memory_alloc_tagged(&Memory, sizeof(memory), MemoryTag_Platform);
     *pMemory = Memory;
     
-    Core = (globals*)memory_alloc(pMemory, sizeof(globals));
+    Core = (globals*)memory_alloc_tagged(pMemory, sizeof(globals), MemoryTag_Platform);
     Core->Memory = pMemory;
     
-    Core->AssetSys = (assetsys*)memory_alloc(Core->Memory, sizeof(assetsys));
+#if defined(MEMORY_TRACE)
+    memory_trace *Trace = (memory_trace*)memory_alloc_tagged(Core->Memory, sizeof(memory_trace), MemoryTag_Platform);
+    memory_trace_begin(Core->Memory, Trace, "memory_trace.bin");
+#endif
+    
+    void *FrameArenaMemory = PlatformRequestMemory(CreateInfo->Memory.FrameArenaSize * FRAME_ARENA_FRAME_COUNT);
+    Core->FrameArena = (frame_arena*)memory_alloc_tagged(Core->Memory, sizeof(frame_arena), MemoryTag_Platform);
+    frame_arena_init(Core->FrameArena, CreateInfo->Memory.FrameArenaSize, FrameArenaMemory);
+    
+    void *TaggedHeapMemory = PlatformRequestMemory(CreateInfo->Memory.TaggedHeapSize);
+    Core->TaggedHeap = (tagged_heap*)memory_alloc_tagged(Core->Memory, sizeof(tagged_heap), MemoryTag_Platform);
+    tagged_heap_init(Core->TaggedHeap, CreateInfo->Memory.TaggedHeapSize, TaggedHeapMemory);
+    
+    Core->CompactHeap = NULL;
+    if (CreateInfo->Memory.CompactHeapSize)
+    {
+        void *CompactHeapMemory = PlatformRequestMemory(CreateInfo->Memory.CompactHeapSize);
+        Core->CompactHeap = (compact_heap*)memory_alloc_tagged(Core->Memory, sizeof(compact_heap), MemoryTag_Platform);
+        compact_heap_init(Core->CompactHeap, CreateInfo->Memory.CompactHeapSize, CompactHeapMemory,
+                          CreateInfo->Memory.CompactHeapHandles, PlatformGetWallClock);
+    }
+    
+    Core->AssetSys = (assetsys*)memory_alloc_tagged(Core->Memory, sizeof(assetsys), MemoryTag_AssetSys);
     assetsys_init(Core->AssetSys, (char*)CreateInfo->AssetSystem.ExecutablePath);
     
     mstr ExeDirectory = Win32GetExeFilepath();
@@ -36,6 +72,32 @@ void globals_free()
     assetsys_free(Core->AssetSys);
     memory_release(Core->Memory, Core->AssetSys);
     
+    PlatformReleaseMemory(Core->FrameArena->Start, 0);
+    frame_arena_free(Core->FrameArena);
+    memory_release(Core->Memory, Core->FrameArena);
+    
+    if (Core->CompactHeap)
+    {
+        PlatformReleaseMemory(Core->CompactHeap->Slots, 0);
+        compact_heap_free(Core->CompactHeap);
+        memory_release(Core->Memory, Core->CompactHeap);
+        Core->CompactHeap = NULL;
+    }
+    
+    PlatformLocalAllocReset();
+    tagged_heap_free_tag(Core->TaggedHeap, TaggedHeapTag_Platform);
+    
+    PlatformReleaseMemory(Core->TaggedHeap->Start, 0);
+    tagged_heap_free(Core->TaggedHeap);
+    memory_release(Core->Memory, Core->TaggedHeap);
+    Core->TaggedHeap = NULL;
+    
+#if defined(MEMORY_TRACE)
+    memory_trace *Trace = Core->Memory->Trace;
+    memory_trace_end(Core->Memory);
+    memory_release(Core->Memory, Trace);
+#endif
+    
     memory Memory = *Core->Memory;
     void *MemoryPtr = Memory.Start;;
     
@@ -3,7 +3,13 @@
 
 typedef struct 
 {
-    u64 Size;
+    u64 Size;           // address space reserved for the heap, pages are committed on use
+    u64 CommitSize;     // granularity pages are committed/decommitted with
+    bool UseLargePages; // commit the whole heap up front using large pages
+    u64 FrameArenaSize; // size of a single frame's region in the frame arena
+    u64 TaggedHeapSize;
+    u64 CompactHeapSize;    // 0 disables the compacting heap
+    u32 CompactHeapHandles;
 } memory_create_info;
 
 typedef struct
@@ -32,8 +38,11 @@ typedef struct
 
 typedef struct
 {
-    struct memory   *Memory;
-    struct assetsys *AssetSys;
+    struct memory       *Memory;
+    struct frame_arena  *FrameArena;
+    struct tagged_heap  *TaggedHeap;
+    struct compact_heap *CompactHeap; // NULL unless enabled in memory_create_info
+    struct assetsys     *AssetSys;
 } globals;
 
 extern globals *Core;
@@ -93,6 +93,12 @@ typedef enum
 // (i.e. VirtualAlloc or mmap)
 void* PlatformRequestMemory(u64 Size);
 void PlatformReleaseMemory(void *Ptr, u64 Size);
+// Reserve address space and commit/decommit pages within it
+void* PlatformReserveMemory(u64 Size);
+bool PlatformCommitMemory(void *Ptr, u64 Size);
+void PlatformDecommitMemory(void *Ptr, u64 Size);
+// Committed up front. Returns NULL if large pages are unavailable.
+void* PlatformRequestLargePageMemory(u64 Size);
 
 //~ Log/Printing
 #define mformat PlatformFormatString
@@ -107,6 +113,9 @@ void PlatformPrintError(console_color text_color, console_color background_color
 
 // opens an error window with the formatted message and then exits the application
 void PlatformFatalError(char *Fmt, ...);
+// Drops the tagged heap block the print/format functions allocate from. Must be
+// called before the TaggedHeapTag_Platform blocks are freed.
+void PlatformLocalAllocReset();
 
 
 //~ File I/O
@@ -188,6 +197,8 @@ window_rect PlatformGetClientWindowRect();
 // System Memory allocations
 typedef void* (*pfn_platform_request_memory)(u64 Size);
 typedef void (*pfn_platform_release_memory)(void *Ptr, u64 Size);
+// Scratch for print/format functions, see PlatformLocalAlloc
+typedef void* (*pfn_platform_local_alloc)(u32 Size);
 
 // get window information
 typedef void (*pfn_get_client_window_dimensions)(u32 *Width, u32 *Height);
@@ -207,10 +218,19 @@ typedef void (*pfn_platform_mprint)(char *Fmt, ...);
 typedef struct platform
 {
     struct memory                   *Memory;
+    // Per-frame scratch memory, reset by the renderer at the end of each frame
+    struct frame_arena              *FrameArena;
+    // Block allocator for memory with a shared lifetime (levels, asset batches, ...)
+    struct tagged_heap              *TaggedHeap;
+    // Relocatable objects referenced through handles, NULL when disabled
+    struct compact_heap             *CompactHeap;
     
     // System Memory Allocation
     pfn_platform_request_memory      request_memory;
     pfn_platform_release_memory      release_memory;
+    // The dlls share the platform's allocator, so a single PlatformLocalAlloc
+    // requests TaggedHeapTag_Platform blocks
+    pfn_platform_local_alloc         local_alloc;
     
     // Acquire window information
     pfn_get_client_window_dimensions get_client_window_dimensions;
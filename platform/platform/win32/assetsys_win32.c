@@ -256,15 +256,15 @@ void assetsys_init(assetsys *AssetSys, char *Root)
     // Setup the file_pool major list
     AssetSys->FilePoolCount = 1;
     AssetSys->FilePoolCap   = 1;
-    AssetSys->FilePool = (assetsys_file_pool*)memory_alloc(Core->Memory, 
-                                                           sizeof(assetsys_file_pool) * AssetSys->FilePoolCap);
+    AssetSys->FilePool = (assetsys_file_pool*)memory_alloc_tagged(Core->Memory, 
+                                                                  sizeof(assetsys_file_pool) * AssetSys->FilePoolCap, MemoryTag_AssetSys);
     assetsys_file_pool_init(AssetSys->FilePool + 0);
     
     // Setup the Mounted files list
     AssetSys->MountedFilesCap   = 10;
     AssetSys->MountedFilesCount = 0;
-    AssetSys->MountedFiles = memory_alloc(Core->Memory, 
-                                          AssetSys->MountedFilesCap * sizeof(assetsys_mount_point));
+    AssetSys->MountedFiles = memory_alloc_tagged(Core->Memory, 
+                                                 AssetSys->MountedFilesCap * sizeof(assetsys_mount_point), MemoryTag_AssetSys);
     
     for (u32 i = 0; i < AssetSys->MountedFilesCap; ++i)
     {
@@ -372,7 +372,7 @@ file_internal assetsys_file_id assetsys_insert_file_in_tree(assetsys *AssetSys,
     Result = assetsys_file_init(AssetSys, Filename, FilenameLen, true, Directory, DirectoryLen);
     
     // Insert the new file into the asset list
-    assetsys_file_id *ChildFilesCpy = memory_alloc(Core->Memory, sizeof(assetsys_file_id) * File->ChildFileCount + 1);
+    assetsys_file_id *ChildFilesCpy = memory_alloc_tagged(Core->Memory, sizeof(assetsys_file_id) * File->ChildFileCount + 1, MemoryTag_AssetSys);
     memcpy(ChildFilesCpy, File->ChildFiles, sizeof(assetsys_file_id) * File->ChildFileCount);
     File->ChildFiles[File->ChildFileCount++] = Result;
     
@@ -405,7 +405,7 @@ void assetsys_mount(assetsys *AssetSys, const char *Filename, const char *MountN
     if (AssetSys->MountedFilesCount + 1 > AssetSys->MountedFilesCap)
     {
         u32 NewCap = AssetSys->MountedFilesCap * 2;
-        assetsys_mount_point *MountedFiles = memory_alloc(Core->Memory, sizeof(assetsys_mount_point) * NewCap);
+        assetsys_mount_point *MountedFiles = memory_alloc_tagged(Core->Memory, sizeof(assetsys_mount_point) * NewCap, MemoryTag_AssetSys);
         
         for (u32 i = 0; i < AssetSys->MountedFilesCount; ++i) MountedFiles[i] = AssetSys->MountedFiles[i];
         memory_release(Core->Memory, AssetSys->MountedFiles);
@@ -453,7 +453,7 @@ void assetsys_mountr(assetsys *AssetSys, const char *Filename, const char *Mount
     comparator_list CompList = {0};
     CompList.Count = Count;
     CompList.Idx = 0;
-    CompList.Comparators = memory_alloc(Core->Memory, CompList.Count * sizeof(u128));
+    CompList.Comparators = memory_alloc_tagged(Core->Memory, CompList.Count * sizeof(u128), MemoryTag_AssetSys);
     
     pch = NULL;
     pch = strchr(Filename, '/');
@@ -481,7 +481,7 @@ void assetsys_mountr(assetsys *AssetSys, const char *Filename, const char *Mount
         if (AssetSys->MountedFilesCount + 1 > AssetSys->MountedFilesCap)
         {
             u32 NewCap = AssetSys->MountedFilesCap * 2;
-            assetsys_mount_point *MountedFiles = memory_alloc(Core->Memory, sizeof(assetsys_mount_point) * NewCap);
+            assetsys_mount_point *MountedFiles = memory_alloc_tagged(Core->Memory, sizeof(assetsys_mount_point) * NewCap, MemoryTag_AssetSys);
             
             for (u32 i = 0; i < AssetSys->MountedFilesCount; ++i) MountedFiles[i] = AssetSys->MountedFiles[i];
             memory_release(Core->Memory, AssetSys->MountedFiles);
@@ -541,8 +541,8 @@ file_internal assetsys_file_id assetsys_allocate_file(assetsys *AssetSys, assets
         {
             u32 NewCap = AssetSys->FilePoolCap;
             NewCap = (NewCap > MAX_ASSETSYS_POOL_COUNT) ? MAX_ASSETSYS_POOL_COUNT : NewCap; 
-            assetsys_file_pool *FilePool = (assetsys_file_pool*)memory_alloc(Core->Memory, 
-                                                                             sizeof(assetsys_file_pool) * NewCap);
+            assetsys_file_pool *FilePool = (assetsys_file_pool*)memory_alloc_tagged(Core->Memory, 
+                                                                                    sizeof(assetsys_file_pool) * NewCap, MemoryTag_AssetSys);
             
             for (u32 i = 0; i < AssetSys->FilePoolCount; ++i) FilePool[i] = AssetSys->FilePool[i];
             
@@ -600,7 +600,7 @@ file_internal void assetsys_file_init_recurse_directory(assetsys *AssetSys, asse
     FindClose(Handle);
     
     ParentFile->ChildFileCount = ChildCount;
-    ParentFile->ChildFiles = (assetsys_file_id*)memory_alloc(Core->Memory, sizeof(assetsys_file_id) * ParentFile->ChildFileCount);
+    ParentFile->ChildFiles = (assetsys_file_id*)memory_alloc_tagged(Core->Memory, sizeof(assetsys_file_id) * ParentFile->ChildFileCount, MemoryTag_AssetSys);
     
     // Now, load the files
     ChildCount = 0;
@@ -750,8 +750,8 @@ file_internal void assetsys_file_free(assetsys_file *File)
 
 file_internal void assetsys_file_pool_init(assetsys_file_pool *FilePool)
 {
-    FilePool->Handles = (assetsys_file_t)memory_alloc(Core->Memory, 
-                                                      sizeof(assetsys_file) * MAX_ASSETSYS_POOL_FILE_COUNT);
+    FilePool->Handles = (assetsys_file_t)memory_alloc_tagged(Core->Memory, 
+                                                             sizeof(assetsys_file) * MAX_ASSETSYS_POOL_FILE_COUNT, MemoryTag_AssetSys);
     
     FilePool->AllocatedFiles = 0;
     
@@ -819,7 +819,7 @@ file_internal void assetsys_build_comparator_list(comparator_list *List, const c
     // Build the comparator list
     List->Count = Count;
     List->Idx = 0;
-    List->Comparators = memory_alloc(Core->Memory, List->Count * sizeof(u128));
+    List->Comparators = memory_alloc_tagged(Core->Memory, List->Count * sizeof(u128), MemoryTag_AssetSys);
     
     pch = NULL;
     pch = strchr(Filepath, '/');
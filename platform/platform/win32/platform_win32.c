@@ -43,6 +43,9 @@ file_global input GlobalPerFrameInput;
 // Frame Info
 file_global u64 FrameCount = 0;
 
+// Seconds per frame the compact heap defragmenter is allowed to run
+file_global r64 CompactHeapFrameBudget = 0.0005;
+
 typedef struct library_code
 {
     HMODULE           GraphicsHandle;
@@ -111,6 +114,10 @@ file_internal void DisplayError(LPTSTR lpszFunction)
     LocalFree(lpDisplayBuf);
 }
 
+file_global tag_block PlatformHeap;
+// mprint/mprinte are handed to the dlls and called from the render workers
+file_global SRWLOCK   PlatformHeapLock = SRWLOCK_INIT;
+
 // An internal allocation scheme that allocates from the 2MB Platform Linear allcoator.
 // this functions is primarily used by print/formatting functions that need temporary,
 // dynamic memory. When the heap is filled, the allocator is reset.
@@ -118,29 +125,39 @@ file_internal void* PlatformLocalAlloc(u32 Size)
 {
     void* Result = NULL;
     
-#if 0
-    if (!PlatformHeap.Start)
-        PlatformHeap = TaggedHeapRequestAllocation(&Core->TaggedHeap, PlatformTag);
-    
-    Result = TaggedHeapBlockAlloc(&PlatformHeap, Size);
-    if (!Result)
+    if (Core && Core->TaggedHeap)
     {
-        PlatformHeap.Brkp = PlatformHeap.Start;
+        AcquireSRWLockExclusive(&PlatformHeapLock);
+        
+        if (!PlatformHeap.Start)
+            PlatformHeap = tagged_heap_request_block(Core->TaggedHeap, TaggedHeapTag_Platform);
+        
+        // Start over rather than letting the block grow into a new one
+        if ((char*)memory_align((uptr)PlatformHeap.Brkp, TAGGED_HEAP_ALIGNMENT) + Size > PlatformHeap.End)
+            PlatformHeap.Brkp = PlatformHeap.Start;
         
-        Result = TaggedHeapBlockAlloc(&PlatformHeap, Size);
-        if (!Result)
-            mprinte("Error allocating from Platform Heap Allocator!\n");
+        Result = tagged_heap_block_alloc(&PlatformHeap, Size);
+        
+        ReleaseSRWLockExclusive(&PlatformHeapLock);
     }
-#else
     
-    // TODO(Dustin): Temporary fix for not having a tagged heap/string right now
-    Result = malloc(Size);
-    
-#endif
+    if (!Result)
+    {
+        // NOTE(Dustin): The tagged heap is not available (yet). These allocations
+        // are never released.
+        Result = malloc(Size);
+    }
     
     return Result;
 }
 
+void PlatformLocalAllocReset()
+{
+    AcquireSRWLockExclusive(&PlatformHeapLock);
+    PlatformHeap = (tag_block){0};
+    ReleaseSRWLockExclusive(&PlatformHeapLock);
+}
+
 void PlatformFatalError(char *Fmt, ...)
 {
     va_list Args;
@@ -191,7 +208,7 @@ file_internal void Win32LoadGraphicsCode(const char *GraphicsDllName)
         PlatformFatalError("Could not load the graphics dll!");
     }
     
-    Graphics = (graphics_api*)memory_alloc(Core->Memory, sizeof(graphics_api));
+    Graphics = (graphics_api*)memory_alloc_tagged(Core->Memory, sizeof(graphics_api), MemoryTag_Platform);
     
 #define GRAPHICS_EXPORTED_FUNCTION(fun)                                     \
     if (!(Graphics->fun = (PFN_##fun)GetProcAddress(GraphicsDll, #fun))) {            \
@@ -222,7 +239,7 @@ file_internal void Win32LoadGameCode(const char *GameDllName)
         PlatformFatalError("Could not load the graphics dll!");
     }
     
-    Game = (game_api*)memory_alloc(Core->Memory, sizeof(game_api));
+    Game = (game_api*)memory_alloc_tagged(Core->Memory, sizeof(game_api), MemoryTag_Platform);
     
 #define GAME_EXPORTED_FUNCTION(fun)                                     \
     if (!(Game->fun = (PFN_##fun)GetProcAddress(GameDll, #fun))) {            \
@@ -1314,6 +1331,58 @@ void* PlatformRequestMemory(u64 Size)
     return lpvBase;
 }
 
+// Reserves address space without committing any pages. Pages are committed
+// with PlatformCommitMemory before they are touched.
+void* PlatformReserveMemory(u64 Size)
+{
+    SYSTEM_INFO sSysInfo;
+    GetSystemInfo(&sSysInfo);
+    
+    u64 Granularity = (u64)sSysInfo.dwAllocationGranularity;
+    u64 ActualSize  = (Size + Granularity - 1) & ~(Granularity - 1);
+    
+    return VirtualAlloc(NULL, ActualSize, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool PlatformCommitMemory(void *Ptr, u64 Size)
+{
+    return VirtualAlloc(Ptr, Size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+void PlatformDecommitMemory(void *Ptr, u64 Size)
+{
+    BOOL bSuccess = VirtualFree(Ptr, Size, MEM_DECOMMIT);
+    assert(bSuccess && "Unable to decommit a VirtualAlloc allocation!");
+}
+
+// Large pages are locked in physical memory and cannot be committed lazily, so
+// the whole range is committed up front. Requires the "Lock pages in memory"
+// privilege for the user, returns NULL if large pages are not available.
+void* PlatformRequestLargePageMemory(u64 Size)
+{
+    u64 LargePageSize = (u64)GetLargePageMinimum();
+    if (LargePageSize == 0)
+        return NULL;
+    
+    HANDLE Token;
+    if (OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES|TOKEN_QUERY, &Token))
+    {
+        TOKEN_PRIVILEGES Privileges = {0};
+        Privileges.PrivilegeCount           = 1;
+        Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+        
+        if (LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &Privileges.Privileges[0].Luid))
+        {
+            AdjustTokenPrivileges(Token, FALSE, &Privileges, 0, NULL, NULL);
+        }
+        
+        CloseHandle(Token);
+    }
+    
+    u64 ActualSize = (Size + LargePageSize - 1) & ~(LargePageSize - 1);
+    return VirtualAlloc(NULL, ActualSize, MEM_COMMIT|MEM_RESERVE|MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
 void PlatformReleaseMemory(void *Ptr, u64 Size)
 {
     BOOL bSuccess = VirtualFree(Ptr,           // Base address of block
@@ -1367,9 +1436,39 @@ void PlatformGetClientWindow(platform_window **Window)
     *Win32Window = &ClientWindow;
 }
 
+// Writes the heap statistics as JSON next to the executable, so the size of the
+// heap can be picked from real usage.
+file_internal void Win32DumpMemoryStats(char *Filename)
+{
+    memory_stats Stats;
+    memory_get_stats(Core->Memory, &Stats);
+    
+    u64 JsonSize = memory_stats_to_json(&Stats, NULL, 0) + 1;
+    char *Json = (char*)memory_alloc_tagged(Core->Memory, JsonSize, MemoryTag_Platform);
+    memory_stats_to_json(&Stats, Json, JsonSize);
+    
+    mstr Path = Win32NormalizePath(Filename);
+    HANDLE File = CreateFileA(mstr_to_cstr(&Path), GENERIC_WRITE, 0, 0, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, 0);
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        DWORD BytesWritten;
+        WriteFile(File, Json, (DWORD)(JsonSize - 1), &BytesWritten, NULL);
+        CloseHandle(File);
+    }
+    else
+    {
+        mprinte("Unable to write the memory stats to \"%s\"!\n", mstr_to_cstr(&Path));
+    }
+    
+    mstr_free(&Path);
+    memory_release(Core->Memory, Json);
+}
+
 file_internal void MapleShutdown()
 {
     Graphics->shutdown_graphics();
+    Win32DumpMemoryStats("memory_stats.json");
     globals_free();
 }
 
@@ -1431,7 +1530,13 @@ INT WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine,
     };
     
     globals_create_info GlobalInfo = {0};
-    GlobalInfo.Memory.Size                  = _MB(400);
+    GlobalInfo.Memory.Size                  = _GB(1);
+    GlobalInfo.Memory.CommitSize            = _MB(1);
+    GlobalInfo.Memory.UseLargePages         = false;
+    GlobalInfo.Memory.FrameArenaSize        = _MB(4);
+    GlobalInfo.Memory.TaggedHeapSize        = _MB(64);
+    GlobalInfo.Memory.CompactHeapSize       = _MB(32);
+    GlobalInfo.Memory.CompactHeapHandles    = 1 << 16;
     GlobalInfo.AssetSystem.ExecutablePath   = NULL;
     GlobalInfo.AssetSystem.MountPoints      = MountInfos;
     GlobalInfo.AssetSystem.MountPointsCount = sizeof(MountInfos)/sizeof(MountInfos[0]);
@@ -1450,8 +1555,11 @@ INT WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine,
     
     file_load("simple_tri.vert", true, "shaders", Buffer, BufferSize);
     
-    PlatformApi = (platform*)memory_alloc(Core->Memory, sizeof(platform));
+    PlatformApi = (platform*)memory_alloc_tagged(Core->Memory, sizeof(platform), MemoryTag_Platform);
     PlatformApi->Memory          = Core->Memory;
+    PlatformApi->FrameArena      = Core->FrameArena;
+    PlatformApi->TaggedHeap      = Core->TaggedHeap;
+    PlatformApi->CompactHeap     = Core->CompactHeap;
     PlatformApi->open_file       = &file_open;
     PlatformApi->load_file       = &file_load;
     PlatformApi->close_file      = &file_close;
@@ -1463,6 +1571,7 @@ INT WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine,
     PlatformApi->get_client_window = &PlatformGetClientWindow;
     PlatformApi->request_memory = PlatformRequestMemory;
     PlatformApi->release_memory = PlatformReleaseMemory;
+    PlatformApi->local_alloc    = PlatformLocalAlloc;
     
     //~ Load game code
     
@@ -1550,6 +1659,13 @@ INT WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR lpCmdLine,
         
         FrameCount++;
         
+        //~ Spend a small slice of the frame compacting the relocatable heap
+        if (Core->CompactHeap)
+        {
+            u64 Deadline = PlatformGetWallClock() + (u64)(GlobalPerfCountFrequency * CompactHeapFrameBudget);
+            compact_heap_defragment(Core->CompactHeap, Deadline);
+        }
+        
         //#endif
         
 #if 0
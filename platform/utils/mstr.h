@@ -41,7 +41,7 @@ mstr mstr_init(char *Cstr, u32 CstrLen)
         if (CstrLen > 11)
         {
             Result.HeapSize = CstrLen + 1;
-            Result.Heap = (char*)memory_alloc(Core->Memory, CstrLen + 1);
+            Result.Heap = (char*)memory_alloc_tagged(Core->Memory, CstrLen + 1, MemoryTag_String);
             memcpy(Result.Heap, Cstr, Result.Len);
             Result.Heap[Result.Len] = 0;
         }
@@ -77,7 +77,7 @@ mstr mstr_add(mstr *Left, mstr *Right)
         if (Result.Len > 11)
         {
             Result.HeapSize = Result.Len + 1;
-            Result.Heap = (char*)memory_alloc(Core->Memory, Result.HeapSize);
+            Result.Heap = (char*)memory_alloc_tagged(Core->Memory, Result.HeapSize, MemoryTag_String);
             
             memcpy(Result.Heap, mstr_to_cstr(Left), Left->Len);
             memcpy(Result.Heap + Left->Len, mstr_to_cstr(Right), Right->Len);
@@ -119,7 +119,7 @@ mstr cstr_add(char *Left, u32 LeftLen, char *Right, u32 RightLen)
         if (Result.Len > 11)
         {
             Result.HeapSize = Result.Len + 1;
-            Result.Heap = (char*)memory_alloc(Core->Memory, Result.HeapSize);
+            Result.Heap = (char*)memory_alloc_tagged(Core->Memory, Result.HeapSize, MemoryTag_String);
             
             memcpy(Result.Heap, Left, LeftLen);
             memcpy(Result.Heap + LeftLen, Right, RightLen);
@@ -454,7 +454,7 @@ CREDITS
 #endif
 #if !defined(STBDS_REALLOC) && !defined(STBDS_FREE)
 //#include <stdlib.h>
-#define STBDS_REALLOC(c,p,s) memory_realloc(Core->Memory, p,s)
+#define STBDS_REALLOC(c,p,s) memory_realloc_tagged(Core->Memory, p,s, MemoryTag_DynArray)
 #define STBDS_FREE(c,p)      memory_release(Core->Memory, p)
 #endif
 
@@ -71,6 +71,14 @@ typedef union quaternion
     struct { vec3 xyz; r32 p0; };
 } quaternion;
 
+// Object transforms with one array per component, see mat4_compose_soa
+typedef struct transform_soa
+{
+    r32 *PositionX, *PositionY, *PositionZ;
+    r32 *ScaleX,    *ScaleY,    *ScaleZ;
+    r32 *RotationX, *RotationY, *RotationZ, *RotationW;
+} transform_soa;
+
 
 //----------------------------------------------------------------------------------------//
 // Pre-declarations
@@ -113,6 +121,11 @@ file_internal mat4 translate(vec3 trans);
 file_internal mat4 look_at(vec3 eye, vec3 center, vec3 up);
 file_internal mat4 perspective_projection(r32 fov, r32 aspect_ratio, r32 near, r32 far);
 
+//~ Model Matrices
+
+file_internal mat4 mat4_compose(vec3 Position, vec3 Scale, quaternion Rotation);
+file_internal void mat4_compose_soa(transform_soa *In, u32 Count, void *Out, u32 Stride);
+
 //~ Interpolation
 
 file_internal r32 clamp(r32 min, r32 max, r32 val);
@@ -194,6 +207,10 @@ Quaternion conjugate(const Quaternion& q);
 
 #if defined(MAPLE_VECTOR_MATH_IMPLEMENTATION)
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MAPLE_VECTOR_MATH_SSE
+#include <xmmintrin.h>
+#endif
 
 //----------------------------------------------------------------------------------------//
 
@@ -625,6 +642,134 @@ file_internal mat4 perspective_projection(r32 fov, r32 aspect_ratio, r32 near_pl
 }
 
 
+// Same matrix as mat4_mul(mat4_mul(scale, rotation), translate) without building
+// the three matrices. The translation is applied first, then the rotation and
+// then the scale.
+file_internal mat4 mat4_compose(vec3 Position, vec3 Scale, quaternion Rotation)
+{
+    mat4 Result = quaternion_get_rotation_matrix(Rotation);
+    
+    vec3 Translation;
+    Translation.x = Result.data[0][0] * Position.x + Result.data[1][0] * Position.y + Result.data[2][0] * Position.z;
+    Translation.y = Result.data[0][1] * Position.x + Result.data[1][1] * Position.y + Result.data[2][1] * Position.z;
+    Translation.z = Result.data[0][2] * Position.x + Result.data[1][2] * Position.y + Result.data[2][2] * Position.z;
+    
+    for (u32 Col = 0; Col < 3; ++Col)
+    {
+        Result.data[Col][0] *= Scale.x;
+        Result.data[Col][1] *= Scale.y;
+        Result.data[Col][2] *= Scale.z;
+    }
+    
+    Result.data[3][0] = Scale.x * Translation.x;
+    Result.data[3][1] = Scale.y * Translation.y;
+    Result.data[3][2] = Scale.z * Translation.z;
+    
+    return Result;
+}
+
+#if defined(MAPLE_VECTOR_MATH_SSE)
+
+// Rows holds the same column of four matrices, one matrix per lane
+file_internal void mat4_store_column_x4(char *Dst, u32 Stride, u32 Column,
+                                        __m128 Row0, __m128 Row1, __m128 Row2, __m128 Row3)
+{
+    _MM_TRANSPOSE4_PS(Row0, Row1, Row2, Row3);
+    _mm_storeu_ps((r32*)(Dst             ) + Column * 4, Row0);
+    _mm_storeu_ps((r32*)(Dst + Stride    ) + Column * 4, Row1);
+    _mm_storeu_ps((r32*)(Dst + Stride * 2) + Column * 4, Row2);
+    _mm_storeu_ps((r32*)(Dst + Stride * 3) + Column * 4, Row3);
+}
+
+#endif
+
+// Batched mat4_compose. Matrix i is written to (char*)Out + i * Stride, so the
+// matrices can go straight into a buffer with padded elements. With SSE four
+// transforms are composed at a time, one per lane.
+file_internal void mat4_compose_soa(transform_soa *In, u32 Count, void *Out, u32 Stride)
+{
+    u32 Idx = 0;
+    
+#if defined(MAPLE_VECTOR_MATH_SSE)
+    __m128 One  = _mm_set1_ps(1.0f);
+    __m128 Two  = _mm_set1_ps(2.0f);
+    __m128 Zero = _mm_setzero_ps();
+    
+    for (; Idx + 4 <= Count; Idx += 4)
+    {
+        __m128 qx = _mm_loadu_ps(In->RotationX + Idx);
+        __m128 qy = _mm_loadu_ps(In->RotationY + Idx);
+        __m128 qz = _mm_loadu_ps(In->RotationZ + Idx);
+        __m128 qw = _mm_loadu_ps(In->RotationW + Idx);
+        
+        // quaternion_norm
+        __m128 MagSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)),
+                                  _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw)));
+        __m128 InvMag = _mm_div_ps(One, _mm_sqrt_ps(MagSq));
+        qx = _mm_mul_ps(qx, InvMag);
+        qy = _mm_mul_ps(qy, InvMag);
+        qz = _mm_mul_ps(qz, InvMag);
+        qw = _mm_mul_ps(qw, InvMag);
+        
+        __m128 x2 = _mm_mul_ps(qx, qx);
+        __m128 y2 = _mm_mul_ps(qy, qy);
+        __m128 z2 = _mm_mul_ps(qz, qz);
+        __m128 xy = _mm_mul_ps(qx, qy);
+        __m128 xz = _mm_mul_ps(qx, qz);
+        __m128 yz = _mm_mul_ps(qy, qz);
+        __m128 wx = _mm_mul_ps(qw, qx);
+        __m128 wy = _mm_mul_ps(qw, qy);
+        __m128 wz = _mm_mul_ps(qw, qz);
+        
+        // quaternion_get_rotation_matrix, r<column><row>
+        __m128 r00 = _mm_sub_ps(One, _mm_mul_ps(Two, _mm_add_ps(y2, z2)));
+        __m128 r01 = _mm_mul_ps(Two, _mm_add_ps(xy, wz));
+        __m128 r02 = _mm_mul_ps(Two, _mm_sub_ps(xz, wy));
+        
+        __m128 r10 = _mm_mul_ps(Two, _mm_sub_ps(xy, wz));
+        __m128 r11 = _mm_sub_ps(One, _mm_mul_ps(Two, _mm_add_ps(x2, z2)));
+        __m128 r12 = _mm_mul_ps(Two, _mm_add_ps(yz, wx));
+        
+        __m128 r20 = _mm_mul_ps(Two, _mm_add_ps(xz, wy));
+        __m128 r21 = _mm_mul_ps(Two, _mm_sub_ps(yz, wx));
+        __m128 r22 = _mm_sub_ps(One, _mm_mul_ps(Two, _mm_add_ps(x2, y2)));
+        
+        __m128 px = _mm_loadu_ps(In->PositionX + Idx);
+        __m128 py = _mm_loadu_ps(In->PositionY + Idx);
+        __m128 pz = _mm_loadu_ps(In->PositionZ + Idx);
+        
+        __m128 sx = _mm_loadu_ps(In->ScaleX + Idx);
+        __m128 sy = _mm_loadu_ps(In->ScaleY + Idx);
+        __m128 sz = _mm_loadu_ps(In->ScaleZ + Idx);
+        
+        __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r00, px), _mm_mul_ps(r10, py)), _mm_mul_ps(r20, pz));
+        __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r01, px), _mm_mul_ps(r11, py)), _mm_mul_ps(r21, pz));
+        __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r02, px), _mm_mul_ps(r12, py)), _mm_mul_ps(r22, pz));
+        
+        char *Dst = (char*)Out + (u64)Idx * Stride;
+        mat4_store_column_x4(Dst, Stride, 0, _mm_mul_ps(sx, r00), _mm_mul_ps(sy, r01), _mm_mul_ps(sz, r02), Zero);
+        mat4_store_column_x4(Dst, Stride, 1, _mm_mul_ps(sx, r10), _mm_mul_ps(sy, r11), _mm_mul_ps(sz, r12), Zero);
+        mat4_store_column_x4(Dst, Stride, 2, _mm_mul_ps(sx, r20), _mm_mul_ps(sy, r21), _mm_mul_ps(sz, r22), Zero);
+        mat4_store_column_x4(Dst, Stride, 3, _mm_mul_ps(sx, tx),  _mm_mul_ps(sy, ty),  _mm_mul_ps(sz, tz),  One);
+    }
+#endif
+    
+    for (; Idx < Count; ++Idx)
+    {
+        vec3 Position = { In->PositionX[Idx], In->PositionY[Idx], In->PositionZ[Idx] };
+        vec3 Scale    = { In->ScaleX[Idx],    In->ScaleY[Idx],    In->ScaleZ[Idx]    };
+        
+        quaternion Rotation;
+        Rotation.x = In->RotationX[Idx];
+        Rotation.y = In->RotationY[Idx];
+        Rotation.z = In->RotationZ[Idx];
+        Rotation.w = In->RotationW[Idx];
+        
+        mat4 Model = mat4_compose(Position, Scale, Rotation);
+        memcpy((char*)Out + (u64)Idx * Stride, &Model, sizeof(mat4));
+    }
+}
+
 file_internal r32 lerp(r32 v0, r32 v1, r32 t)
 {
     return v0 + t * (v1 - v0);